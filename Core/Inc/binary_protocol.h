@@ -0,0 +1,176 @@
+/*
+ * binary_protocol.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_BINARY_PROTOCOL_H_
+#define INC_BINARY_PROTOCOL_H_
+
+#include <stdint.h>
+#include "scoreboard.h"
+#include "commands.h"
+
+/*
+ * Binary mode framing
+ *
+ * Every request and response is one record:
+ *
+ *   +------+-----+---------------+----------+
+ *   | type | seq | payload ...   | CRC-16   |
+ *   +------+-----+---------------+----------+
+ *
+ * CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) covers type, seq and payload
+ * and is sent little-endian. The record is COBS encoded and terminated with a
+ * single 0x00 byte, so a frame boundary can always be found again after a
+ * corrupted byte.
+ *
+ * Requests: type is the command_t value, payload is the same parameter text
+ *           the line protocol takes (e.g. "on", "2024-03-14"), seq is echoed.
+ * Responses: type is a binary_record_t; multi-byte fields are little-endian.
+ *            Unsolicited records (polling mode) use seq 0.
+ *
+ * List records (scores, stats, devices, rates, health) carry a binary_page_t
+ * before their entries. A list that does not fit into one record is sent as
+ * several records of the same type and seq, in order; the host has all of
+ * it once first + count == total.
+ */
+
+#define BINARY_MAX_PAYLOAD 200
+#define BINARY_MAX_FRAME   (2 + BINARY_MAX_PAYLOAD + 2)
+#define BINARY_MAX_ENCODED (BINARY_MAX_FRAME + BINARY_MAX_FRAME / 254 + 2)  // COBS overhead + delimiter
+
+typedef enum {
+    BINARY_RECORD_STATUS = 0x80,    // binary_status_record_t
+    BINARY_RECORD_SCORES = 0x81,    // uint8_t tournament_mode, binary_page_t, binary_score_t[count]
+    BINARY_RECORD_STATS = 0x82,     // binary_page_t, binary_stats_t[count]
+    BINARY_RECORD_DEVICES = 0x83,   // binary_page_t, uint8_t console_id[count]
+    BINARY_RECORD_DATE_TIME = 0x84, // binary_date_time_t
+    BINARY_RECORD_DELTA = 0x85,     // binary_delta_header_t, binary_delta_entry_t[] (see poll_delta.h)
+    BINARY_RECORD_RATES = 0x86,     // binary_page_t, binary_rate_t[count]
+    BINARY_RECORD_HEALTH = 0x87     // binary_health_header_t, binary_health_t[count]
+} binary_record_t;
+
+typedef enum {
+    BINARY_STATUS_OK, BINARY_STATUS_ERROR, BINARY_STATUS_INVALID_COMMAND, BINARY_STATUS_INVALID_PARAMETER_COUNT,
+    BINARY_STATUS_BAD_FRAME, BINARY_STATUS_INVALID_PARAMETER_VALUE
+} binary_status_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t command;  // command_t of the request
+    uint8_t status;   // binary_status_t
+} binary_status_record_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t first;  // Index of the first entry of this record in the whole list
+    uint8_t count;  // Entries in this record
+    uint8_t total;  // Entries in the whole list
+} binary_page_t;
+
+typedef struct __attribute__((packed)) {  // Mirrors score_t
+    uint8_t console_id;
+    uint8_t grid_size;
+    uint8_t clock_sync;
+    uint8_t game_status;
+    uint8_t game_difficulty;
+    uint8_t cause_of_death;
+    uint8_t game_speed;
+    uint8_t is_connected;
+    uint16_t score1;
+    uint16_t score2;
+    uint16_t apples1;
+    uint16_t apples2;
+    uint16_t playing_time;
+    uint8_t level;
+    uint8_t playing_mode;
+    uint8_t with_poison;
+} binary_score_t;
+
+typedef struct __attribute__((packed)) {  // Mirrors stats_t
+    uint8_t console_id;
+    uint16_t num_apples_easy;
+    uint16_t num_apples_medium;
+    uint16_t num_apples_hard;
+    uint16_t num_apples_insane;
+    uint16_t high_score_easy;
+    uint16_t high_score_medium;
+    uint16_t high_score_hard;
+    uint16_t high_score_insane;
+    char initials_easy[3];
+    char initials_medium[3];
+    char initials_hard[3];
+    char initials_insane[3];
+} binary_stats_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+} binary_date_time_t;
+
+#define BINARY_DELTA_KEYFRAME 0x01  // Record starts a keyframe: clear the table before applying
+
+typedef struct __attribute__((packed)) {
+    uint32_t seq;
+    uint8_t flags;
+    uint8_t tournament_mode;
+} binary_delta_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t console_id;
+    uint8_t field;    // poll_field_t
+    uint32_t value;   // Initials are three characters, first in the low byte
+} binary_delta_entry_t;
+
+typedef struct __attribute__((packed)) {  // Mirrors poll_rate_t
+    uint8_t console_id;
+    uint16_t interval_ms;
+    uint16_t window_polls;
+    uint32_t num_polls;
+} binary_rate_t;
+
+typedef struct __attribute__((packed)) {  // Mirrors i2c_engine_stats_t and i2c_start_sync_t
+    uint32_t num_reads;
+    uint32_t num_writes;
+    uint32_t num_errors;
+    uint32_t num_timeouts;
+    uint32_t num_dropped;
+    uint8_t num_started;  // Last synchronized start, see i2c_start_sync_t
+    uint8_t num_late;
+    uint16_t skew_us;
+    uint32_t lead_us;
+    binary_page_t page;
+} binary_health_header_t;
+
+typedef struct __attribute__((packed)) {  // Mirrors console_health_t
+    uint8_t console;      // Slot + 1, the console_id
+    uint8_t state;        // breaker_state_t
+    uint16_t latency_us;
+    uint16_t latency_var_us;
+    uint16_t budget_us;
+    uint16_t consecutive_failures;
+    uint32_t num_failures;
+    uint16_t num_trips;
+    uint16_t backoff_ms;
+    uint16_t num_torn;
+} binary_health_t;
+
+_Static_assert(sizeof(binary_score_t) == 21, "binary_score_t layout is part of the protocol");
+_Static_assert(sizeof(binary_stats_t) == 29, "binary_stats_t layout is part of the protocol");
+_Static_assert(MAX_NUM_CONSOLES <= UINT8_MAX, "binary_page_t counts consoles in a byte");
+_Static_assert(sizeof(binary_health_header_t) + sizeof(binary_health_t) <= BINARY_MAX_PAYLOAD,
+        "health record cannot hold an entry");
+
+uint16_t crc16_ccitt(const uint8_t *data, uint16_t len, uint16_t crc);
+uint16_t cobs_encode(const uint8_t *src, uint16_t len, uint8_t *dst);
+uint16_t cobs_decode(const uint8_t *src, uint16_t len, uint8_t *dst);
+uint16_t binary_encode_frame(uint8_t type, uint8_t seq, const void *payload, uint16_t len, uint8_t *frame);
+binary_status_t binary_parse_request(uint8_t *frame, uint16_t len, uint8_t *seq, command_args_t *args);
+void binary_pack_score(const score_t *score, binary_score_t *record);
+void binary_pack_stats(uint8_t console_id, const stats_t *stats, binary_stats_t *record);
+
+#endif /* INC_BINARY_PROTOCOL_H_ */
@@ -14,36 +14,113 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#define MAX_COMMAND_PARAMS  2
+#define MAX_COMMAND_VALUES  3   // A date or time parameter fills three values
+#define COMMAND_NAME_MAX    16  // Longer words cannot be a command and are rejected before hashing
+#define COMMAND_HASH_BITS   6
+#define COMMAND_HASH_SEED   25u  // Chosen so every name below lands in its own slot
+
+/*
+ * Command table
+ *
+ * X(token, name, number of parameters, parameter 1, parameter 2)
+ *
+ * The order defines the command_t values, which are also the binary mode
+ * request types: only append. commands_init builds the hash slots from the
+ * names and halts on a collision; when a command is added, run the host
+ * tests (Tests/commands_test) and pick a COMMAND_HASH_SEED that keeps all
+ * slots distinct.
+ */
+#define COMMAND_TABLE(X) \
+    X(CMD_TERMINAL_MODE,   "@terminal",    0, P_NONE, P_NONE) \
+    X(CMD_PC_MODE,         "@pc_console",  0, P_NONE, P_NONE) \
+    X(CMD_SCOREBOARD_MODE, "@scoreboard",  0, P_NONE, P_NONE) \
+    X(CMD_SET_DATE,        "@set_date",    1, P_DATE, P_NONE) /* YYYY-MM-DD */ \
+    X(CMD_SET_TIME,        "@set_time",    1, P_TIME, P_NONE) /* HH:MM:SS */ \
+    X(CMD_GET_DATE,        "@get_date",    0, P_NONE, P_NONE) \
+    X(CMD_GET_TIME,        "@get_time",    0, P_NONE, P_NONE) \
+    X(CMD_LIST_DEVICES,    "@devices",     0, P_NONE, P_NONE) \
+    X(CMD_LIST_SCORES,     "@scores",      0, P_NONE, P_NONE) \
+    X(CMD_POLLING_MODE,    "@poll",        1, P_KEYWORD(KEYWORD_KEYFRAME), P_NONE) /* on, off, status, reset, delta, keyframe */ \
+    X(CMD_DEMO_MODE,       "@demo",        1, P_KEYWORD(KEYWORD_RESET), P_NONE) /* on, off, status, reset */ \
+    X(CMD_STATS,           "@stats",       0, P_NONE, P_NONE) \
+    X(CMD_SET_SPEED,       "@set_speed",   1, P_UINT(1, 100), P_NONE) \
+    X(CMD_SET_LEVEL,       "@set_level",   1, P_UINT(1, 4), P_NONE) \
+    X(CMD_PREPARE_GAME,    "@prepare_game",2, P_UINT(0, 3), P_UINT(0, 1)) /* level, with_poison */ \
+    X(CMD_START_GAME,      "@start_game",  1, P_UINT(0, 100), P_NONE) /* speed */ \
+    X(CMD_END_GAME,        "@end_game",    0, P_NONE, P_NONE) \
+    X(CMD_PAUSE_GAME,      "@pause_game",  0, P_NONE, P_NONE) \
+    X(CMD_RANDOM_SEED,     "@seed",        1, P_UINT(0, UINT32_MAX), P_NONE) /* 0 = pick one */ \
+    X(CMD_BINARY_MODE,     "@binary",      0, P_NONE, P_NONE) \
+    X(CMD_RATES,           "@rates",       0, P_NONE, P_NONE) \
+    X(CMD_HEALTH,          "@health",      0, P_NONE, P_NONE) \
+    X(CMD_SYSINFO,         "@sysinfo",     0, P_NONE, P_NONE)
+
+#define COMMAND_ENUM(token, name, num_params, param1, param2) token,
+
 typedef enum command {
     INVALID_COMMAND,
     INVALID_PARAMETER_COUNT,
-    CMD_TERMINAL_MODE,
-    CMD_PC_MODE,
-    CMD_SCOREBOARD_MODE,
-    CMD_SET_DATE, // parameter is date in format YYYY-MM-DD
-    CMD_SET_TIME, // parameter is time in format HH:MM:SS
-    CMD_GET_DATE,
-    CMD_GET_TIME,
-    CMD_LIST_DEVICES,
-    CMD_LIST_SCORES,
-    CMD_POLLING_MODE, // parameter is on, off
-    CMD_DEMO_MODE, // parameter is on, off, status, reset
-    CMD_STATS,
-    CMD_SET_SPEED, // parameter is between 0-60
-    CMD_SET_LEVEL, // parameter is between 0-3
-    CMD_PREPARE_GAME, // parameter is level 0-3, with_poison 0-1
-    CMD_START_GAME, // parameter is speed 0-60
-    CMD_END_GAME,
-    CMD_PAUSE_GAME,
-    CMD_RANDOM_SEED,
+    COMMAND_TABLE(COMMAND_ENUM)
     NUM_COMMANDS
 } command_t;
 
+typedef enum {
+    PARAM_NONE, PARAM_UINT, PARAM_KEYWORD, PARAM_DATE, PARAM_TIME
+} param_type_t;
+
+// Keyword parameters are parsed to their index; max limits which ones a command accepts
+typedef enum {
+    KEYWORD_OFF, KEYWORD_ON, KEYWORD_STATUS, KEYWORD_RESET, KEYWORD_DELTA, KEYWORD_KEYFRAME, NUM_KEYWORDS
+} keyword_t;
+
+typedef struct {
+    param_type_t type;
+    uint32_t min;
+    uint32_t max;
+} param_desc_t;
+
+#define P_NONE          { PARAM_NONE, 0, 0 }
+#define P_UINT(lo, hi)  { PARAM_UINT, (lo), (hi) }
+#define P_KEYWORD(last) { PARAM_KEYWORD, 0, (last) }
+#define P_DATE          { PARAM_DATE, 0, 0 }
+#define P_TIME          { PARAM_TIME, 0, 0 }
+
+typedef struct {
+    const char *name;
+    uint8_t name_len;
+    uint8_t num_params;
+    param_desc_t params[MAX_COMMAND_PARAMS];
+} command_desc_t;
+
+// A slice of the receive buffer; never NUL-terminated
+typedef struct {
+    const uint8_t *ptr;
+    uint16_t len;
+} str_view_t;
+
+typedef struct {
+    command_t command;
+    str_view_t name;       // Command word as received, for error messages
+    uint8_t num_values;
+    uint32_t value[MAX_COMMAND_VALUES];  // UINT: value, KEYWORD: keyword_t, DATE: y/m/d, TIME: h/m/s
+} command_args_t;
+
+typedef enum {
+    PARSE_OK, PARSE_UNKNOWN_COMMAND, PARSE_PARAMETER_COUNT, PARSE_PARAMETER_VALUE
+} parse_status_t;
+
 typedef enum cmd_status {
     CMD_OK, CMD_ERROR, CMD_INVALID
 } cmd_status_t;
 
-command_t parse_command(uint8_t *command, uint8_t *token, uint8_t *parameter);
-cmd_status_t execute_command(scoreboard_t *scoreboard, command_t command, uint8_t *parameter);
-uint32_t parse_i2c_command(command_t cmd_token, uint8_t *parameter);
+extern const command_desc_t command_table[NUM_COMMANDS];
+
+bool commands_init(void);
+uint32_t command_hash(const uint8_t *name, uint16_t len);
+command_t find_command(str_view_t name);
+parse_status_t parse_command(const uint8_t *line, uint16_t len, command_args_t *args);
+parse_status_t parse_parameters(command_t command, const uint8_t *text, uint16_t len, command_args_t *args);
+cmd_status_t execute_command(scoreboard_t *scoreboard, const command_args_t *args);
+uint32_t parse_i2c_command(const command_args_t *args);
 #endif /* INC_COMMANDS_H_ */
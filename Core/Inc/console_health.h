@@ -0,0 +1,66 @@
+/*
+ * console_health.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_CONSOLE_HEALTH_H_
+#define INC_CONSOLE_HEALTH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2c_master.h"
+
+#define HEALTH_LATENCY_MIN_US    1000  // Floor for the latency budget on top of the wire time
+#define HEALTH_LATENCY_MAX_US    (I2C_TIMEOUT * 1000)  // Budget before any sample, and its ceiling
+#define HEALTH_BREAKER_THRESHOLD 3     // Consecutive failed reads that open the breaker
+#define HEALTH_BACKOFF_MIN_MS    500   // First probe interval once the breaker is open
+#define HEALTH_BACKOFF_MAX_MS    16000 // Probe interval doubles up to this
+#define HEALTH_STABLE_READS      20    // Successful reads in a row that forget the backoff
+
+/*
+ * Console health: adaptive timeouts and circuit breaker
+ *
+ * Every completed read reports the time the console took beyond the bare
+ * wire time (ISR latency, clock stretching). A smoothed latency and its mean
+ * deviation (Jacobson/Karels, as TCP does for its RTO) give the per-console
+ * latency budget the I2C engine adds to the wire time of each job, so a hung
+ * console is abandoned after a few milliseconds instead of I2C_TIMEOUT.
+ *
+ * Consecutive failures open the console's breaker: the console is taken out
+ * of polling and commands and only re-probed, with the interval doubling
+ * after each failed probe. A successful probe closes the breaker again.
+ */
+typedef enum {
+    BREAKER_CLOSED,     // Console polled normally
+    BREAKER_OPEN,       // Console out of the loop, waiting for its next probe
+    BREAKER_HALF_OPEN,  // Probe in progress
+    NUM_BREAKER_STATES
+} breaker_state_t;
+
+typedef struct {
+    uint8_t state;               // breaker_state_t
+    uint16_t latency_us;         // Smoothed latency beyond the wire time
+    uint16_t latency_var_us;     // Mean deviation of the latency
+    uint16_t budget_us;          // Latency budget handed to the I2C engine
+    uint16_t consecutive_failures;
+    uint16_t consecutive_reads;  // Successful reads in a row
+    uint32_t num_failures;
+    uint16_t num_trips;          // Times the breaker opened
+    uint16_t num_torn;           // Blocks read while the console updated them, read again
+    uint16_t backoff_ms;         // Current probe interval
+    uint32_t next_probe;         // HAL_GetTick() at which an open breaker is probed
+} console_health_t;
+
+void console_health_init(void);
+void console_health_reset(uint8_t console);
+uint16_t console_health_read_ok(uint8_t console, uint16_t latency_us);
+bool console_health_read_failed(uint8_t console, uint32_t now);
+void console_health_read_torn(uint8_t console);
+bool console_health_probe_due(uint8_t console, uint32_t now);
+void console_health_probe_done(uint8_t console, bool ok, uint32_t now);
+void console_health_get(uint8_t console, console_health_t *health);
+const char* console_health_state_name(uint8_t state);
+
+#endif /* INC_CONSOLE_HEALTH_H_ */
@@ -0,0 +1,55 @@
+/*
+ * console_poller.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_CONSOLE_POLLER_H_
+#define INC_CONSOLE_POLLER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmsis_os.h"
+#include "scoreboard.h"
+#include "memory_config.h"
+
+#define POLLER_MAX_WAIT_MS         100   // Breaker probes are checked at least this often
+#define POLLER_SERVICE_MS          2     // While jobs are queued, for the I2C engine timeouts
+#define POLLER_HOUSEKEEPING_MS     1000  // Demo mode, tournament end, link LEDs and the CPU load sample
+
+// Thread flags of the poller task
+#define POLLER_FLAG_REQUEST (1UL << 0)  // Console request queued
+#define POLLER_FLAG_I2C     (1UL << 1)  // I2C engine published a read result
+#define POLLER_FLAG_LINK    (1UL << 2)  // Edge on a link pin
+#define POLLER_FLAGS        (POLLER_FLAG_REQUEST | POLLER_FLAG_I2C | POLLER_FLAG_LINK)
+
+/*
+ * Console poller task
+ *
+ * Owns the I2C side of the scoreboard: the device list, the I2C engine, link
+ * monitoring, probing and bus recovery, and the per-console poll schedule.
+ * Console data is decoded into the shared scoreboard under scoreboard_lock
+ * and the telemetry task is told when it changed.
+ *
+ * The task sleeps until a thread flag is set (a request, a read result or a
+ * link edge) or the next console is due, so an idle bus costs no CPU time.
+ * Commands for the consoles are handed over through a queue and put on the
+ * wire ahead of any polling; the command task never waits on the bus.
+ */
+typedef enum {
+    CONSOLE_REQUEST_COMMAND,  // Command write to every active console
+    CONSOLE_REQUEST_START     // Synchronised game start (i2c_engine_send_start)
+} console_request_type_t;
+
+typedef struct {
+    uint8_t type;         // console_request_type_t
+    uint32_t command;     // I2C_CMD_* with its parameters
+    uint32_t seed;        // Random seed register, 0 to leave it
+} console_request_t;
+
+void console_poller_init(void);
+bool console_poller_request(const console_request_t *request);
+uint32_t console_poller_num_rejected(void);
+
+#endif /* INC_CONSOLE_POLLER_H_ */
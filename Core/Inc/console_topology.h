@@ -0,0 +1,105 @@
+/*
+ * console_topology.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_CONSOLE_TOPOLOGY_H_
+#define INC_CONSOLE_TOPOLOGY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "main.h"
+#include "scoreboard.h"
+#include "i2c_master.h"
+
+#define TOPOLOGY_NO_MUX (0x00)  // Segment wired to the bus itself
+#define TCA9548A_ADDR   (0x70)  // 0x70-0x77, set by A2..A0
+
+/*
+ * Console topology
+ *
+ * I2C_BUSES lists the I2C peripherals consoles are attached to:
+ *
+ *   X(bus, handle, rx_dma, ev_irq, er_irq, dma_irq, scl_port, scl_pin, sda_port, sda_pin)
+ *
+ * Each needs its peripheral and pins in CubeMX, and its RX DMA stream and
+ * interrupts in the MSP init at the same NVIC priority as I2C1. I2C1 (PB6,
+ * PB7) and I2C3 (PA8, PC9) are configured; I2C2 has no free SCL pin on this
+ * board and FMPI2C1 has a driver of its own, so neither can be listed.
+ *
+ * CONSOLE_SEGMENTS lists runs of consoles at consecutive addresses:
+ *
+ *   X(bus, mux_addr, mux_channel, first_addr, count)
+ *
+ * A segment behind a TCA9548A style multiplexer is reached by writing
+ * 1 << mux_channel to the multiplexer first; consoles on other channels can
+ * reuse the same addresses. A bus carries at most one multiplexer.
+ *
+ * The 32 consoles are the five front panel ports and two multiplexer
+ * channels of five on I2C1, and three channels of five plus one of two on
+ * I2C3, so both buses carry about the same load.
+ *
+ * The segments are laid out in table order into a dense registry of console
+ * slots, the index of every per-console array. The first NUM_CONSOLE_PORTS
+ * slots are the front panel ports. Every bus has its own I2C engine queue,
+ * so a polling sweep takes as long as the busiest bus.
+ */
+#define I2C_BUSES(X) \
+    X(I2C_BUS_1, hi2c1, hdma_i2c1_rx, I2C1_EV_IRQn, I2C1_ER_IRQn, DMA1_Stream0_IRQn, GPIOB, GPIO_PIN_6, GPIOB, GPIO_PIN_7) \
+    X(I2C_BUS_3, hi2c3, hdma_i2c3_rx, I2C3_EV_IRQn, I2C3_ER_IRQn, DMA1_Stream2_IRQn, GPIOA, GPIO_PIN_8, GPIOC, GPIO_PIN_9)
+
+#define CONSOLE_SEGMENTS(X) \
+    X(I2C_BUS_1, TOPOLOGY_NO_MUX, 0, I2C_SLAVE_START_ADDR, NUM_CONSOLE_PORTS) \
+    X(I2C_BUS_1, TCA9548A_ADDR,   0, I2C_SLAVE_START_ADDR, 5) \
+    X(I2C_BUS_1, TCA9548A_ADDR,   1, I2C_SLAVE_START_ADDR, 5) \
+    X(I2C_BUS_3, TCA9548A_ADDR,   0, I2C_SLAVE_START_ADDR, 5) \
+    X(I2C_BUS_3, TCA9548A_ADDR,   1, I2C_SLAVE_START_ADDR, 5) \
+    X(I2C_BUS_3, TCA9548A_ADDR,   2, I2C_SLAVE_START_ADDR, 5) \
+    X(I2C_BUS_3, TCA9548A_ADDR,   3, I2C_SLAVE_START_ADDR, 2)
+
+#define I2C_BUS_ID(bus, handle, rx_dma, ev_irq, er_irq, dma_irq, scl_port, scl_pin, sda_port, sda_pin) bus,
+#define CONSOLE_SEGMENT_COUNT(bus, mux_addr, mux_channel, first_addr, count) + (count)
+
+typedef enum {
+    I2C_BUSES(I2C_BUS_ID)
+    NUM_I2C_BUSES
+} i2c_bus_id_t;
+
+enum {
+    TOPOLOGY_NUM_CONSOLES = 0 CONSOLE_SEGMENTS(CONSOLE_SEGMENT_COUNT)
+};
+
+_Static_assert(TOPOLOGY_NUM_CONSOLES <= MAX_NUM_CONSOLES, "CONSOLE_SEGMENTS has more consoles than MAX_NUM_CONSOLES");
+
+typedef struct {
+    I2C_HandleTypeDef *hi2c;
+    DMA_HandleTypeDef *hdma_rx;
+    IRQn_Type ev_irq;
+    IRQn_Type er_irq;
+    IRQn_Type dma_irq;
+    GPIO_TypeDef *scl_port;  // SCL and SDA, for bus recovery
+    uint16_t scl_pin;
+    GPIO_TypeDef *sda_port;
+    uint16_t sda_pin;
+} i2c_bus_config_t;
+
+typedef struct {
+    uint8_t bus;          // i2c_bus_id_t
+    uint8_t mux_addr;     // TOPOLOGY_NO_MUX if on the bus itself
+    uint8_t mux_channel;
+    uint8_t i2c_addr;     // 7-bit address
+} console_slot_t;
+
+void topology_init(void);
+uint8_t topology_num_slots(void);
+const console_slot_t* topology_slot(uint8_t slot);
+const i2c_bus_config_t* topology_bus(uint8_t bus);
+uint8_t topology_bus_of(const I2C_HandleTypeDef *hi2c);
+bool topology_mux_step(uint8_t slot, uint8_t *mux_addr, uint8_t *mask);
+void topology_mux_done(uint8_t bus, uint8_t mask, bool ok);
+void topology_mux_forget(uint8_t bus);
+HAL_StatusTypeDef topology_select(uint8_t slot);
+
+#endif /* INC_CONSOLE_TOPOLOGY_H_ */
@@ -0,0 +1,102 @@
+/*
+ * i2c_engine.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_I2C_ENGINE_H_
+#define INC_I2C_ENGINE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "i2c_master.h"
+#include "memory_config.h"
+
+#define I2C_JOB_MAX_WRITE      8  // Command (4) + random seed (4)
+
+/*
+ * Asynchronous I2C engine
+ *
+ * Jobs are queued by the poller task and run back to back from the HAL
+ * completion callbacks, so the task never waits on the bus. Every bus of the
+ * console topology (console_topology.h) has its own queues and runs in
+ * parallel with the others; a job for a console behind a multiplexer is
+ * preceded by the multiplexer write when its channel is not open. A read is a
+ * register pointer write (interrupt driven) followed by a DMA receive with a
+ * STOP in between, the same transactions fetch_scoreboard_data makes. A write
+ * is a single memory write.
+ *
+ * Commands have their own queue, which is always served before background
+ * polling: a command waits for at most the one transfer already on the wire.
+ *
+ * Completed reads land at their register offsets in a result slot per console
+ * and are collected with i2c_engine_get_result, which reports the register
+ * range covered by all reads completed since the previous collection.
+ *
+ * i2c_engine_service must be called regularly from the task to time out jobs
+ * whose console stopped responding: a job may take its wire time plus the
+ * latency budget of its console (see console_health.h). The task can sleep
+ * in between: i2c_engine_set_notify names thread flags that are set from the
+ * completion interrupt whenever a read result is published.
+ */
+typedef enum {
+    I2C_JOB_READ, I2C_JOB_WRITE, I2C_JOB_START  // START: command write with the start delay filled in
+} i2c_job_type_t;
+
+typedef enum {
+    I2C_PRIORITY_COMMAND, I2C_PRIORITY_POLL
+} i2c_priority_t;
+
+typedef struct {
+    uint8_t type;     // i2c_job_type_t
+    uint8_t console;  // Index into the device list, selects the result slot
+    uint8_t addr;     // 7-bit address
+    uint8_t reg;      // First register
+    uint8_t len;      // Bytes to read or write
+    uint8_t data[I2C_JOB_MAX_WRITE];
+    uint32_t start_at;  // I2C_JOB_START: DWT cycle count at which the game starts
+} i2c_job_t;
+
+typedef struct {
+    uint8_t first;             // First register read since the last collection
+    uint8_t end;               // One past the last register read (first == end: none)
+    HAL_StatusTypeDef status;  // HAL_OK, or the outcome of the first read that failed
+    uint16_t latency_us;       // Longest time a read took beyond its wire time
+} i2c_read_result_t;
+
+typedef struct {
+    uint32_t num_reads;
+    uint32_t num_writes;
+    uint32_t num_errors;    // NACK, arbitration loss, bus error
+    uint32_t num_timeouts;  // Jobs aborted after their wire time plus latency budget
+    uint32_t num_dropped;   // Jobs rejected because their queue was full
+} i2c_engine_stats_t;
+
+typedef struct {
+    uint8_t num_started;  // Consoles that acknowledged the last start
+    uint8_t num_late;     // Of those, consoles written after the planned start time
+    uint16_t skew_us;     // Spread of their start times as scheduled by the master
+    uint32_t lead_us;     // Time between queueing the start and the planned start
+} i2c_start_sync_t;
+
+void i2c_engine_init(void);
+bool i2c_engine_read(i2c_priority_t priority, const device_list_t *device, uint8_t console, uint8_t reg,
+        uint8_t len);
+bool i2c_engine_write(i2c_priority_t priority, const device_list_t *device, uint8_t console, uint8_t reg,
+        const uint8_t *data, uint8_t len);
+void i2c_engine_send_command(device_list_t device[], uint32_t command, uint32_t random_seed);
+void i2c_engine_send_start(device_list_t device[], uint32_t command, uint32_t random_seed);
+void i2c_engine_get_start_sync(i2c_start_sync_t *sync);
+bool i2c_engine_get_result(uint8_t console, uint8_t *data, i2c_read_result_t *result);
+void i2c_engine_service(void);
+void i2c_engine_suspend(void);
+void i2c_engine_resume(void);
+bool i2c_engine_is_idle(void);
+void i2c_engine_get_stats(i2c_engine_stats_t *stats);
+void i2c_engine_set_latency_budget(uint8_t console, uint16_t budget_us);
+void i2c_engine_set_notify(osThreadId_t thread, uint32_t flags);
+
+#endif /* INC_I2C_ENGINE_H_ */
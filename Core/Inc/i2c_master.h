@@ -9,15 +9,41 @@
 #define INC_I2C_MASTER_H_
 
 #include "scoreboard.h"
+#include "register_map.h"
 
 #define I2C_TIMEOUT (15)
 #define I2C_SLAVE_START_ADDR (0x10)
 #define I2C_BUFFER_SIZE (0x3F)
-#define REGISTERS_SIZE (0x38)
+#define REGISTERS_SIZE REGISTER_MAP_SIZE
+
+// Register blocks (see REGISTER_MAP). The hot block is read on every poll; the cold block
+// (per-difficulty stats) only when the stats generation in the hot block has changed.
+#define REG_HOT_START        REG_ADDR_hot_seq_begin
+#define REG_STATS_GENERATION REG_ADDR_stats_generation
+#define REG_HOT_SIZE         (REG_ADDR_hot_seq_end + 1 - REG_HOT_START)
+#define REG_COLD_START       REG_ADDR_cold_seq_begin
+#define REG_COLD_SIZE        (REG_ADDR_cold_seq_end + 1 - REG_COLD_START)
+#define REG_DATE_TIME        REG_ADDR_date_time
+#define REG_COMMAND          REG_ADDR_command
+#define REG_RANDOM_SEED      REG_ADDR_random_seed
+
+// Bits returned by i2c_master_torn_blocks
+#define REG_BLOCK_HOT  (1 << 0)
+#define REG_BLOCK_COLD (1 << 1)
+#define NUM_REG_BLOCKS (2)
+
+// Times fetch_scoreboard_data reads the registers again when a block was torn
+#define REG_TORN_RETRIES (3)
+
+// 0: the trailing sequence register of a block repeats the leading one.
+// 1: it holds the low byte of a CRC-32 over the block, computed with the CRC unit. This also
+//    catches bits corrupted on the bus, but about 1 in 256 torn blocks passes the 8-bit check.
+//    Consoles and the scoreboard must be built alike.
+#define REGISTER_BLOCK_CRC (0)
 
 typedef struct {
     uint16_t i2c_addr;
-    uint8_t device_id;
+    uint8_t device_id;   // Slot + 1, becomes the console_id
     uint8_t is_active;
 } device_list_t;
 
@@ -25,11 +51,12 @@ void initialize_device_list(device_list_t list[]);
 void initialize_scoreboard_data(i2c_scoreboard_t *data);
 void struct2register(i2c_scoreboard_t *data);
 void register2struct(uint8_t reg[], i2c_scoreboard_t *data);
+const uint8_t* i2c_slave_read_begin(uint8_t reg, uint8_t *len);
+void i2c_slave_transfer_end(void);
 HAL_StatusTypeDef get_console_data(I2C_HandleTypeDef *hi2c, uint16_t i2c_addr, uint8_t reg_addr,
         uint8_t *data, uint8_t len);
-HAL_StatusTypeDef fetch_scoreboard_data(I2C_HandleTypeDef *hi2c, device_list_t *device,
-        uint8_t scoreboard_data[]);
-HAL_StatusTypeDef i2c_master_scan(I2C_HandleTypeDef *hi2c, device_list_t device[]);
-HAL_StatusTypeDef i2c_send_command(I2C_HandleTypeDef *hi2c, device_list_t device[], uint32_t command,
-        uint32_t random_seed);
+HAL_StatusTypeDef fetch_scoreboard_data(device_list_t device[], uint8_t device_index, uint8_t scoreboard_data[]);
+HAL_StatusTypeDef i2c_master_scan(device_list_t device[]);
+uint8_t i2c_master_torn_blocks(const uint8_t reg[], uint8_t first, uint8_t end);
+HAL_StatusTypeDef i2c_master_probe(device_list_t device[], uint8_t device_index);
 #endif /* INC_I2C_MASTER_H_ */
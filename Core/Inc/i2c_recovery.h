@@ -0,0 +1,33 @@
+/*
+ * i2c_recovery.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_I2C_RECOVERY_H_
+#define INC_I2C_RECOVERY_H_
+
+#include <stdbool.h>
+#include "main.h"
+#include "console_topology.h"  // Pins of each bus (I2C_BUSES)
+
+#define I2C_RECOVERY_PULSES     9   // Enough for a slave to finish any byte it is sending
+#define I2C_RECOVERY_HALF_US    5   // Half SCL period, 100 kHz
+#define I2C_RECOVERY_STRETCH_US 1000 // Longest a slave may hold SCL low during recovery
+
+/*
+ * I2C bus recovery
+ *
+ * A console reset or unplugged in the middle of a read can be left driving
+ * SDA low, waiting for clocks to shift out the rest of its byte. The master
+ * then sees a busy bus forever. Recovery takes the pins away from the
+ * peripheral, clocks SCL until SDA is released (at most nine pulses),
+ * generates a STOP and re-initialises the peripheral. The I2C engine must be
+ * suspended while the bus is checked or recovered. Buses are identified by
+ * their i2c_bus_id_t.
+ */
+bool i2c_bus_is_stuck(uint8_t bus);
+bool i2c_bus_recover(uint8_t bus);
+
+#endif /* INC_I2C_RECOVERY_H_ */
@@ -8,25 +8,61 @@
 #ifndef INC_LED_INDICATOR_H_
 #define INC_LED_INDICATOR_H_
 
+#include <stdbool.h>
 #include "main.h"
 
+#define LED_MAX_INDICATORS  8
+#define LED_TICKS_PER_MS    10   // TIM5 counts per millisecond
+#define LED_FOREVER         0    // led_pattern_t count: repeat until replaced or cleared
+#define LED_BLINK_PERIOD    (1000 * LED_TICKS_PER_MS)  // LED_BLINK of led_indicator_set_state
+
+/*
+ * LED pattern engine
+ *
+ * Every indicator shows the highest priority pattern that is still running;
+ * when an overlay has done its cycles the pattern below it resumes. A cycle
+ * lights the LED for on_time and keeps it off for the rest of the period.
+ *
+ * The engine runs from the TIM5 channel 1 compare interrupt, armed for the
+ * next on/off edge of any indicator, and writes all edges that are due
+ * with one BSRR write per GPIO port. Nothing runs while no indicator is
+ * blinking. The LEDs are wired active low (high turns them off).
+ */
 typedef enum {
     LED_OFF, LED_ON, LED_BLINK
 } led_state_t;
 
+typedef enum {
+    LED_PRIORITY_BASE,     // Steady state of the LED: link, heartbeat
+    LED_PRIORITY_OVERLAY,  // Activity blinks shown on top until they are done
+    LED_NUM_PRIORITIES
+} led_priority_t;
+
+typedef struct {
+    uint16_t period;   // TIM5 counts per cycle, 0 clears the layer
+    uint16_t on_time;  // TIM5 counts lit per cycle: 0 steady off, >= period steady on
+    uint16_t count;    // Cycles, LED_FOREVER to repeat
+    uint8_t priority;  // led_priority_t
+} led_pattern_t;
+
 typedef struct {
-    led_state_t state;
     GPIO_TypeDef *port;
     uint16_t pin;
-    uint16_t blink_counter;
-    uint32_t blink_period;
-    uint32_t last_update;
+    led_pattern_t layer[LED_NUM_PRIORITIES];
+    uint16_t remaining[LED_NUM_PRIORITIES];  // Cycles left of a counted pattern
+    uint8_t active;       // Bit per running layer
+    uint8_t shown;        // Layer driving the LED, LED_NUM_PRIORITIES if none
+    uint8_t lit;
+    uint8_t timed;        // next_edge is valid
+    uint32_t cycle_start; // TIM5 count
+    uint32_t next_edge;   // TIM5 count
 } led_indicator_t;
 
 void led_indicator_init(led_indicator_t *led, GPIO_TypeDef *port, uint16_t pin);
+void led_indicator_set_pattern(led_indicator_t *led, const led_pattern_t *pattern);
+void led_indicator_clear(led_indicator_t *led, led_priority_t priority);
 void led_indicator_set_state(led_indicator_t *led, led_state_t state);
 void led_indicator_set_blink(led_indicator_t *led, uint32_t period, uint16_t count);
-void led_indicator_update(led_indicator_t *led, uint32_t time);
-void led_indicator_update_all(led_indicator_t *led[], uint8_t num_leds, uint32_t time);
+void led_indicator_isr(void);
 
 #endif /* INC_LED_INDICATOR_H_ */
@@ -0,0 +1,48 @@
+/*
+ * line_tokenizer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_LINE_TOKENIZER_H_
+#define INC_LINE_TOKENIZER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ring_buffer.h"
+#include "memory_config.h"
+
+
+typedef struct {
+    uint8_t text[LINE_MAX_LENGTH];  // NUL-terminated, without the line ending
+    uint16_t len;
+} command_line_t;
+
+// Tells the tokenizer that a completed line may change the framing once it is executed
+typedef bool (*line_barrier_t)(const command_line_t *line, bool zero_delimited);
+
+typedef enum {
+    LINE_STATE_TEXT,     // Collecting characters of a line
+    LINE_STATE_CR,       // Just saw CR; a following LF belongs to the same line ending
+    LINE_STATE_DISCARD   // Line is longer than LINE_MAX_LENGTH, drop it up to its line ending
+} line_state_t;
+
+typedef struct {
+    ring_buffer_t lines;       // Queue of command_line_t
+    command_line_t storage[LINE_QUEUE_SIZE];
+    command_line_t *current;   // Slot being filled, NULL until one is reserved
+    line_state_t state;
+    bool zero_delimited;       // Binary mode: only 0x00 ends a frame, CR and LF are data
+    line_barrier_t is_barrier; // Optional, see line_tokenizer_feed
+    bool held;                 // A barrier line is queued, frame nothing more until it has run
+    uint16_t num_discarded;    // Lines dropped for being too long
+} line_tokenizer_t;
+
+uint8_t line_tokenizer_init(line_tokenizer_t *t, line_barrier_t is_barrier);
+uint16_t line_tokenizer_feed(line_tokenizer_t *t, const uint8_t *data, uint16_t len);
+command_line_t* line_tokenizer_next(line_tokenizer_t *t);
+void line_tokenizer_release(line_tokenizer_t *t);
+void line_tokenizer_set_framing(line_tokenizer_t *t, bool zero_delimited);
+
+#endif /* INC_LINE_TOKENIZER_H_ */
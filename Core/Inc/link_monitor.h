@@ -0,0 +1,35 @@
+/*
+ * link_monitor.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_LINK_MONITOR_H_
+#define INC_LINK_MONITOR_H_
+
+#include <stdint.h>
+#include "cmsis_os.h"
+#include "scoreboard.h"
+
+#define LINK_DEBOUNCE_MS 50  // Link pin must be stable this long before a change is reported
+
+/*
+ * Console link monitor
+ *
+ * The LINKx EXTI interrupts report every edge of a console's link pin. The
+ * monitor debounces them so that plugging in a cable produces one change,
+ * reported to the poller task once the pin has settled, and only for
+ * the console whose link actually changed. Only the front panel ports
+ * (NUM_CONSOLE_PORTS) have a link pin; the other bits given to
+ * link_monitor_init are reported back unchanged. The thread named with
+ * link_monitor_set_notify is woken on every edge and can sleep until
+ * link_monitor_time_to_settle.
+ */
+void link_monitor_init(console_mask_t connected, uint32_t now);
+void link_monitor_edge(uint8_t console, uint8_t connected, uint32_t now);
+console_mask_t link_monitor_poll(uint32_t now, console_mask_t *connected);
+uint32_t link_monitor_time_to_settle(uint32_t now);
+void link_monitor_set_notify(osThreadId_t thread, uint32_t flags);
+
+#endif /* INC_LINK_MONITOR_H_ */
@@ -88,6 +88,7 @@ void Error_Handler(void);
 #define LED_HB_GPIO_Port GPIOC
 
 /* USER CODE BEGIN Private defines */
+#define HEARTBEAT_PERIOD_MS 500
 
 /* USER CODE END Private defines */
 
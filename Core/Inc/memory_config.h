@@ -0,0 +1,48 @@
+/*
+ * memory_config.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_MEMORY_CONFIG_H_
+#define INC_MEMORY_CONFIG_H_
+
+/*
+ * Memory configuration
+ *
+ * Every task stack, kernel object and buffer is allocated statically by the
+ * module that owns it, sized from the definitions below. Nothing is taken
+ * from the FreeRTOS heap or from newlib malloc at run time, so there is no
+ * allocation that can fail after start-up. Each module sums the sizeof of
+ * what it owns into the RAM map (ram_budget.h), which @sysinfo reports
+ * against RAM_BUDGET_LIMIT.
+ *
+ * Set in the .ioc, listed here for the budget:
+ *   defaultTask stack (command task)    COMMAND_TASK_STACK_WORDS
+ *   APP_RX_DATA_SIZE, APP_TX_DATA_SIZE  USB CDC receive banks and IN staging buffer
+ *   configTOTAL_HEAP_SIZE               FreeRTOS heap, unused by the application
+ */
+
+// Task stacks, in 32-bit words
+#define COMMAND_TASK_STACK_WORDS    384  // Must match defaultTask in the .ioc
+#define USB_TX_TASK_STACK_WORDS     128
+#define POLLER_TASK_STACK_WORDS     384
+#define TELEMETRY_TASK_STACK_WORDS  512
+
+// Command path
+#define LINE_MAX_LENGTH      128   // Including the terminating NUL
+#define LINE_QUEUE_SIZE      4     // Complete lines waiting to be executed (power of two)
+#define COMMAND_OUTPUT_SIZE  256   // Text response scratch buffer of the command handlers
+
+// USB output
+#define USB_TX_STREAM_SIZE   4096  // Bytes queued for the IN endpoint
+
+// Consoles
+#define CONSOLE_REQUEST_QUEUE_SIZE 8
+#define I2C_COMMAND_QUEUE_SIZE     8  // Power of two
+#define I2C_POLL_QUEUE_SIZE        32 // Power of two, at least the consoles on one bus
+
+#define RAM_BUDGET_LIMIT     (96 * 1024)  // Of the 128 KB SRAM; the rest is HAL, USB stack, newlib and the MSP stack
+
+#endif /* INC_MEMORY_CONFIG_H_ */
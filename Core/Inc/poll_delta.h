@@ -0,0 +1,79 @@
+/*
+ * poll_delta.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_POLL_DELTA_H_
+#define INC_POLL_DELTA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "scoreboard.h"
+
+#define POLL_KEYFRAME_INTERVAL_MS  30000  // A full keyframe is sent at least this often
+#define POLL_DELTA_MIN_INTERVAL_MS 100    // Updates are batched to at most one per this interval
+
+/*
+ * Delta polling
+ *
+ * With "@poll delta" the scoreboard remembers the last score_t/stats_t it
+ * published for every console and each poll only sends the fields that
+ * changed. Idle consoles cost nothing. Every update carries a sequence
+ * number; a host that sees a gap asks for a keyframe with "@poll keyframe".
+ * A keyframe lists every field of every connected console and replaces the
+ * host's table (consoles missing from it are disconnected).
+ *
+ * Field table: X(token, name, source struct, member, kind)
+ *
+ * The order defines the field ids used by binary mode: only append.
+ */
+#define POLL_FIELD_TABLE(X) \
+    X(FIELD_GRID_SIZE,         "grid_size",         score, grid_size,         FIELD_NUMBER) \
+    X(FIELD_CLOCK_SYNC,        "clock_sync",        score, clock_sync,        FIELD_NUMBER) \
+    X(FIELD_GAME_STATUS,       "game_status",       score, game_status,       FIELD_NUMBER) \
+    X(FIELD_GAME_DIFFICULTY,   "game_difficulty",   score, game_difficulty,   FIELD_NUMBER) \
+    X(FIELD_CAUSE_OF_DEATH,    "cause_of_death",    score, cause_of_death,    FIELD_NUMBER) \
+    X(FIELD_GAME_SPEED,        "game_speed",        score, game_speed,        FIELD_NUMBER) \
+    X(FIELD_IS_CONNECTED,      "is_connected",      score, is_connected,      FIELD_NUMBER) \
+    X(FIELD_SCORE1,            "score1",            score, score1,            FIELD_NUMBER) \
+    X(FIELD_SCORE2,            "score2",            score, score2,            FIELD_NUMBER) \
+    X(FIELD_APPLES1,           "apples1",           score, apples1,           FIELD_NUMBER) \
+    X(FIELD_APPLES2,           "apples2",           score, apples2,           FIELD_NUMBER) \
+    X(FIELD_PLAYING_TIME,      "playing_time",      score, playing_time,      FIELD_NUMBER) \
+    X(FIELD_LEVEL,             "level",             score, level,             FIELD_NUMBER) \
+    X(FIELD_PLAYING_MODE,      "playing_mode",      score, playing_mode,      FIELD_NUMBER) \
+    X(FIELD_WITH_POISON,       "with_poison",       score, with_poison,       FIELD_NUMBER) \
+    X(FIELD_NUM_APPLES_EASY,   "num_apples_easy",   stats, num_apples_easy,   FIELD_NUMBER) \
+    X(FIELD_NUM_APPLES_MEDIUM, "num_apples_medium", stats, num_apples_medium, FIELD_NUMBER) \
+    X(FIELD_NUM_APPLES_HARD,   "num_apples_hard",   stats, num_apples_hard,   FIELD_NUMBER) \
+    X(FIELD_NUM_APPLES_INSANE, "num_apples_insane", stats, num_apples_insane, FIELD_NUMBER) \
+    X(FIELD_HIGH_SCORE_EASY,   "high_score_easy",   stats, high_score_easy,   FIELD_NUMBER) \
+    X(FIELD_HIGH_SCORE_MEDIUM, "high_score_medium", stats, high_score_medium, FIELD_NUMBER) \
+    X(FIELD_HIGH_SCORE_HARD,   "high_score_hard",   stats, high_score_hard,   FIELD_NUMBER) \
+    X(FIELD_HIGH_SCORE_INSANE, "high_score_insane", stats, high_score_insane, FIELD_NUMBER) \
+    X(FIELD_INITIALS_EASY,     "initials_easy",     stats, initials_easy,     FIELD_TEXT) \
+    X(FIELD_INITIALS_MEDIUM,   "initials_medium",   stats, initials_medium,   FIELD_TEXT) \
+    X(FIELD_INITIALS_HARD,     "initials_hard",     stats, initials_hard,     FIELD_TEXT) \
+    X(FIELD_INITIALS_INSANE,   "initials_insane",   stats, initials_insane,   FIELD_TEXT)
+
+#define POLL_FIELD_ENUM(token, name, source, member, kind) token,
+
+typedef enum {
+    POLL_FIELD_TABLE(POLL_FIELD_ENUM)
+    NUM_POLL_FIELDS
+} poll_field_t;
+
+_Static_assert(NUM_POLL_FIELDS <= 32, "changed fields are tracked in a 32-bit mask");
+
+typedef enum {
+    FIELD_NUMBER, FIELD_TEXT  // TEXT: three initials, packed little-endian into the value
+} field_kind_t;
+
+void poll_delta_reset(void);
+void poll_delta_request_keyframe(void);
+uint32_t poll_delta_get_seq(void);
+void poll_delta_publish(scoreboard_t *s);
+
+#endif /* INC_POLL_DELTA_H_ */
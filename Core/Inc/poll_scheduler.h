@@ -0,0 +1,45 @@
+/*
+ * poll_scheduler.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_POLL_SCHEDULER_H_
+#define INC_POLL_SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "scoreboard.h"
+
+#define POLL_INTERVAL_PLAYING_MS 100   // Game running: keep the wall display live
+#define POLL_INTERVAL_IDLE_MS    1000  // First interval once a console stops playing
+#define POLL_INTERVAL_MAX_MS     4000  // Idle interval doubles up to this
+#define POLL_INTERVAL_BOOST_MS   50    // After a command, to pick up its effect quickly
+#define POLL_BOOST_DURATION_MS   2000
+#define POLL_RATE_WINDOW_MS      10000 // Window for the measured poll rate
+
+/*
+ * Per-console poll scheduler
+ *
+ * Each console has its own poll interval derived from its last game_status:
+ * fast while a game is running, backing off exponentially while it is
+ * stopped, paused or over, and boosted for a short while after a command was
+ * sent to it. The poller task asks which consoles are due on every pass and
+ * sleeps until poll_scheduler_time_to_due in between.
+ */
+typedef struct {
+    uint16_t interval_ms;    // Current poll interval
+    uint16_t window_polls;   // Polls completed in the last full rate window
+    uint32_t num_polls;      // Polls completed since start-up
+} poll_rate_t;
+
+void poll_scheduler_init(uint32_t now);
+bool poll_scheduler_is_due(uint8_t console, uint32_t now);
+uint32_t poll_scheduler_time_to_due(console_mask_t consoles, uint32_t now);
+void poll_scheduler_started(uint8_t console, uint32_t now);
+void poll_scheduler_completed(uint8_t console, uint8_t game_status, uint32_t now);
+void poll_scheduler_boost(uint8_t console, uint32_t now);
+void poll_scheduler_get_rate(uint8_t console, poll_rate_t *rate);
+
+#endif /* INC_POLL_SCHEDULER_H_ */
@@ -0,0 +1,55 @@
+/*
+ * ram_budget.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_RAM_BUDGET_H_
+#define INC_RAM_BUDGET_H_
+
+#include <stdint.h>
+
+/*
+ * RAM map
+ *
+ * X(owner, subsystem)
+ *
+ * Every module that allocates stacks, control blocks or pools statically
+ * defines <owner>_ram_bytes next to them, as the sum of their sizeof, so the
+ * map follows the objects rather than the sizes in memory_config.h. @sysinfo
+ * reports it against RAM_BUDGET_LIMIT, and the post-build step prints the
+ * same split per object file from the linker map (Tools/ram_map.sh).
+ */
+#define RAM_BUDGET(X) \
+    X(command_task,   "command task") \
+    X(scoreboard,     "scoreboard") \
+    X(commands,       "command output") \
+    X(usb_rx,         "usb rx") \
+    X(usb_cdc,        "usb cdc") \
+    X(usb_tx,         "usb tx") \
+    X(console_poller, "console poller") \
+    X(console_health, "console health") \
+    X(poll_scheduler, "poll scheduler") \
+    X(topology,       "topology") \
+    X(i2c_engine,     "i2c engine") \
+    X(i2c_slave,      "i2c slave") \
+    X(telemetry,      "telemetry") \
+    X(sysinfo,        "sysinfo") \
+    X(kernel,         "kernel")
+
+#define RAM_BUDGET_EXTERN(owner, subsystem) extern const uint32_t owner##_ram_bytes;
+
+RAM_BUDGET(RAM_BUDGET_EXTERN)
+
+typedef struct {
+    const char *subsystem;
+    const uint32_t *bytes;  // Statically allocated RAM: stacks, control blocks and pools
+} ram_budget_entry_t;
+
+extern const ram_budget_entry_t ram_budget[];
+extern const uint8_t ram_budget_count;
+
+uint32_t ram_budget_total(void);
+
+#endif /* INC_RAM_BUDGET_H_ */
@@ -0,0 +1,81 @@
+/*
+ * register_map.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_REGISTER_MAP_H_
+#define INC_REGISTER_MAP_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "scoreboard.h"
+
+/*
+ * Register map codec, generated from REGISTER_MAP (scoreboard.h)
+ *
+ * REG_ADDR_<member> is the register of each field. Multi-byte registers are
+ * converted with a single unaligned load or store and __REV/__REV16 on the
+ * Cortex-M4; other targets (host builds) use portable shifts.
+ */
+#define REGISTER_ADDR(member, reg, type, access) REG_ADDR_##member = (reg),
+#define REGISTER_SIZE_SUM(member, reg, type, access) + type##_SIZE
+
+enum {
+    REGISTER_MAP(REGISTER_ADDR)
+    REGISTER_MAP_SIZE = 0 REGISTER_MAP(REGISTER_SIZE_SUM)
+};
+
+#define REG_READ  1
+#define REG_WRITE 0
+
+static inline uint16_t load_be16(const uint8_t *p) {
+#if defined(__ARM_ARCH_7EM__)
+    uint16_t value;
+
+    memcpy(&value, p, sizeof(value));
+    return (uint16_t) __REV16(value);
+#else
+    return (uint16_t) ((p[0] << 8) | p[1]);
+#endif
+}
+
+static inline uint32_t load_be32(const uint8_t *p) {
+#if defined(__ARM_ARCH_7EM__)
+    uint32_t value;
+
+    memcpy(&value, p, sizeof(value));
+    return __REV(value);
+#else
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+#endif
+}
+
+static inline void store_be16(uint8_t *p, uint16_t value) {
+#if defined(__ARM_ARCH_7EM__)
+    value = (uint16_t) __REV16(value);
+    memcpy(p, &value, sizeof(value));
+#else
+    p[0] = (uint8_t) (value >> 8);
+    p[1] = (uint8_t) value;
+#endif
+}
+
+static inline void store_be32(uint8_t *p, uint32_t value) {
+#if defined(__ARM_ARCH_7EM__)
+    value = __REV(value);
+    memcpy(p, &value, sizeof(value));
+#else
+    p[0] = (uint8_t) (value >> 24);
+    p[1] = (uint8_t) (value >> 16);
+    p[2] = (uint8_t) (value >> 8);
+    p[3] = (uint8_t) value;
+#endif
+}
+
+void register_encode(const i2c_scoreboard_t *data, uint8_t reg[]);
+void register_decode(const uint8_t reg[], i2c_scoreboard_t *data);
+void register_decode_range(const uint8_t reg[], i2c_scoreboard_t *data, uint8_t first, uint8_t end);
+
+#endif /* INC_REGISTER_MAP_H_ */
@@ -9,35 +9,61 @@
 #ifndef RING_BUFFER_H_
 #define RING_BUFFER_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
 #define MAX_RING_BUFFER_SIZE 32
 
+/*
+ * Single-producer/single-consumer queue
+ *
+ * The producer (e.g. the USB OUT interrupt) only ever writes head and the
+ * consumer (a task) only ever writes tail. Both indices are free-running and
+ * wrap naturally at 16 bits, so buffer_size must be a power of two no larger
+ * than 32768. Element slots are addressed with (index & mask) instead of %.
+ *
+ * Producer side: ring_buffer_enqueue, ring_buffer_enqueue_bulk,
+ *                ring_buffer_write_slot, ring_buffer_commit
+ * Consumer side: ring_buffer_dequeue, ring_buffer_dequeue_bulk, ring_buffer_peek,
+ *                ring_buffer_read_span, ring_buffer_consume, ring_buffer_flush
+ *
+ * ring_buffer_pop removes the newest element and is only safe while the
+ * producer is idle.
+ *
+ * The element storage is provided by the owner, normally a static array of
+ * buffer_size elements (see memory_config.h).
+ */
 typedef struct {
     void *data;  // Pointer to the buffer data
     size_t size;  // Size of each element in the buffer
-    uint16_t buffer_size; // Maximum number of elements in the buffer
-    uint16_t count; // Number of elements in the buffer
-    uint16_t head;  // Index of the head (write position)
-    uint16_t tail;  // Index of the tail (read position)
-    uint16_t peek;  // Index of the peek (read position)
-    bool isFull;    // Flag indicating if the buffer is full
-    bool new_data;  // Flag indicating if new data has been added to the buffer
-    uint16_t num_overflows; // Number of times the buffer has overflowed
-    uint16_t num_new_data;  // Number of new data added to the buffer
+    uint16_t buffer_size; // Maximum number of elements in the buffer (power of two)
+    uint16_t mask;  // buffer_size - 1
+    volatile uint16_t head;  // Free-running write index, owned by the producer
+    volatile uint16_t tail;  // Free-running read index, owned by the consumer
+    volatile bool new_data;  // Flag indicating if new data has been added to the buffer
+    volatile uint16_t num_overflows; // Number of elements rejected because the buffer was full
+    volatile uint16_t num_new_data;  // Number of new data added to the buffer
 } ring_buffer_t;
 
 enum {
-    RING_BUFFER_OK, RING_BUFFER_ERROR, RING_BUFFER_MALLOC_FAILED, RING_BUFFER_EMPTY, RING_BUFFER_OFFSET_OUT_OF_BOUNDS
+    RING_BUFFER_OK, RING_BUFFER_ERROR, RING_BUFFER_EMPTY, RING_BUFFER_OFFSET_OUT_OF_BOUNDS
 };
 
-uint8_t ring_buffer_init(ring_buffer_t *buffer, uint16_t buffer_size, size_t data_size);
+uint8_t ring_buffer_init(ring_buffer_t *buffer, void *storage, uint16_t buffer_size, size_t data_size);
 uint8_t ring_buffer_destroy(ring_buffer_t *buffer);
 bool is_ring_buffer_empty(const ring_buffer_t *buffer);
 bool is_ring_buffer_full(const ring_buffer_t *buffer);
+uint16_t ring_buffer_count(const ring_buffer_t *buffer);
+uint16_t ring_buffer_space(const ring_buffer_t *buffer);
 bool ring_buffer_enqueue(ring_buffer_t *buffer, const void *value);
 bool ring_buffer_dequeue(ring_buffer_t *buffer, void *value);
+uint16_t ring_buffer_enqueue_bulk(ring_buffer_t *buffer, const void *values, uint16_t num_values);
+uint16_t ring_buffer_dequeue_bulk(ring_buffer_t *buffer, void *values, uint16_t num_values);
+uint16_t ring_buffer_read_span(ring_buffer_t *buffer, void **span);
+void ring_buffer_consume(ring_buffer_t *buffer, uint16_t num_values);
+void* ring_buffer_write_slot(ring_buffer_t *buffer);
+void ring_buffer_commit(ring_buffer_t *buffer, uint16_t num_values);
 bool ring_buffer_pop(ring_buffer_t *buffer, void *value);
 uint8_t ring_buffer_peek(const ring_buffer_t *buffer, uint16_t offset, void *value);
 void ring_buffer_flush(ring_buffer_t *buffer);
@@ -8,16 +8,19 @@
 #ifndef INC_SCOREBOARD_H_
 #define INC_SCOREBOARD_H_
 
-#define MAX_NUM_CONSOLES 5
+#define MAX_NUM_CONSOLES  32 // Console slots (see console_topology.h), at most 32
+#define NUM_CONSOLE_PORTS 5  // Front panel ports with a link pin and LED: slots 0 to 4
 
 #include "main.h"
 #include "serial.h"
 #include "ring_buffer.h"
 #include "game_stats.h"
 
+typedef uint32_t console_mask_t;  // Bit per console slot
+
 // Bit Definitions for the console_info
 #define CONSOLE_SIGNATURE   (0b11000000) // Fixed signature bits
-#define CONSOLE_IDENTIFIER  (0b00000111) // Between 1 and 5 (I2C addresses 0x10 - 0x14)
+#define CONSOLE_IDENTIFIER  (0b00000111) // Between 1 and 5 (I2C addresses 0x10 - 0x14), per multiplexer channel
 #define CONSOLE_CLOCK_SYNC  (0b00001000) // 0 = no, 1 = yes
 #define CONSOLE_CLOCK_SHIFT (3)
 #define GAME_LEVEL_MODE     (0b00110000) // 0 = easy, 1 = medium, 2 = hard, 3 = insane)
@@ -66,6 +69,11 @@
 // +-----+----+-------+--------+--------+
 // |00000| CMD|RESERVE|  PARAM2|  PARAM1|
 // +-----+----+-------+--------+--------+
+//
+// I2C_CMD_START_GAME uses bits 8-22 for the start delay instead: the console
+// starts the game START_DELAY_UNIT_US * delay after the STOP of the write, so
+// that all consoles start together although they are written one after the
+// other (see i2c_engine_send_start).
 
 #define I2C_CMD_SET_SPEED       (0b0001 << 23)
 #define I2C_CMD_SET_LEVEL       (0b0010 << 23)
@@ -81,39 +89,82 @@
 #define PARAM1_SHIFT            (0)
 #define PARAM2_MASK             (0b11111111 << 8)
 #define PARAM2_SHIFT            (8)
+#define START_DELAY_MASK        (0x7FFF << 8)
+#define START_DELAY_SHIFT       (8)
+#define START_DELAY_UNIT_US     (100)
 
-typedef struct {                    // Register Map
-    uint8_t console_info;           // 0x00
-    uint8_t current_game_state;     // 0x01
-    uint8_t current_game_state2;    // 0x02
-    uint8_t current_game_state3;    // 0x03
-    uint16_t current_score1;        // 0x04
-    uint16_t current_score2;        // 0x06
-    uint16_t number_apples1;        // 0x08
-    uint16_t number_apples2;        // 0x0A
-    uint16_t high_score;            // 0x0C
-    uint16_t playing_time;          // 0x0E
-    uint16_t num_apples_easy;       // 0x10
-    uint16_t num_apples_medium;     // 0x12
-    uint16_t num_apples_hard;       // 0x14
-    uint16_t num_apples_insane;     // 0x16
-    uint16_t high_score_easy;       // 0x18
-    uint16_t high_score_medium;     // 0x1A
-    uint16_t high_score_hard;       // 0x1C
-    uint16_t high_score_insane;     // 0x1E
-    char initials_easy[3];          // 0x20
-    char initials_medium[3];        // 0x23
-    char initials_hard[3];          // 0x26
-    char initials_insane[3];        // 0x29
-    uint32_t date_time;             // 0x2C
-    uint32_t command;               // 0x30
-    uint32_t random_seed;           // 0x34
+/*
+ * Register map
+ *
+ * X(member, register, type, access)
+ *
+ * One line per console register: i2c_scoreboard_t and the register codec
+ * (register_map.h) are generated from it. Multi-byte registers are
+ * big-endian. REG_READ registers are written by the console and read by the
+ * master, REG_WRITE registers are written by the master only.
+ *
+ * The hot and cold blocks are each framed by a pair of sequence registers
+ * (see struct2register and i2c_master_torn_blocks).
+ */
+#define REGISTER_MAP(X) \
+    X(hot_seq_begin,       0x00, REG_TYPE_U8,    REG_READ) \
+    X(console_info,        0x01, REG_TYPE_U8,    REG_READ) \
+    X(current_game_state,  0x02, REG_TYPE_U8,    REG_READ) \
+    X(current_game_state2, 0x03, REG_TYPE_U8,    REG_READ) \
+    X(current_game_state3, 0x04, REG_TYPE_U8,    REG_READ) \
+    X(current_score1,      0x05, REG_TYPE_U16,   REG_READ) \
+    X(current_score2,      0x07, REG_TYPE_U16,   REG_READ) \
+    X(number_apples1,      0x09, REG_TYPE_U16,   REG_READ) \
+    X(number_apples2,      0x0B, REG_TYPE_U16,   REG_READ) \
+    X(high_score,          0x0D, REG_TYPE_U16,   REG_READ) \
+    X(playing_time,        0x0F, REG_TYPE_U16,   REG_READ) \
+    X(stats_generation,    0x11, REG_TYPE_U16,   REG_READ) /* Incremented when the cold block changes */ \
+    X(hot_seq_end,         0x13, REG_TYPE_U8,    REG_READ) \
+    X(cold_seq_begin,      0x14, REG_TYPE_U8,    REG_READ) \
+    X(num_apples_easy,     0x15, REG_TYPE_U16,   REG_READ) \
+    X(num_apples_medium,   0x17, REG_TYPE_U16,   REG_READ) \
+    X(num_apples_hard,     0x19, REG_TYPE_U16,   REG_READ) \
+    X(num_apples_insane,   0x1B, REG_TYPE_U16,   REG_READ) \
+    X(high_score_easy,     0x1D, REG_TYPE_U16,   REG_READ) \
+    X(high_score_medium,   0x1F, REG_TYPE_U16,   REG_READ) \
+    X(high_score_hard,     0x21, REG_TYPE_U16,   REG_READ) \
+    X(high_score_insane,   0x23, REG_TYPE_U16,   REG_READ) \
+    X(initials_easy,       0x25, REG_TYPE_TEXT3, REG_READ) \
+    X(initials_medium,     0x28, REG_TYPE_TEXT3, REG_READ) \
+    X(initials_hard,       0x2B, REG_TYPE_TEXT3, REG_READ) \
+    X(initials_insane,     0x2E, REG_TYPE_TEXT3, REG_READ) \
+    X(cold_seq_end,        0x31, REG_TYPE_U8,    REG_READ) \
+    X(date_time,           0x32, REG_TYPE_U32,   REG_READ) \
+    X(command,             0x36, REG_TYPE_U32,   REG_WRITE) \
+    X(random_seed,         0x3A, REG_TYPE_U32,   REG_WRITE)
+
+#define REG_TYPE_U8_CTYPE     uint8_t
+#define REG_TYPE_U8_DIM
+#define REG_TYPE_U8_SIZE      1
+#define REG_TYPE_U16_CTYPE    uint16_t
+#define REG_TYPE_U16_DIM
+#define REG_TYPE_U16_SIZE     2
+#define REG_TYPE_U32_CTYPE    uint32_t
+#define REG_TYPE_U32_DIM
+#define REG_TYPE_U32_SIZE     4
+#define REG_TYPE_TEXT3_CTYPE  char
+#define REG_TYPE_TEXT3_DIM    [3]
+#define REG_TYPE_TEXT3_SIZE   3
+
+#define REGISTER_MEMBER(member, reg, type, access) type##_CTYPE member type##_DIM;
+
+typedef struct {
+    REGISTER_MAP(REGISTER_MEMBER)
 } i2c_scoreboard_t;
 
 typedef enum mode {
-    TERMINAL_CONSOLE_MODE, PC_CONSOLE_MODE, SCOREBOARD_MODE, NUM_MODES
+    TERMINAL_CONSOLE_MODE, PC_CONSOLE_MODE, SCOREBOARD_MODE, BINARY_MODE, NUM_MODES
 } mode_t;
 
+typedef enum {
+    POLL_OFF, POLL_FULL, POLL_DELTA  // FULL: @scores every poll, DELTA: changed fields only (poll_delta.h)
+} polling_mode_t;
+
 typedef enum {
     NO_COLLISION, SNAKE_BODY_COLLISION, FOOD_COLLISION, POISON_FOOD_COLLISION, WALL_COLLISION, SNAKE_SELF_COLLISION
 } snake_collision_t;
@@ -123,7 +174,7 @@ typedef enum {
 } grid_size_options_t;
 
 typedef struct score {
-    uint8_t console_id;
+    uint8_t console_id;  // Slot + 1, unique across buses and multiplexer channels
     grid_size_options_t grid_size;
     uint8_t clock_sync;
     uint8_t game_status;
@@ -159,7 +210,7 @@ typedef struct stats {
 typedef struct scoreboard {
     uint8_t num_consoles;
     mode_t mode;
-    uint8_t polling_mode;
+    polling_mode_t polling_mode;
     uint8_t demo_mode;
     uint8_t is_demo_mode_initialized;
     uint8_t is_tournament_mode;
@@ -169,7 +220,17 @@ typedef struct scoreboard {
 } scoreboard_t;
 
 
+#define SCOREBOARD_FLAG_RX (1UL << 0)  // Thread flag of the command task: USB packet received
+
 void scoreboard_init();
 void scoreboard_start();
+void scoreboard_lock(void);
+void scoreboard_unlock(void);
+void scoreboard_response_lock(void);
+void scoreboard_response_unlock(void);
+scoreboard_t* scoreboard_snapshot(void);
+void scoreboard_rx_isr(void);
+uint16_t scoreboard_lines_discarded(void);
+uint32_t rng_get(uint32_t max_value);
 
 #endif /* INC_SCOREBOARD_H_ */
@@ -0,0 +1,38 @@
+/*
+ * stream_writer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_STREAM_WRITER_H_
+#define INC_STREAM_WRITER_H_
+
+#include <stdint.h>
+#include "scoreboard.h"
+
+#define STREAM_WRITER_CHUNK 64  // One full-speed CDC packet
+
+/*
+ * Streaming text serializer
+ *
+ * Output is assembled in one packet-sized chunk and handed to the UI layer
+ * each time the chunk fills up, so a response of any length needs only this
+ * much RAM and never goes through printf.
+ */
+typedef struct {
+    scoreboard_t *scoreboard;
+    mode_t mode;   // Output is dropped unless the scoreboard is in this mode
+    uint8_t len;
+    uint8_t chunk[STREAM_WRITER_CHUNK];
+} stream_writer_t;
+
+void sw_begin(stream_writer_t *w, scoreboard_t *scoreboard, mode_t mode);
+void sw_write(stream_writer_t *w, const char *data, uint16_t len);
+void sw_puts(stream_writer_t *w, const char *str);
+void sw_putc(stream_writer_t *w, char c);
+void sw_uint(stream_writer_t *w, uint32_t value);
+void sw_uint_pad(stream_writer_t *w, uint32_t value, uint8_t width);
+void sw_flush(stream_writer_t *w);
+
+#endif /* INC_STREAM_WRITER_H_ */
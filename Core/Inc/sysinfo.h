@@ -0,0 +1,51 @@
+/*
+ * sysinfo.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_SYSINFO_H_
+#define INC_SYSINFO_H_
+
+#include <stdint.h>
+
+#define SYSINFO_MAX_TASKS 8  // Application tasks plus the idle and timer tasks
+
+/*
+ * System information
+ *
+ * The FreeRTOS run time counter is TIM2, which wraps in under a minute, so
+ * lifetime percentages are meaningless. Instead the task states are sampled
+ * once a second (console poller housekeeping) and the CPU load of each task
+ * is the share of run time it got between the last two samples.
+ */
+typedef struct {
+    const char *name;
+    uint8_t cpu_percent;      // Over the last sample window
+    uint16_t stack_free;      // Stack high-water mark: least free stack ever, in words
+} sysinfo_task_t;
+
+typedef struct {
+    uint32_t free_bytes;
+    uint32_t min_free_bytes;  // Least free since reset
+    uint32_t largest_block;   // Largest free block
+    uint32_t num_allocations; // Successful pvPortMalloc calls, 0 while all allocation is static
+    uint8_t fragmentation;    // Percent of the free bytes not in the largest block
+} sysinfo_heap_t;
+
+typedef struct {
+    uint32_t usb_rx_overflows;   // Packets the USB receive ring rejected
+    uint32_t usb_rx_stalls;      // Times the host was held off because every bank was full
+    uint32_t usb_tx_dropped;     // Output bytes dropped
+    uint32_t lines_discarded;    // Command lines longer than LINE_MAX_LENGTH
+    uint32_t i2c_dropped;        // I2C jobs rejected by a full queue
+    uint32_t requests_dropped;   // Console requests rejected by a full queue
+} sysinfo_overflows_t;
+
+void sysinfo_sample(void);
+uint8_t sysinfo_get_tasks(sysinfo_task_t *tasks, uint8_t max_tasks);
+void sysinfo_get_heap(sysinfo_heap_t *heap);
+void sysinfo_get_overflows(sysinfo_overflows_t *overflows);
+
+#endif /* INC_SYSINFO_H_ */
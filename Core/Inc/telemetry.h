@@ -0,0 +1,32 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#include <stdint.h>
+#include "cmsis_os.h"
+#include "scoreboard.h"
+
+// Event flags of the telemetry task
+#define TELEMETRY_EVENT_RESULTS (1UL << 0)  // Console data changed
+#define TELEMETRY_EVENT_TICK    (1UL << 1)  // Housekeeping interval elapsed
+#define TELEMETRY_EVENTS        (TELEMETRY_EVENT_RESULTS | TELEMETRY_EVENT_TICK)
+
+/*
+ * Telemetry task
+ *
+ * Sends the unsolicited output of the polling modes: the full score list
+ * once per housekeeping interval (POLL_FULL) and batched delta updates
+ * (POLL_DELTA, poll_delta.h). It sleeps on an event group the poller task
+ * sets, and formats from a scoreboard snapshot under the response lock, so
+ * its output is never mixed into the response to a command.
+ */
+void telemetry_init(void);
+void telemetry_notify(uint32_t events);
+
+#endif /* INC_TELEMETRY_H_ */
@@ -11,11 +11,18 @@
 #include "main.h"
 #include "usbd_cdc_if.h"
 #include "scoreboard.h"
+#include "commands.h"
 
 #define UI_BUFFER_SIZE 256
+#define REQUEST_ID_LENGTH 12  // Longest accepted request id, including the leading '#'
 
-void echo_terminal(scoreboard_t *s, uint8_t *rx_value);
+void echo_terminal(scoreboard_t *s, uint8_t *rx_value, uint16_t len);
 void print_terminal(scoreboard_t *s, char *message);
 void print_scoreboard(scoreboard_t *s, char *message);
 void print_pc_console(scoreboard_t *s, char *message);
+void print_bytes(scoreboard_t *s, mode_t mode, const uint8_t *data, uint16_t len);
+void print_binary(scoreboard_t *s, uint8_t type, const void *payload, uint16_t len);
+void ui_begin_response(const char *request_id);
+void ui_begin_binary_response(uint8_t seq);
+void ui_end_response(scoreboard_t *s, command_t command, uint8_t status);
 #endif /* INC_UI_H_ */
@@ -0,0 +1,28 @@
+/*
+ * usb_tx.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#ifndef INC_USB_TX_H_
+#define INC_USB_TX_H_
+
+#include <stdint.h>
+#include "memory_config.h"
+
+#define USB_TX_WRITE_TIMEOUT_MS 20    // Longest a writer waits for room before dropping
+#define USB_TX_CPLT_TIMEOUT_MS  100   // Re-check the link if a transfer takes longer than this
+
+typedef struct {
+    uint32_t bytes_sent;     // Bytes handed to the USB stack
+    uint32_t num_transfers;  // IN transfers started (each may span several 64-byte packets)
+    uint32_t bytes_dropped;  // Bytes discarded because the stream stayed full or the host was gone
+} usb_tx_stats_t;
+
+void usb_tx_init(void);
+uint16_t usb_tx_write(const uint8_t *data, uint16_t len);
+void usb_tx_complete_isr(void);
+void usb_tx_get_stats(usb_tx_stats_t *stats);
+
+#endif /* INC_USB_TX_H_ */
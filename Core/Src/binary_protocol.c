@@ -0,0 +1,205 @@
+/*
+ * binary_protocol.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include <string.h>
+
+#include "binary_protocol.h"
+
+// CRC-16/CCITT-FALSE, one nibble at a time (32 bytes of table instead of 512)
+static const uint16_t crc16_nibble_table[16] = { 0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF };
+
+/*-----------------------------------------------------------------------------
+ * Function: crc16_ccitt
+ *
+ * Update a CRC-16/CCITT-FALSE over a block of bytes. Start with 0xFFFF.
+ *
+ * Parameters: const uint8_t *data - bytes to checksum
+ *             uint16_t len - number of bytes
+ *             uint16_t crc - running CRC
+ * Return: uint16_t - updated CRC
+ *---------------------------------------------------------------------------*/
+uint16_t crc16_ccitt(const uint8_t *data, uint16_t len, uint16_t crc) {
+    while (len--) {
+        crc = (crc << 4) ^ crc16_nibble_table[(crc >> 12) ^ (*data >> 4)];
+        crc = (crc << 4) ^ crc16_nibble_table[(crc >> 12) ^ (*data & 0x0F)];
+        data++;
+    }
+    return crc;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: cobs_encode
+ *
+ * Consistent Overhead Byte Stuffing. The output contains no 0x00 bytes and is
+ * at most len + len / 254 + 1 bytes long. The frame delimiter is not added.
+ *
+ * Parameters: const uint8_t *src - bytes to encode
+ *             uint16_t len - number of bytes
+ *             uint8_t *dst - encoded output, must not overlap src
+ * Return: uint16_t - encoded length
+ *---------------------------------------------------------------------------*/
+uint16_t cobs_encode(const uint8_t *src, uint16_t len, uint8_t *dst) {
+    uint8_t *code = dst;
+    uint8_t *out = dst + 1;
+    uint8_t run = 1;
+
+    while (len--) {
+        if (*src != 0) {
+            *out++ = *src;
+            run++;
+        }
+        if (*src++ == 0 || run == 0xFF) {
+            *code = run;
+            code = out++;
+            run = 1;
+        }
+    }
+    *code = run;
+    return out - dst;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: cobs_decode
+ *
+ * Reverse cobs_encode. Decoding in place (dst == src) is allowed since the
+ * output is never longer than the input.
+ *
+ * Parameters: const uint8_t *src - encoded bytes, without the delimiter
+ *             uint16_t len - number of encoded bytes
+ *             uint8_t *dst - decoded output
+ * Return: uint16_t - decoded length, 0 if the input is malformed
+ *---------------------------------------------------------------------------*/
+uint16_t cobs_decode(const uint8_t *src, uint16_t len, uint8_t *dst) {
+    const uint8_t *end = src + len;
+    uint8_t *out = dst;
+    uint8_t code;
+
+    while (src < end) {
+        code = *src++;
+        if (code == 0 || src + code - 1 > end) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            *out++ = *src++;
+        }
+        if (code != 0xFF && src < end) {
+            *out++ = 0;
+        }
+    }
+    return out - dst;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: binary_encode_frame
+ *
+ * Build a complete frame: header, payload and CRC, COBS encoded and
+ * terminated with 0x00.
+ *
+ * Parameters: uint8_t type - record type
+ *             uint8_t seq - sequence number of the request being answered
+ *             const void *payload - record payload
+ *             uint16_t len - payload length, at most BINARY_MAX_PAYLOAD
+ *             uint8_t *frame - output, at least BINARY_MAX_ENCODED bytes
+ * Return: uint16_t - frame length including the delimiter
+ *---------------------------------------------------------------------------*/
+uint16_t binary_encode_frame(uint8_t type, uint8_t seq, const void *payload, uint16_t len, uint8_t *frame) {
+    uint8_t record[BINARY_MAX_FRAME];
+    uint16_t crc;
+    uint16_t encoded;
+
+    if (len > BINARY_MAX_PAYLOAD) {
+        len = BINARY_MAX_PAYLOAD;
+    }
+    record[0] = type;
+    record[1] = seq;
+    memcpy(&record[2], payload, len);
+    crc = crc16_ccitt(record, len + 2, 0xFFFF);
+    record[len + 2] = crc & 0xFF;
+    record[len + 3] = crc >> 8;
+
+    encoded = cobs_encode(record, len + 4, frame);
+    frame[encoded] = 0;
+    return encoded + 1;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: binary_parse_request
+ *
+ * Decode a request frame (delimiter already stripped) in place, check its CRC
+ * and parse its parameter text against the command's descriptors.
+ *
+ * Parameters: uint8_t *frame - COBS encoded frame, overwritten
+ *             uint16_t len - encoded length
+ *             uint8_t *seq - sequence number to echo in the response
+ *             command_args_t *args - requested command and its parameters
+ * Return: binary_status_t - BINARY_STATUS_OK or the reason the request was rejected
+ *---------------------------------------------------------------------------*/
+binary_status_t binary_parse_request(uint8_t *frame, uint16_t len, uint8_t *seq, command_args_t *args) {
+    command_t command;
+
+    args->command = INVALID_COMMAND;
+    args->name.ptr = frame;
+    args->name.len = 0;
+    args->num_values = 0;
+    *seq = 0;
+
+    len = cobs_decode(frame, len, frame);
+    if (len < 4 || crc16_ccitt(frame, len - 2, 0xFFFF) != (frame[len - 2] | (frame[len - 1] << 8))) {
+        return BINARY_STATUS_BAD_FRAME;
+    }
+    command = frame[0];
+    *seq = frame[1];
+    args->command = command;
+    if (command < CMD_TERMINAL_MODE || command >= NUM_COMMANDS) {
+        return BINARY_STATUS_INVALID_COMMAND;
+    }
+
+    switch (parse_parameters(command, &frame[2], len - 4, args)) {
+        case PARSE_OK:
+            return BINARY_STATUS_OK;
+        case PARSE_PARAMETER_COUNT:
+            return BINARY_STATUS_INVALID_PARAMETER_COUNT;
+        default:
+            return BINARY_STATUS_INVALID_PARAMETER_VALUE;
+    }
+}
+
+void binary_pack_score(const score_t *score, binary_score_t *record) {
+    record->console_id = score->console_id;
+    record->grid_size = score->grid_size;
+    record->clock_sync = score->clock_sync;
+    record->game_status = score->game_status;
+    record->game_difficulty = score->game_difficulty;
+    record->cause_of_death = score->cause_of_death;
+    record->game_speed = score->game_speed;
+    record->is_connected = score->is_connected;
+    record->score1 = score->score1;
+    record->score2 = score->score2;
+    record->apples1 = score->apples1;
+    record->apples2 = score->apples2;
+    record->playing_time = score->playing_time;
+    record->level = score->level;
+    record->playing_mode = score->playing_mode;
+    record->with_poison = score->with_poison;
+}
+
+void binary_pack_stats(uint8_t console_id, const stats_t *stats, binary_stats_t *record) {
+    record->console_id = console_id;
+    record->num_apples_easy = stats->num_apples_easy;
+    record->num_apples_medium = stats->num_apples_medium;
+    record->num_apples_hard = stats->num_apples_hard;
+    record->num_apples_insane = stats->num_apples_insane;
+    record->high_score_easy = stats->high_score_easy;
+    record->high_score_medium = stats->high_score_medium;
+    record->high_score_hard = stats->high_score_hard;
+    record->high_score_insane = stats->high_score_insane;
+    memcpy(record->initials_easy, stats->initials_easy, 3);
+    memcpy(record->initials_medium, stats->initials_medium, 3);
+    memcpy(record->initials_hard, stats->initials_hard, 3);
+    memcpy(record->initials_insane, stats->initials_insane, 3);
+}
@@ -0,0 +1,313 @@
+/*
+ * command_parser.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ *
+ * Command line parsing: command lookup, parameter conversion and the console
+ * command register encoding. Kept apart from the command handlers so it has
+ * no dependencies beyond commands.h and can be built into the host tests.
+ */
+
+#include "commands.h"
+#include <ctype.h>
+
+/*-----------------------------------------------------------------------------
+ * Command table, hash slots and keywords (see COMMAND_TABLE in commands.h)
+ *---------------------------------------------------------------------------*/
+#define COMMAND_DESC(token, name, num_params, param1, param2) \
+    [token] = { name, sizeof(name) - 1, num_params, { param1, param2 } },
+
+const command_desc_t command_table[NUM_COMMANDS] = { COMMAND_TABLE(COMMAND_DESC) };
+static uint8_t command_slots[1 << COMMAND_HASH_BITS];  // Built from the names by commands_init
+static const char *const keywords[NUM_KEYWORDS] = { "off", "on", "status", "reset", "delta", "keyframe" };
+
+_Static_assert(NUM_COMMANDS <= UINT8_MAX, "command_slots holds command_t values in a byte");
+
+/*-----------------------------------------------------------------------------
+ * Function: commands_init
+ *
+ * Build the hash slots from the command names. C cannot hash a string
+ * literal at compile time, so this runs once at start-up in every build; a
+ * collision or an over-long name means COMMAND_HASH_SEED has to be changed
+ * (Tests/commands_test catches that on the host before flashing).
+ *
+ * Parameters: None
+ * Return: bool - true if every command has a slot of its own
+ *---------------------------------------------------------------------------*/
+bool commands_init(void) {
+    const command_desc_t *desc;
+    uint32_t slot;
+
+    memset(command_slots, INVALID_COMMAND, sizeof(command_slots));
+    for (command_t i = CMD_TERMINAL_MODE; i < NUM_COMMANDS; i++) {
+        desc = &command_table[i];
+        if (desc->name_len > COMMAND_NAME_MAX) {
+            return false;
+        }
+        slot = command_hash((const uint8_t*) desc->name, desc->name_len);
+        if (command_slots[slot] != INVALID_COMMAND) {
+            return false;
+        }
+        command_slots[slot] = i;
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: command_hash
+ *
+ * Seeded FNV-1a, top COMMAND_HASH_BITS bits. Perfect over the command names
+ * for the chosen COMMAND_HASH_SEED.
+ *
+ * Parameters: const uint8_t *name - command word
+ *             uint16_t len - length of the word
+ * Return: uint32_t - slot in command_slots
+ *---------------------------------------------------------------------------*/
+uint32_t command_hash(const uint8_t *name, uint16_t len) {
+    uint32_t hash = COMMAND_HASH_SEED;
+
+    while (len--) {
+        hash ^= *name++;
+        hash *= 16777619u;
+    }
+    return hash >> (32 - COMMAND_HASH_BITS);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: find_command
+ *
+ * Look a command word up with one hash and one compare.
+ *
+ * Parameters: str_view_t name - command word
+ * Return: command_t - the command, or INVALID_COMMAND
+ *---------------------------------------------------------------------------*/
+command_t find_command(str_view_t name) {
+    const command_desc_t *desc;
+    command_t command;
+
+    if (name.len == 0 || name.len > COMMAND_NAME_MAX) {
+        return INVALID_COMMAND;
+    }
+    command = command_slots[command_hash(name.ptr, name.len)];
+    desc = &command_table[command];
+    if (command == INVALID_COMMAND || desc->name_len != name.len || memcmp(desc->name, name.ptr, name.len) != 0) {
+        return INVALID_COMMAND;
+    }
+    return command;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: next_word
+ *
+ * Split the next space separated word off the front of a view.
+ *
+ * Parameters: str_view_t *text - remaining text, advanced past the word
+ * Return: str_view_t - the word, empty when the text is exhausted
+ *---------------------------------------------------------------------------*/
+static str_view_t next_word(str_view_t *text) {
+    str_view_t word;
+
+    while (text->len > 0 && isspace(*text->ptr)) {
+        text->ptr++;
+        text->len--;
+    }
+    word.ptr = text->ptr;
+    while (text->len > 0 && !isspace(*text->ptr)) {
+        text->ptr++;
+        text->len--;
+    }
+    word.len = text->ptr - word.ptr;
+    return word;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: parse_uint
+ *
+ * Parse an unsigned decimal number that must end at a given character (or
+ * at the end of the view).
+ *
+ * Parameters: str_view_t *text - text, advanced past the number and terminator
+ *             char terminator - expected separator after the number, 0 for none
+ *             uint32_t *value - parsed value
+ * Return: bool - true if the number is well formed and does not overflow
+ *---------------------------------------------------------------------------*/
+static bool parse_uint(str_view_t *text, char terminator, uint32_t *value) {
+    uint32_t result = 0;
+    uint32_t digit;
+    uint16_t digits = 0;
+
+    while (text->len > 0 && *text->ptr >= '0' && *text->ptr <= '9') {
+        digit = *text->ptr - '0';
+        if (result > (UINT32_MAX - digit) / 10) {
+            return false;
+        }
+        result = result * 10 + digit;
+        text->ptr++;
+        text->len--;
+        digits++;
+    }
+    if (digits == 0) {
+        return false;
+    }
+    if (terminator != 0) {
+        if (text->len == 0 || *text->ptr != terminator) {
+            return false;
+        }
+        text->ptr++;
+        text->len--;
+    } else if (text->len != 0) {
+        return false;
+    }
+    *value = result;
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: parse_triplet
+ *
+ * Parse "a<sep>b<sep>c" (a date or a time) into three range-checked values.
+ *
+ * Parameters: str_view_t word - parameter text
+ *             char separator - '-' for dates, ':' for times
+ *             const uint32_t *min, *max - limits for each field
+ *             uint32_t *value - the three fields
+ * Return: bool - true if all three fields are present and in range
+ *---------------------------------------------------------------------------*/
+static bool parse_triplet(str_view_t word, char separator, const uint32_t *min, const uint32_t *max,
+        uint32_t *value) {
+    for (uint8_t i = 0; i < 3; i++) {
+        if (!parse_uint(&word, i < 2 ? separator : 0, &value[i]) || value[i] < min[i] || value[i] > max[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: parse_parameters
+ *
+ * Check the parameter text of a command against its descriptors and convert
+ * it into values. Shared by the line protocol and binary mode requests.
+ *
+ * Parameters: command_t command - command the parameters belong to
+ *             const uint8_t *text - parameter text (not NUL-terminated)
+ *             uint16_t len - length of the text
+ *             command_args_t *args - receives the values
+ * Return: parse_status_t - PARSE_OK or the reason the parameters were rejected
+ *---------------------------------------------------------------------------*/
+parse_status_t parse_parameters(command_t command, const uint8_t *text, uint16_t len, command_args_t *args) {
+    static const uint32_t date_min[3] = { 2000, 1, 1 }, date_max[3] = { 2099, 12, 31 };
+    static const uint32_t time_min[3] = { 0, 0, 0 }, time_max[3] = { 23, 59, 59 };
+    const command_desc_t *desc = &command_table[command];
+    str_view_t rest = { text, len };
+    str_view_t word;
+    const param_desc_t *param;
+    uint32_t *value;
+    uint8_t k;
+
+    args->command = command;
+    args->num_values = 0;
+
+    for (uint8_t i = 0; i < desc->num_params; i++) {
+        param = &desc->params[i];
+        value = &args->value[args->num_values];
+        word = next_word(&rest);
+        if (word.len == 0) {
+            return PARSE_PARAMETER_COUNT;
+        }
+        switch (param->type) {
+            case PARAM_UINT:
+                if (!parse_uint(&word, 0, value) || *value < param->min || *value > param->max) {
+                    return PARSE_PARAMETER_VALUE;
+                }
+                args->num_values++;
+                break;
+            case PARAM_KEYWORD:
+                for (k = param->min; k <= param->max; k++) {
+                    if (strlen(keywords[k]) == word.len && memcmp(keywords[k], word.ptr, word.len) == 0) {
+                        break;
+                    }
+                }
+                if (k > param->max) {
+                    return PARSE_PARAMETER_VALUE;
+                }
+                *value = k;
+                args->num_values++;
+                break;
+            case PARAM_DATE:
+            case PARAM_TIME:
+                if (param->type == PARAM_DATE ?
+                        !parse_triplet(word, '-', date_min, date_max, value) :
+                        !parse_triplet(word, ':', time_min, time_max, value)) {
+                    return PARSE_PARAMETER_VALUE;
+                }
+                args->num_values += 3;
+                break;
+            default:
+                return PARSE_PARAMETER_VALUE;
+        }
+    }
+    if (next_word(&rest).len != 0) {
+        return PARSE_PARAMETER_COUNT;
+    }
+    return PARSE_OK;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: parse_command
+ *
+ * This function will parse a command line into a command and its typed
+ * parameters. It works on views into the line and does not copy or modify it.
+ *
+ * Parameters: const uint8_t *line - command line (not necessarily NUL-terminated)
+ *             uint16_t len - length of the line
+ *             command_args_t *args - receives the command, its name and values
+ * Return: parse_status_t - PARSE_OK or the reason the line was rejected
+ *---------------------------------------------------------------------------*/
+parse_status_t parse_command(const uint8_t *line, uint16_t len, command_args_t *args) {
+    str_view_t rest = { line, len };
+    command_t command;
+
+    args->name = next_word(&rest);
+    args->command = INVALID_COMMAND;
+    args->num_values = 0;
+
+    command = find_command(args->name);
+    if (command == INVALID_COMMAND) {
+        return PARSE_UNKNOWN_COMMAND;
+    }
+    return parse_parameters(command, rest.ptr, rest.len, args);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: parse_i2c_command
+ *
+ * Build the 32-bit console command register value for a game command. The
+ * parameters have already been range-checked by parse_parameters.
+ *
+ * Parameters: const command_args_t *args - parsed command
+ * Return: uint32_t - register value, 0 if the command is not a console command
+ *---------------------------------------------------------------------------*/
+uint32_t parse_i2c_command(const command_args_t *args) {
+    switch (args->command) {
+        case CMD_SET_SPEED: // param1 = speed
+            return (args->value[0] & PARAM1_MASK) | I2C_CMD_SET_SPEED;
+        case CMD_SET_LEVEL: // param1 = level
+            return (args->value[0] & PARAM1_MASK) | I2C_CMD_SET_LEVEL;
+        case CMD_PREPARE_GAME: // param1 = level, param2 = with_poison
+            return (args->value[0] & PARAM1_MASK) | ((args->value[1] << PARAM2_SHIFT) & PARAM2_MASK)
+                    | I2C_CMD_PREPARE_GAME;
+        case CMD_START_GAME: // param1 = speed
+            return (args->value[0] & PARAM1_MASK) | I2C_CMD_START_GAME;
+        case CMD_END_GAME: // no parameters
+            return I2C_CMD_END_GAME;
+        case CMD_PAUSE_GAME: // no parameters
+            return I2C_CMD_PAUSE_GAME;
+        case CMD_RANDOM_SEED: // seed is sent separately
+            return I2C_CMD_RANDOM_SEED;
+        default:
+            return 0;
+    }
+}
+
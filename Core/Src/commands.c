@@ -6,207 +6,586 @@
  */
 
 #include "commands.h"
+#include "memory_config.h"
 #include "rtc.h"
 #include "ui.h"
-#include <ctype.h>
+#include "binary_protocol.h"
+#include "stream_writer.h"
+#include "poll_delta.h"
+#include "poll_scheduler.h"
+#include "console_health.h"
+#include "i2c_engine.h"
+#include "sysinfo.h"
+#include "ram_budget.h"
+
+static const char *const poll_names[] = { "off", "on", "delta" };
+
+// Indexed by console_id, the console slot + 1
+const char *snake_names[] = { "", "Ball Python", "Red-Tail Boa", "Black Rat Snake", "King Snake", "Corn Snake",
+        "Milk Snake", "Garter Snake", "Hognose Snake", "Green Tree Python", "Carpet Python", "Rosy Boa", "Rubber Boa",
+        "Rainbow Boa", "Gopher Snake", "Bull Snake", "Pine Snake", "Rough Green Snake", "Indigo Snake",
+        "Ribbon Snake", "Water Snake", "Blood Python", "Spotted Python", "Reticulated Python", "Anaconda",
+        "Emerald Tree Boa", "Sunbeam Snake", "Fox Snake", "Trans-Pecos Rat Snake", "Brown House Snake",
+        "Kenyan Sand Boa", "Woma Python", "Black-Headed Python" };
+_Static_assert(sizeof(snake_names) / sizeof(snake_names[0]) > MAX_NUM_CONSOLES, "snake_names needs a name per console");
+
+// execute_command buffers, static so that the command task stack only holds call frames
+static char output_buffer[COMMAND_OUTPUT_SIZE];  // Callers hold the response lock
+static uint8_t record[BINARY_MAX_PAYLOAD];
+
+const uint32_t commands_ram_bytes = sizeof(output_buffer) + sizeof(record);
 
 /*-----------------------------------------------------------------------------
- * List of valid console/PC commands
+ * Function: sw_field
+ *
+ * Append a label followed by an unsigned number, e.g. "\"score1\": " 120.
+ *
+ * Parameters: stream_writer_t *w - writer
+ *             const char *label - text written before the number
+ *             uint32_t value - number to write
+ * Return: None
  *---------------------------------------------------------------------------*/
-// Must align with command_t
-const char *valid_commands[] = { "", "", "@terminal", "@pc_console", "@scoreboard", "@set_date", "@set_time",
-        "@get_date", "@get_time", "@devices", "@scores", "@poll", "@demo", "@stats", "@set_speed", "@set_level",
-        "@prepare_game", "@start_game", "@end_game", "@pause_game", "@seed", NULL };
-uint8_t valid_num_params[] = { 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 1, 1, 2, 1, 0, 0, 1, 0 };
-const char *snake_names[] =
-        { "", "Ball Python", "Red-Tail Boa", "Black Rat Snake", "King Snake", "Corn Snake" };
+static void sw_field(stream_writer_t *w, const char *label, uint32_t value) {
+    sw_puts(w, label);
+    sw_uint(w, value);
+}
+
+static uint8_t count_connected(const scoreboard_t *scoreboard) {
+    uint8_t num_console = 0;
+
+    for (int i = 0; i < scoreboard->num_consoles; i++) {
+        if (scoreboard->scores[i].is_connected)
+            num_console++;
+    }
+    return num_console;
+}
 
+// Splits a binary list record into as many records as the entries need, see binary_page_t
+typedef struct {
+    scoreboard_t *scoreboard;
+    uint8_t type;             // binary_record_t
+    uint8_t header_len;       // Bytes before the entries, ending with the binary_page_t
+    uint8_t entry_size;
+    uint8_t per_record;
+    binary_page_t *page;
+} binary_pager_t;
 
 /*-----------------------------------------------------------------------------
- * Function: trim_whitespace
+ * Function: pager_begin
  *
- * This function will trim whitespace from a string
+ * Start a list record in the record buffer. The caller fills in the header
+ * bytes before the binary_page_t; they are repeated in every record.
  *
- * Parameters: char *dst - destination string
- *            char *src - source string
+ * Parameters: binary_pager_t *p - pager
+ *             scoreboard_t *scoreboard - pointer to the scoreboard
+ *             uint8_t type - binary_record_t
+ *             uint8_t header_len - bytes before the entries, binary_page_t included
+ *             uint8_t entry_size - bytes per entry
+ *             uint8_t total - entries in the whole list
  * Return: None
- *
- *--------------------------------------------------------------------------- */
-void trim_whitespace(char *dst, char *src) {
-    uint8_t i = 0;
-    uint8_t j = strlen(src);
-    while (isspace((unsigned char)src[i])) {
-        i++;
-    }
-    while (isspace((unsigned char)src[j])) {
-        j--;
-    }
-    strncpy(dst, src + i, j - i + 1);
-    dst[j] = '\0';
+ *---------------------------------------------------------------------------*/
+static void pager_begin(binary_pager_t *p, scoreboard_t *scoreboard, uint8_t type, uint8_t header_len,
+        uint8_t entry_size, uint8_t total) {
+    p->scoreboard = scoreboard;
+    p->type = type;
+    p->header_len = header_len;
+    p->entry_size = entry_size;
+    p->per_record = (BINARY_MAX_PAYLOAD - header_len) / entry_size;
+    p->page = (binary_page_t*) &record[header_len - sizeof(binary_page_t)];
+    p->page->first = 0;
+    p->page->count = 0;
+    p->page->total = total;
 }
 
 /*-----------------------------------------------------------------------------
- * Function: num_parameters
+ * Function: pager_entry
  *
- * This function will count the number of parameters in a string
+ * Make room for the next entry, sending the record first if it is full.
  *
- * Parameters: char *parameters - string of parameters
- * Return: uint8_t - number of parameters
+ * Parameters: binary_pager_t *p - pager
+ * Return: void* - where to write the entry
  *---------------------------------------------------------------------------*/
-uint8_t num_parameters(char *parameters) {
-    uint8_t count = 1;
-    uint8_t str_len = strlen(parameters);
-    if (str_len == 0) {
-        return 0;
+static void* pager_entry(binary_pager_t *p) {
+    if (p->page->count == p->per_record) {
+        print_binary(p->scoreboard, p->type, record, p->header_len + p->page->count * p->entry_size);
+        p->page->first += p->page->count;
+        p->page->count = 0;
     }
+    return &record[p->header_len + p->page->count++ * p->entry_size];
+}
 
-    for (int i = 0; i < str_len; i++) {
-        if (isspace((unsigned char)parameters[i])) {
-            count++;
-        }
-    }
-    return count;
+// Send the last record; an empty list still gets one
+static void pager_end(binary_pager_t *p) {
+    print_binary(p->scoreboard, p->type, record, p->header_len + p->page->count * p->entry_size);
 }
 
+/*-----------------------------------------------------------------------------
+ * Function: write_scores
+ *
+ * Stream the @scores response in the current text mode. Output goes out one
+ * USB packet at a time, so the RAM used does not grow with the console count.
+ *
+ * Parameters: scoreboard_t *scoreboard - pointer to the scoreboard
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void write_scores(scoreboard_t *scoreboard) {
+    stream_writer_t w;
+    score_t *score;
+    uint8_t first = 1;
 
-uint32_t parse_i2c_command(command_t cmd_token, uint8_t *parameter) {
-    uint32_t data = 0;
-    uint32_t param1 = 0;
-    uint32_t param2 = 0;
-    switch (cmd_token) {
-        case CMD_SET_SPEED: // param1 = speed
-            sscanf((char *)parameter, "%ld", &param1);
-            if (param1 > 0 && param1 <= 100) {
-                data = param1 & PARAM1_MASK;
-                data |= I2C_CMD_SET_SPEED;
+    sw_begin(&w, scoreboard, scoreboard->mode);
+    if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+        sw_field(&w, "\r\nScores: ", scoreboard->num_consoles);
+        sw_puts(&w, "\r\n");
+        for (int i = 0; i < scoreboard->num_consoles; i++) {
+            score = &scoreboard->scores[i];
+            if (score->is_connected) {
+                sw_field(&w, "Console ", i);
+                sw_field(&w, ": Score1: ", score->score1);
+                sw_field(&w, ", Score2: ", score->score2);
+                sw_field(&w, ", Apples1: ", score->apples1);
+                sw_field(&w, ", Apples2: ", score->apples2);
+                sw_field(&w, ", Level: ", score->level);
+                sw_field(&w, ", Poison: ", score->with_poison);
+                sw_field(&w, ", Mode: ", score->playing_mode);
+                sw_field(&w, ", Status: ", score->game_status);
+                sw_puts(&w, "\r\n");
             }
-            break;
-        case CMD_SET_LEVEL: // param1 = level
-            sscanf((char *)parameter, "%ld", &param1);
-            if (param1 > 0 && param1 <= 4) {
-                data = param1 & PARAM1_MASK;
-                data |= I2C_CMD_SET_LEVEL;
+        }
+    } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+        sw_field(&w, "OK\t", count_connected(scoreboard));
+        sw_putc(&w, '\n');
+        for (int i = 0; i < scoreboard->num_consoles; i++) {
+            score = &scoreboard->scores[i];
+            if (score->is_connected) {
+                sw_field(&w, "CONSOLE ", score->console_id);
+                sw_field(&w, "\t", score->score1);
+                sw_field(&w, "\t", score->score2);
+                sw_field(&w, "\t", score->apples1);
+                sw_field(&w, "\t", score->apples2);
+                sw_field(&w, "\t", score->level);
+                sw_field(&w, "\t", score->with_poison);
+                sw_field(&w, "\t", score->playing_mode);
+                sw_field(&w, "\t", score->game_status);
+                sw_field(&w, "\t", score->playing_time);
+                sw_putc(&w, '\n');
             }
-            break;
-        case CMD_PREPARE_GAME: // param1 = level, param2 = with_poison
-            sscanf((char *)parameter, "%ld %ld", &param1, &param2);
-            if (param1 >= 0 && param1 < 4 && param2 >= 0 && param2 <= 1) {
-                data = param1 & PARAM1_MASK;
-                data |= ((param2 << 8) & PARAM2_MASK);
-                data |= I2C_CMD_PREPARE_GAME;
+        }
+    } else {
+        for (int i = 0; i < scoreboard->num_consoles; i++) {
+            score = &scoreboard->scores[i];
+            if (!score->is_connected) {
+                continue;
             }
-            break;
-        case CMD_START_GAME: // param1 = speed
-            sscanf((char *)parameter, "%ld", &param1);
-            if (param1 <= 100) {
-                data = param1 & PARAM1_MASK;
-                data |= I2C_CMD_START_GAME;
+            if (first) {
+                sw_field(&w, "{\"tournament_mode\": ", scoreboard->is_tournament_mode);
+                sw_puts(&w, ", \"scores\":[");
+                first = 0;
+            } else {
+                sw_putc(&w, ',');
             }
-            break;
-        case CMD_END_GAME: // no parameters
-            data |= I2C_CMD_END_GAME;
-            break;
-        case CMD_PAUSE_GAME: // no parameters
-            data |= I2C_CMD_PAUSE_GAME;
-            break;
-        case CMD_RANDOM_SEED: // no parameters
-            data |= I2C_CMD_RANDOM_SEED;
-            break;
-        default:
-            return 0;
-            break;
+            sw_field(&w, "{\"console_id\":", score->console_id);
+            sw_field(&w, ", \"grid_size\":", score->grid_size);
+            sw_field(&w, ", \"clock_sync\": ", score->clock_sync);
+            sw_field(&w, ", \"game_status\": ", score->game_status);
+            sw_field(&w, ", \"game_difficulty\": ", score->game_difficulty);
+            sw_field(&w, ", \"cause_of_death\": ", score->cause_of_death);
+            sw_field(&w, ", \"game_speed\": ", score->game_speed);
+            sw_field(&w, ", \"is_connected\": ", score->is_connected);
+            sw_field(&w, ", \"score1\": ", score->score1);
+            sw_field(&w, ", \"score2\": ", score->score2);
+            sw_field(&w, ", \"apples1\": ", score->apples1);
+            sw_field(&w, ", \"apples2\": ", score->apples2);
+            sw_field(&w, ", \"level\": ", score->level);
+            sw_field(&w, ", \"playing_mode\": ", score->playing_mode);
+            sw_field(&w, ", \"with_poison\": ", score->with_poison);
+            sw_field(&w, ", \"playing_time\": ", score->playing_time);
+            sw_putc(&w, '}');
+        }
+        sw_puts(&w, first ? "{'consoles': 'none', 'status': 1}\r\n" : "]}\r\n");
     }
-    return data;
+    sw_flush(&w);
 }
 
 /*-----------------------------------------------------------------------------
- * Function: parse_command
+ * Function: write_stats
  *
- * This function will parse a command string and return the command token
+ * Stream the @stats response in the current text mode (see write_scores).
  *
- * Parameters: uint8_t *command - command string
- *             uint8_t *token - token to return
- *             uint8_t *parameter - parameter to return
- * Return: command_t - command token
+ * Parameters: scoreboard_t *scoreboard - pointer to the scoreboard
+ * Return: None
  *---------------------------------------------------------------------------*/
-command_t parse_command(uint8_t *command, uint8_t *token, uint8_t *parameter) {
-
-    char tmp_parameter[256];
-
-    memset(tmp_parameter, 0, sizeof(tmp_parameter));
+static void write_stats(scoreboard_t *scoreboard) {
+    stream_writer_t w;
+    stats_t *stats;
+    uint8_t first = 1;
 
-    strcpy((char *)token, strtok((char *)command, " "));
-    strcpy((char *)parameter, strtok(NULL, ""));
-//    sscanf((char*) command, "%s %s", token, (char*) parameter);
-    uint8_t i = 0;
-
-    trim_whitespace(tmp_parameter, (char*) parameter);
-    strcpy((char*) parameter, tmp_parameter);
-
-    uint8_t num_params = num_parameters((char*) parameter);
-
-    while (valid_commands[i] != NULL) {
-        if (strcmp((char*) token, valid_commands[i]) == 0) {
-            if (valid_num_params[i] != num_params) {
-                return INVALID_PARAMETER_COUNT;
+    sw_begin(&w, scoreboard, scoreboard->mode);
+    if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+        for (int i = 0; i < scoreboard->num_consoles; i++) {
+            stats = &scoreboard->stats[i];
+            if (!scoreboard->scores[i].is_connected) {
+                continue;
             }
-            return i;
+            sw_puts(&w, "\r\nStats for ");
+            sw_puts(&w, snake_names[scoreboard->scores[i].console_id]);
+            sw_puts(&w, " console:\r\nApples\r\n=======================\r\n");
+            sw_field(&w, "Easy: ", stats->num_apples_easy);
+            sw_field(&w, ", Medium: ", stats->num_apples_medium);
+            sw_field(&w, "\r\nHard: ", stats->num_apples_hard);
+            sw_field(&w, ", Insane: ", stats->num_apples_insane);
+            sw_puts(&w, "\r\nHigh Scores\r\n=======================\r\n");
+            sw_field(&w, "Easy: ", stats->high_score_easy);
+            sw_puts(&w, " (");
+            sw_puts(&w, stats->initials_easy);
+            sw_field(&w, "), Medium: ", stats->high_score_medium);
+            sw_puts(&w, " (");
+            sw_puts(&w, stats->initials_medium);
+            sw_field(&w, ")\r\nHard: ", stats->high_score_hard);
+            sw_puts(&w, " (");
+            sw_puts(&w, stats->initials_hard);
+            sw_field(&w, "), Insane: ", stats->high_score_insane);
+            sw_puts(&w, " (");
+            sw_puts(&w, stats->initials_insane);
+            sw_puts(&w, ")\r\n");
         }
-        i++;
+    } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+        sw_field(&w, "OK\t", count_connected(scoreboard));
+        sw_putc(&w, '\n');
+        for (int i = 0; i < scoreboard->num_consoles; i++) {
+            stats = &scoreboard->stats[i];
+            if (!scoreboard->scores[i].is_connected) {
+                continue;
+            }
+            sw_field(&w, "CONSOLE ", scoreboard->scores[i].console_id);
+            sw_field(&w, "\t", stats->num_apples_easy);
+            sw_field(&w, "\t", stats->num_apples_medium);
+            sw_field(&w, "\t", stats->num_apples_hard);
+            sw_field(&w, "\t", stats->num_apples_insane);
+            sw_field(&w, "\t", stats->high_score_easy);
+            sw_field(&w, "\t", stats->high_score_medium);
+            sw_field(&w, "\t", stats->high_score_hard);
+            sw_field(&w, "\t", stats->high_score_insane);
+            sw_putc(&w, '\t');
+            sw_puts(&w, stats->initials_easy);
+            sw_putc(&w, '\t');
+            sw_puts(&w, stats->initials_medium);
+            sw_putc(&w, '\t');
+            sw_puts(&w, stats->initials_hard);
+            sw_putc(&w, '\t');
+            sw_puts(&w, stats->initials_insane);
+            sw_putc(&w, '\n');
+        }
+    } else {
+        for (int i = 0; i < scoreboard->num_consoles; i++) {
+            stats = &scoreboard->stats[i];
+            if (!scoreboard->scores[i].is_connected) {
+                continue;
+            }
+            sw_puts(&w, first ? "{\"stats\":[" : ",");
+            first = 0;
+            sw_field(&w, "{\"console_id\":", scoreboard->scores[i].console_id);
+            sw_field(&w, ", \"num_apples_easy\":", stats->num_apples_easy);
+            sw_field(&w, ", \"num_apples_medium\": ", stats->num_apples_medium);
+            sw_field(&w, ", \"num_apples_hard\": ", stats->num_apples_hard);
+            sw_field(&w, ", \"num_apples_insane\": ", stats->num_apples_insane);
+            sw_field(&w, ", \"high_score_easy\": ", stats->high_score_easy);
+            sw_field(&w, ", \"high_score_medium\": ", stats->high_score_medium);
+            sw_field(&w, ", \"high_score_hard\": ", stats->high_score_hard);
+            sw_field(&w, ", \"high_score_insane\": ", stats->high_score_insane);
+            sw_puts(&w, ", \"initials_easy\": \"");
+            sw_puts(&w, stats->initials_easy);
+            sw_puts(&w, "\", \"initials_medium\": \"");
+            sw_puts(&w, stats->initials_medium);
+            sw_puts(&w, "\", \"initials_hard\": \"");
+            sw_puts(&w, stats->initials_hard);
+            sw_puts(&w, "\", \"initials_insane\": \"");
+            sw_puts(&w, stats->initials_insane);
+            sw_puts(&w, "\"}");
+        }
+        sw_puts(&w, first ? "{'stats': 'none', 'status': 1}\r\n" : "]}\r\n");
     }
-    return INVALID_COMMAND;
+    sw_flush(&w);
 }
 
 /*-----------------------------------------------------------------------------
- * Function: parse_date
+ * Function: write_health
  *
- * This function will parse a date string and return the year, month, and day
+ * Stream the @health response: I2C engine totals and the outcome of the last
+ * synchronized start, then the breaker state, latency and failure counts of
+ * every console slot, connected or not.
  *
- * Parameters: uint8_t *date - date string
- *             uint16_t *year - year to return
- *             uint16_t *month - month to return
- *             uint16_t *day - day to return
- * Return: uint8_t - 1 if successful, 0 if failed
+ * Parameters: scoreboard_t *scoreboard - pointer to the scoreboard
+ * Return: None
  *---------------------------------------------------------------------------*/
-uint8_t parse_date(uint8_t *date, uint16_t *year, uint16_t *month, uint16_t *day) {
-    uint8_t num_returned;
-    int y, m, d;
+static void write_health(scoreboard_t *scoreboard) {
+    stream_writer_t w;
+    i2c_engine_stats_t totals;
+    i2c_start_sync_t sync;
+    console_health_t health;
 
-    num_returned = sscanf((char*) date, "%d-%d-%d", &y, &m, &d);
-    if (num_returned < 3) {
-        return 0;
+    i2c_engine_get_stats(&totals);
+    i2c_engine_get_start_sync(&sync);
+    sw_begin(&w, scoreboard, scoreboard->mode);
+    if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+        sw_field(&w, "\r\nI2C: ", totals.num_reads);
+        sw_field(&w, " reads, ", totals.num_writes);
+        sw_field(&w, " writes, ", totals.num_errors);
+        sw_field(&w, " errors, ", totals.num_timeouts);
+        sw_field(&w, " timeouts, ", totals.num_dropped);
+        sw_field(&w, " dropped\r\nLast start: ", sync.num_started);
+        sw_field(&w, " consoles (", sync.num_late);
+        sw_field(&w, " late), skew ", sync.skew_us);
+        sw_field(&w, " us, lead ", sync.lead_us);
+        sw_puts(&w, " us\r\n");
+    } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+        sw_field(&w, "OK\t", totals.num_reads);
+        sw_field(&w, "\t", totals.num_writes);
+        sw_field(&w, "\t", totals.num_errors);
+        sw_field(&w, "\t", totals.num_timeouts);
+        sw_field(&w, "\t", totals.num_dropped);
+        sw_field(&w, "\t", sync.num_started);
+        sw_field(&w, "\t", sync.num_late);
+        sw_field(&w, "\t", sync.skew_us);
+        sw_field(&w, "\t", sync.lead_us);
+        sw_putc(&w, '\n');
     } else {
-        *year = y;
-        *month = m;
-        *day = d;
-        return 1;
+        sw_field(&w, "{\"reads\": ", totals.num_reads);
+        sw_field(&w, ", \"writes\": ", totals.num_writes);
+        sw_field(&w, ", \"errors\": ", totals.num_errors);
+        sw_field(&w, ", \"timeouts\": ", totals.num_timeouts);
+        sw_field(&w, ", \"dropped\": ", totals.num_dropped);
+        sw_field(&w, ", \"start\": {\"consoles\": ", sync.num_started);
+        sw_field(&w, ", \"late\": ", sync.num_late);
+        sw_field(&w, ", \"skew_us\": ", sync.skew_us);
+        sw_field(&w, ", \"lead_us\": ", sync.lead_us);
+        sw_puts(&w, "}, \"consoles\":[");
+    }
+    for (int i = 0; i < scoreboard->num_consoles; i++) {
+        scoreboard_lock();  // Updated by the poller
+        console_health_get(i, &health);
+        scoreboard_unlock();
+        if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+            sw_field(&w, "Console ", i + 1);
+            sw_puts(&w, ": ");
+            sw_puts(&w, console_health_state_name(health.state));
+            sw_field(&w, ", latency ", health.latency_us);
+            sw_field(&w, " us +/- ", health.latency_var_us);
+            sw_field(&w, ", budget ", health.budget_us);
+            sw_field(&w, " us, failures ", health.consecutive_failures);
+            sw_field(&w, " in a row, ", health.num_failures);
+            sw_field(&w, " total, ", health.num_trips);
+            sw_field(&w, " trips, backoff ", health.backoff_ms);
+            sw_field(&w, " ms, torn reads ", health.num_torn);
+            sw_puts(&w, "\r\n");
+        } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+            sw_field(&w, "CONSOLE ", i + 1);
+            sw_putc(&w, '\t');
+            sw_puts(&w, console_health_state_name(health.state));
+            sw_field(&w, "\t", health.latency_us);
+            sw_field(&w, "\t", health.latency_var_us);
+            sw_field(&w, "\t", health.budget_us);
+            sw_field(&w, "\t", health.consecutive_failures);
+            sw_field(&w, "\t", health.num_failures);
+            sw_field(&w, "\t", health.num_trips);
+            sw_field(&w, "\t", health.backoff_ms);
+            sw_field(&w, "\t", health.num_torn);
+            sw_putc(&w, '\n');
+        } else {
+            sw_field(&w, i == 0 ? "{\"console\": " : ",{\"console\": ", i + 1);
+            sw_puts(&w, ", \"state\": \"");
+            sw_puts(&w, console_health_state_name(health.state));
+            sw_field(&w, "\", \"latency_us\": ", health.latency_us);
+            sw_field(&w, ", \"latency_var_us\": ", health.latency_var_us);
+            sw_field(&w, ", \"budget_us\": ", health.budget_us);
+            sw_field(&w, ", \"consecutive_failures\": ", health.consecutive_failures);
+            sw_field(&w, ", \"failures\": ", health.num_failures);
+            sw_field(&w, ", \"trips\": ", health.num_trips);
+            sw_field(&w, ", \"backoff_ms\": ", health.backoff_ms);
+            sw_field(&w, ", \"torn\": ", health.num_torn);
+            sw_putc(&w, '}');
+        }
+    }
+    if (scoreboard->mode == SCOREBOARD_MODE) {
+        sw_puts(&w, "]}\r\n");
+    }
+    sw_flush(&w);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: write_rates
+ *
+ * Stream the @rates response: current poll interval and measured poll rate of
+ * every connected console.
+ *
+ * Parameters: scoreboard_t *scoreboard - pointer to the scoreboard
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void write_rates(scoreboard_t *scoreboard) {
+    stream_writer_t w;
+    poll_rate_t rate;
+    uint8_t first = 1;
+
+    sw_begin(&w, scoreboard, scoreboard->mode);
+    if (scoreboard->mode == PC_CONSOLE_MODE) {
+        sw_field(&w, "OK\t", count_connected(scoreboard));
+        sw_putc(&w, '\n');
+    } else if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+        sw_puts(&w, "\r\nPoll rates:\r\n");
+    }
+    for (int i = 0; i < scoreboard->num_consoles; i++) {
+        if (!scoreboard->scores[i].is_connected) {
+            continue;
+        }
+        scoreboard_lock();
+        poll_scheduler_get_rate(i, &rate);
+        scoreboard_unlock();
+        if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+            sw_field(&w, "Console ", scoreboard->scores[i].console_id);
+            sw_field(&w, ": every ", rate.interval_ms);
+            sw_field(&w, " ms, ", rate.window_polls);
+            sw_puts(&w, " polls in the last 10 s, ");
+            sw_uint(&w, rate.num_polls);
+            sw_puts(&w, " total\r\n");
+        } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+            sw_field(&w, "CONSOLE ", scoreboard->scores[i].console_id);
+            sw_field(&w, "\t", rate.interval_ms);
+            sw_field(&w, "\t", rate.window_polls);
+            sw_field(&w, "\t", rate.num_polls);
+            sw_putc(&w, '\n');
+        } else {
+            sw_puts(&w, first ? "{\"rates\":[" : ",");
+            first = 0;
+            sw_field(&w, "{\"console_id\":", scoreboard->scores[i].console_id);
+            sw_field(&w, ", \"interval_ms\": ", rate.interval_ms);
+            sw_field(&w, ", \"polls_10s\": ", rate.window_polls);
+            sw_field(&w, ", \"polls\": ", rate.num_polls);
+            sw_putc(&w, '}');
+        }
+    }
+    if (scoreboard->mode == SCOREBOARD_MODE) {
+        sw_puts(&w, first ? "{'rates': 'none', 'status': 1}\r\n" : "]}\r\n");
     }
+    sw_flush(&w);
 }
 
 /*-----------------------------------------------------------------------------
- * Function: parse_time
+ * Function: write_sysinfo
  *
- * This function will parse a time string and return the hour, minute, and second
+ * Stream the @sysinfo response: FreeRTOS heap usage, the overflow counters
+ * of the queues and buffers, then the CPU load over the last second and the
+ * stack high-water mark (least free stack ever, in words) of every task,
+ * and last the statically allocated RAM of each subsystem (ram_budget.h).
  *
- * Parameters: uint8_t *time - time string
- *             uint16_t *hour - hour to return
- *             uint16_t *minute - minute to return
- *             uint16_t *second - second to return
- * Return: uint8_t - 1 if successful, 0 if failed
+ * Parameters: scoreboard_t *scoreboard - pointer to the scoreboard
+ * Return: None
  *---------------------------------------------------------------------------*/
-uint8_t parse_time(uint8_t *time, uint16_t *hour, uint16_t *minute, uint16_t *second) {
-    uint8_t num_returned;
-    int h, m, s;
+static void write_sysinfo(scoreboard_t *scoreboard) {
+    stream_writer_t w;
+    sysinfo_heap_t heap;
+    sysinfo_overflows_t overflows;
+    sysinfo_task_t tasks[SYSINFO_MAX_TASKS];
+    uint8_t num_tasks;
 
-    num_returned = sscanf((char*) time, "%d:%d:%d", &h, &m, &s);
-    if (num_returned < 3) {
-        return 0;
+    sysinfo_get_heap(&heap);
+    sysinfo_get_overflows(&overflows);
+    num_tasks = sysinfo_get_tasks(tasks, SYSINFO_MAX_TASKS);
+    sw_begin(&w, scoreboard, scoreboard->mode);
+    if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+        sw_field(&w, "\r\nHeap: ", heap.free_bytes);
+        sw_field(&w, " bytes free, minimum ", heap.min_free_bytes);
+        sw_field(&w, ", largest block ", heap.largest_block);
+        sw_field(&w, ", fragmentation ", heap.fragmentation);
+        sw_field(&w, "%, ", heap.num_allocations);
+        sw_field(&w, " allocations\r\nOverflows: usb rx ", overflows.usb_rx_overflows);
+        sw_field(&w, ", usb rx stalls ", overflows.usb_rx_stalls);
+        sw_field(&w, ", usb tx bytes ", overflows.usb_tx_dropped);
+        sw_field(&w, ", long lines ", overflows.lines_discarded);
+        sw_field(&w, ", i2c jobs ", overflows.i2c_dropped);
+        sw_field(&w, ", console requests ", overflows.requests_dropped);
+        sw_puts(&w, "\r\n");
+    } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+        sw_field(&w, "OK\t", heap.free_bytes);
+        sw_field(&w, "\t", heap.min_free_bytes);
+        sw_field(&w, "\t", heap.largest_block);
+        sw_field(&w, "\t", heap.fragmentation);
+        sw_field(&w, "\t", heap.num_allocations);
+        sw_field(&w, "\t", overflows.usb_rx_overflows);
+        sw_field(&w, "\t", overflows.usb_rx_stalls);
+        sw_field(&w, "\t", overflows.usb_tx_dropped);
+        sw_field(&w, "\t", overflows.lines_discarded);
+        sw_field(&w, "\t", overflows.i2c_dropped);
+        sw_field(&w, "\t", overflows.requests_dropped);
+        sw_putc(&w, '\n');
+    } else {
+        sw_field(&w, "{\"heap\": {\"free\": ", heap.free_bytes);
+        sw_field(&w, ", \"min_free\": ", heap.min_free_bytes);
+        sw_field(&w, ", \"largest_block\": ", heap.largest_block);
+        sw_field(&w, ", \"fragmentation\": ", heap.fragmentation);
+        sw_field(&w, ", \"allocations\": ", heap.num_allocations);
+        sw_field(&w, "}, \"overflows\": {\"usb_rx\": ", overflows.usb_rx_overflows);
+        sw_field(&w, ", \"usb_rx_stalls\": ", overflows.usb_rx_stalls);
+        sw_field(&w, ", \"usb_tx_bytes\": ", overflows.usb_tx_dropped);
+        sw_field(&w, ", \"long_lines\": ", overflows.lines_discarded);
+        sw_field(&w, ", \"i2c_jobs\": ", overflows.i2c_dropped);
+        sw_field(&w, ", \"console_requests\": ", overflows.requests_dropped);
+        sw_puts(&w, "}, \"tasks\":[");
+    }
+    for (int i = 0; i < num_tasks; i++) {
+        if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+            sw_puts(&w, tasks[i].name);
+            sw_field(&w, ": cpu ", tasks[i].cpu_percent);
+            sw_field(&w, "%, stack free ", tasks[i].stack_free);
+            sw_puts(&w, " words\r\n");
+        } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+            sw_puts(&w, "TASK\t");
+            sw_puts(&w, tasks[i].name);
+            sw_field(&w, "\t", tasks[i].cpu_percent);
+            sw_field(&w, "\t", tasks[i].stack_free);
+            sw_putc(&w, '\n');
+        } else {
+            sw_puts(&w, i == 0 ? "{\"name\": \"" : ",{\"name\": \"");
+            sw_puts(&w, tasks[i].name);
+            sw_field(&w, "\", \"cpu\": ", tasks[i].cpu_percent);
+            sw_field(&w, ", \"stack_free\": ", tasks[i].stack_free);
+            sw_putc(&w, '}');
+        }
+    }
+    if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+        sw_field(&w, "RAM: ", ram_budget_total());
+        sw_field(&w, " bytes of ", RAM_BUDGET_LIMIT);
+        sw_puts(&w, "\r\n");
+    } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+        sw_field(&w, "RAM\ttotal\t", ram_budget_total());
+        sw_field(&w, "\t", RAM_BUDGET_LIMIT);
+        sw_putc(&w, '\n');
     } else {
-        *hour = h;
-        *minute = m;
-        *second = s;
-        return 1;
+        sw_field(&w, "], \"ram\": {\"total\": ", ram_budget_total());
+        sw_field(&w, ", \"limit\": ", RAM_BUDGET_LIMIT);
+        sw_puts(&w, ", \"subsystems\":[");
+    }
+    for (int i = 0; i < ram_budget_count; i++) {
+        if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+            sw_puts(&w, "  ");
+            sw_puts(&w, ram_budget[i].subsystem);
+            sw_field(&w, ": ", *ram_budget[i].bytes);
+            sw_puts(&w, " bytes\r\n");
+        } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+            sw_puts(&w, "RAM\t");
+            sw_puts(&w, ram_budget[i].subsystem);
+            sw_field(&w, "\t", *ram_budget[i].bytes);
+            sw_putc(&w, '\n');
+        } else {
+            sw_puts(&w, i == 0 ? "{\"name\": \"" : ",{\"name\": \"");
+            sw_puts(&w, ram_budget[i].subsystem);
+            sw_field(&w, "\", \"bytes\": ", *ram_budget[i].bytes);
+            sw_putc(&w, '}');
+        }
+    }
+    if (scoreboard->mode == SCOREBOARD_MODE) {
+        sw_puts(&w, "]}}\r\n");
     }
+    sw_flush(&w);
 }
 
 /*-----------------------------------------------------------------------------
@@ -215,18 +594,17 @@ uint8_t parse_time(uint8_t *time, uint16_t *hour, uint16_t *minute, uint16_t *se
  * This function will execute a command
  *
  * Parameters: scoreboard_t *scoreboard - pointer to the scoreboard
- *             command_t command - command token
- *             uint8_t *parameter - parameter
+ *             const command_args_t *args - parsed command and parameters
  * Return: cmd_status_t - status of the command
  *---------------------------------------------------------------------------*/
-cmd_status_t execute_command(scoreboard_t *scoreboard, command_t command, uint8_t *parameter) {
+cmd_status_t execute_command(scoreboard_t *scoreboard, const command_args_t *args) {
     uint16_t year, month, day, hour, minute, second;
     uint8_t num_console;
     uint8_t is_first;
-    char output_buffer[256];
+    binary_date_time_t date_time;
     memset(output_buffer, 0, sizeof(output_buffer));
 
-    switch (command) {
+    switch (args->command) {
         case CMD_TERMINAL_MODE:
             scoreboard->mode = TERMINAL_CONSOLE_MODE;
             print_terminal(scoreboard, "\r\nTerminal mode enabled\r\n");
@@ -239,49 +617,39 @@ cmd_status_t execute_command(scoreboard_t *scoreboard, command_t command, uint8_
             scoreboard->mode = SCOREBOARD_MODE;
             print_scoreboard(scoreboard, "{'mode': 'scoreboard', 'status': 1}\r\n");
             break;
-        case CMD_SET_DATE:
-            if (parse_date(parameter, &year, &month, &day)) {
-                RTC_sync_set_date(year, month, day);
-                if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
-                    sprintf(output_buffer, "\r\nDate set to %04d-%02d-%02d\r\n", year, month, day);
-                    print_terminal(scoreboard, output_buffer);
-                } else if (scoreboard->mode == PC_CONSOLE_MODE) {
-                    sprintf(output_buffer, "OK\t%04d-%02d-%02d\n", year, month, day);
-                    print_pc_console(scoreboard, output_buffer);
-                } else {
-                    sprintf(output_buffer, "{'date': '%04d-%02d-%02d', 'status': 1}\r\n", year, month, day);
-                    print_scoreboard(scoreboard, output_buffer);
-                }
+        case CMD_BINARY_MODE:
+            scoreboard->mode = BINARY_MODE;  // Acknowledged with a status record
+            break;
+        case CMD_SET_DATE:  // Validated by parse_parameters
+            year = args->value[0];
+            month = args->value[1];
+            day = args->value[2];
+            RTC_sync_set_date(year, month, day);
+            if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+                sprintf(output_buffer, "\r\nDate set to %04d-%02d-%02d\r\n", year, month, day);
+                print_terminal(scoreboard, output_buffer);
+            } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+                sprintf(output_buffer, "OK\t%04d-%02d-%02d\n", year, month, day);
+                print_pc_console(scoreboard, output_buffer);
             } else {
-                if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
-                    sprintf(output_buffer, "\r\nInvalid date\n");
-                    print_terminal(scoreboard, output_buffer);
-                } else if (scoreboard->mode == PC_CONSOLE_MODE) {
-                    sprintf(output_buffer, "ERR\tInvalid date\n");
-                    print_pc_console(scoreboard, output_buffer);
-                } else {
-                    sprintf(output_buffer, "{'error': 'Invalid date', 'status': 0}\r\n");
-                    print_scoreboard(scoreboard, output_buffer);
-                }
-                return INVALID_COMMAND;
+                sprintf(output_buffer, "{'date': '%04d-%02d-%02d', 'status': 1}\r\n", year, month, day);
+                print_scoreboard(scoreboard, output_buffer);
             }
-
             break;
-        case CMD_SET_TIME:
-            if (parse_time(parameter, &hour, &minute, &second)) {
-                RTC_sync_set_time(hour, minute, second);
-                if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
-                    sprintf(output_buffer, "\r\nTime set to %02d:%02d:%02d\r\n", hour, minute, second);
-                    print_terminal(scoreboard, output_buffer);
-                } else if (scoreboard->mode == PC_CONSOLE_MODE) {
-                    sprintf(output_buffer, "OK\t%02d:%02d:%02d\n", hour, minute, second);
-                    print_pc_console(scoreboard, output_buffer);
-                } else {
-                    sprintf(output_buffer, "{'time': '%02d:%02d:%02d', 'status': 1}\r\n", hour, minute, second);
-                    print_scoreboard(scoreboard, output_buffer);
-                }
+        case CMD_SET_TIME:  // Validated by parse_parameters
+            hour = args->value[0];
+            minute = args->value[1];
+            second = args->value[2];
+            RTC_sync_set_time(hour, minute, second);
+            if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+                sprintf(output_buffer, "\r\nTime set to %02d:%02d:%02d\r\n", hour, minute, second);
+                print_terminal(scoreboard, output_buffer);
+            } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+                sprintf(output_buffer, "OK\t%02d:%02d:%02d\n", hour, minute, second);
+                print_pc_console(scoreboard, output_buffer);
             } else {
-                return INVALID_COMMAND;
+                sprintf(output_buffer, "{'time': '%02d:%02d:%02d', 'status': 1}\r\n", hour, minute, second);
+                print_scoreboard(scoreboard, output_buffer);
             }
             break;
         case CMD_GET_DATE:
@@ -293,6 +661,14 @@ cmd_status_t execute_command(scoreboard_t *scoreboard, command_t command, uint8_
             } else if (scoreboard->mode == PC_CONSOLE_MODE) {
                 sprintf(output_buffer, "OK\t%04d-%02d-%02d\n", year, month, day);
                 print_pc_console(scoreboard, output_buffer);
+            } else if (scoreboard->mode == BINARY_MODE) {
+                date_time.year = year;
+                date_time.month = month;
+                date_time.day = day;
+                date_time.hour = hour;
+                date_time.minute = minute;
+                date_time.second = second;
+                print_binary(scoreboard, BINARY_RECORD_DATE_TIME, &date_time, sizeof(date_time));
             } else {
                 sprintf(output_buffer, "{'date': '%04d-%02d-%02d', 'status': 1}\r\n", year, month, day);
                 print_scoreboard(scoreboard, output_buffer);
@@ -307,6 +683,14 @@ cmd_status_t execute_command(scoreboard_t *scoreboard, command_t command, uint8_
             } else if (scoreboard->mode == PC_CONSOLE_MODE) {
                 sprintf(output_buffer, "OK\t%02d:%02d:%02d\n", hour, minute, second);
                 print_pc_console(scoreboard, output_buffer);
+            } else if (scoreboard->mode == BINARY_MODE) {
+                date_time.year = year;
+                date_time.month = month;
+                date_time.day = day;
+                date_time.hour = hour;
+                date_time.minute = minute;
+                date_time.second = second;
+                print_binary(scoreboard, BINARY_RECORD_DATE_TIME, &date_time, sizeof(date_time));
             } else {
                 sprintf(output_buffer, "{'time': '%02d:%02d:%02d', 'status': 1}\r\n", hour, minute, second);
                 print_scoreboard(scoreboard, output_buffer);
@@ -339,6 +723,16 @@ cmd_status_t execute_command(scoreboard_t *scoreboard, command_t command, uint8_
                     }
                 }
                 print_pc_console(scoreboard, "\n");
+            } else if (scoreboard->mode == BINARY_MODE) {
+                binary_pager_t pager;
+
+                pager_begin(&pager, scoreboard, BINARY_RECORD_DEVICES, sizeof(binary_page_t), 1, num_console);
+                for (int i = 0; i < scoreboard->num_consoles; i++) {
+                    if (scoreboard->scores[i].is_connected) {
+                        *(uint8_t*) pager_entry(&pager) = scoreboard->scores[i].console_id;
+                    }
+                }
+                pager_end(&pager);
             } else {
                 is_first = 1;
                 for (int i = 0; i < scoreboard->num_consoles; i++) {
@@ -360,235 +754,191 @@ cmd_status_t execute_command(scoreboard_t *scoreboard, command_t command, uint8_
             }
             break;
         case CMD_LIST_SCORES:
-            if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
-                sprintf(output_buffer, "\r\nScores: %d\r\n", scoreboard->num_consoles);
-                print_terminal(scoreboard, output_buffer);
-                for (int i = 0; i < scoreboard->num_consoles; i++) {
-                    if (scoreboard->scores[i].is_connected) {
-                        sprintf(output_buffer,
-                                "Console %d: Score1: %d, Score2: %d, Apples1: %d, Apples2: %d, Level: %d, Poison: %d, Mode: %d, Status: %d\r\n",
-                                i, scoreboard->scores[i].score1, scoreboard->scores[i].score2,
-                                scoreboard->scores[i].apples1, scoreboard->scores[i].apples2,
-                                scoreboard->scores[i].level, scoreboard->scores[i].with_poison,
-                                scoreboard->scores[i].playing_mode, scoreboard->scores[i].game_status);
-                        print_terminal(scoreboard, output_buffer);
-                    }
-                }
-            } else if (scoreboard->mode == PC_CONSOLE_MODE) {
-                num_console = 0;
-                for (int i = 0; i < scoreboard->num_consoles; i++) {
-                    if (scoreboard->scores[i].is_connected)
-                        num_console++;
-                }
-                sprintf(output_buffer, "OK\t%d\n", num_console);
-                print_pc_console(scoreboard, output_buffer);
+            if (scoreboard->mode == BINARY_MODE) {
+                binary_pager_t pager;
+
+                record[0] = scoreboard->is_tournament_mode;
+                pager_begin(&pager, scoreboard, BINARY_RECORD_SCORES, 1 + sizeof(binary_page_t), sizeof(binary_score_t),
+                        count_connected(scoreboard));
                 for (int i = 0; i < scoreboard->num_consoles; i++) {
                     if (scoreboard->scores[i].is_connected) {
-                        sprintf(output_buffer, "CONSOLE %d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n",
-                                scoreboard->scores[i].console_id, scoreboard->scores[i].score1,
-                                scoreboard->scores[i].score2, scoreboard->scores[i].apples1,
-                                scoreboard->scores[i].apples2, scoreboard->scores[i].level,
-                                scoreboard->scores[i].with_poison, scoreboard->scores[i].playing_mode,
-                                scoreboard->scores[i].game_status, scoreboard->scores[i].playing_time);
-                        print_pc_console(scoreboard, output_buffer);
+                        binary_pack_score(&scoreboard->scores[i], pager_entry(&pager));
                     }
                 }
+                pager_end(&pager);
             } else {
-                uint8_t first = 1;
-                uint8_t has_scores = 0;
-                for (int i = 0; i < scoreboard->num_consoles; i++) {
-                    if (!scoreboard->scores[i].is_connected) {
-                        continue;
-                    }
-                    has_scores = 1;
-                    if (first) {
-                        sprintf(output_buffer, "{\"tournament_mode\": %d, \"scores\":[", scoreboard->is_tournament_mode);
-                        print_scoreboard(scoreboard, output_buffer);
-                        first = 0;
-                    } else {
-                        print_scoreboard(scoreboard, ",");
-                    }
-
-                    sprintf(output_buffer,
-                            "{\"console_id\":%d, \"grid_size\":%d, \"clock_sync\": %d, \"game_status\": %d, \"game_difficulty\": %d, ",
-                            scoreboard->scores[i].console_id, scoreboard->scores[i].grid_size,
-                            scoreboard->scores[i].clock_sync, scoreboard->scores[i].game_status,
-                            scoreboard->scores[i].game_difficulty);
-                    print_scoreboard(scoreboard, output_buffer);
-                    sprintf(output_buffer,
-                            "\"cause_of_death\": %d, \"game_speed\": %d, \"is_connected\": %d, \"score1\": %d, \"score2\": %d, ",
-                            scoreboard->scores[i].cause_of_death, scoreboard->scores[i].game_speed,
-                            scoreboard->scores[i].is_connected, scoreboard->scores[i].score1,
-                            scoreboard->scores[i].score2);
-                    print_scoreboard(scoreboard, output_buffer);
-                    sprintf(output_buffer,
-                            "\"apples1\": %d, \"apples2\": %d, \"level\": %d, \"playing_mode\": %d, \"with_poison\": %d, ",
-                            scoreboard->scores[i].apples1, scoreboard->scores[i].apples2,
-                            scoreboard->scores[i].level, scoreboard->scores[i].playing_mode,
-                            scoreboard->scores[i].with_poison);
-                    print_scoreboard(scoreboard, output_buffer);
-                    sprintf(output_buffer, "\"playing_time\": %d}", scoreboard->scores[i].playing_time);
-                    print_scoreboard(scoreboard, output_buffer);
-                }
-                if (has_scores) {
-                    print_scoreboard(scoreboard, "]}\r\n");
-                } else {
-                    print_scoreboard(scoreboard, "{'consoles': 'none', 'status': 1}\r\n");
-                }
+                write_scores(scoreboard);
             }
             break;
         case CMD_POLLING_MODE:
-            if (strcmp((char*) parameter, "on") == 0) {
-                scoreboard->polling_mode = 1;
-            } else if (strcmp((char*) parameter, "off") == 0) {
-                scoreboard->polling_mode = 0;
-            } else {
-                if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
-                    sprintf(output_buffer, "\r\nInvalid polling mode\n");
-                    print_terminal(scoreboard, output_buffer);
-                } else if (scoreboard->mode == PC_CONSOLE_MODE) {
-                    sprintf(output_buffer, "ERR\tInvalid polling mode\n");
-                    print_pc_console(scoreboard, output_buffer);
-                } else {
-                    sprintf(output_buffer, "{'error': 'Invalid polling mode', 'status': 0}\r\n");
-                    print_scoreboard(scoreboard, output_buffer);
-                }
-                return INVALID_COMMAND;
+            switch (args->value[0]) {
+                case KEYWORD_ON:
+                    scoreboard->polling_mode = POLL_FULL;
+                    break;
+                case KEYWORD_OFF:
+                    scoreboard->polling_mode = POLL_OFF;
+                    break;
+                case KEYWORD_DELTA:
+                    scoreboard->polling_mode = POLL_DELTA;
+                    poll_delta_request_keyframe();
+                    break;
+                case KEYWORD_RESET:
+                    poll_delta_reset();
+                    break;
+                case KEYWORD_KEYFRAME:
+                    // Answer with the keyframe right away so it follows the request in order
+                    poll_delta_request_keyframe();
+                    poll_delta_publish(scoreboard);
+                    break;
+                case KEYWORD_STATUS:
+                    if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+                        sprintf(output_buffer, "\r\nPolling: %s, seq %lu\r\n", poll_names[scoreboard->polling_mode],
+                                poll_delta_get_seq());
+                        print_terminal(scoreboard, output_buffer);
+                    } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+                        sprintf(output_buffer, "OK\t%s\t%lu\n", poll_names[scoreboard->polling_mode],
+                                poll_delta_get_seq());
+                        print_pc_console(scoreboard, output_buffer);
+                    } else {
+                        sprintf(output_buffer, "{'polling': '%s', 'seq': %lu, 'status': 1}\r\n",
+                                poll_names[scoreboard->polling_mode], poll_delta_get_seq());
+                        print_scoreboard(scoreboard, output_buffer);
+                    }
+                    break;
             }
             break;
         case CMD_DEMO_MODE:
-            if (strcmp((char*) parameter, "on") == 0) {
-                scoreboard->demo_mode = 1;
-            } else if (strcmp((char*) parameter, "off") == 0) {
-                scoreboard->demo_mode = 0;
-            } else if (strcmp((char*) parameter, "status") == 0) {
-                if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
-                    sprintf(output_buffer, "\r\nDemo mode: %s\r\n", scoreboard->demo_mode ? "on" : "off");
-                    print_terminal(scoreboard, output_buffer);
-                } else if (scoreboard->mode == PC_CONSOLE_MODE) {
-                    sprintf(output_buffer, "OK\t%s\n", scoreboard->demo_mode ? "on" : "off");
-                    print_pc_console(scoreboard, output_buffer);
-                } else {
-                    sprintf(output_buffer, "{'demo_mode': '%s', 'status': 1}\r\n",
-                            scoreboard->demo_mode ? "on" : "off");
-                    print_scoreboard(scoreboard, output_buffer);
-                }
-            } else if (strcmp((char*) parameter, "reset") == 0) {
-                for (int i = 0; i < scoreboard->num_consoles; i++) {
-                    scoreboard->scores[i].score1 = 0;
-                    scoreboard->scores[i].score2 = 0;
-                    scoreboard->scores[i].apples1 = 0;
-                    scoreboard->scores[i].apples2 = 0;
-                    scoreboard->scores[i].level = 1;
-                    scoreboard->scores[i].with_poison = 0;
-                    scoreboard->scores[i].playing_mode = 0;
-                    scoreboard->scores[i].game_status = 0;
-                }
-                if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
-                    sprintf(output_buffer, "\r\nDemo mode reset\r\n");
-                    print_terminal(scoreboard, output_buffer);
-                } else if (scoreboard->mode == PC_CONSOLE_MODE) {
-                    sprintf(output_buffer, "OK\tDemo mode reset\n");
-                    print_pc_console(scoreboard, output_buffer);
-                } else {
-                    sprintf(output_buffer, "{'demo_mode': 'reset', 'status': 1}\r\n");
-                    print_scoreboard(scoreboard, output_buffer);
-                }
-            } else {
-                if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
-                    sprintf(output_buffer, "\r\nInvalid polling mode\n");
-                    print_terminal(scoreboard, output_buffer);
-                } else if (scoreboard->mode == PC_CONSOLE_MODE) {
-                    sprintf(output_buffer, "ERR\tInvalid polling mode\n");
-                    print_pc_console(scoreboard, output_buffer);
-                } else {
-                    sprintf(output_buffer, "{'error': 'Invalid polling mode', 'status': 0}\r\n");
-                    print_scoreboard(scoreboard, output_buffer);
-                }
-                return INVALID_COMMAND;
+            switch (args->value[0]) {
+                case KEYWORD_ON:
+                    scoreboard->demo_mode = 1;
+                    break;
+                case KEYWORD_OFF:
+                    scoreboard->demo_mode = 0;
+                    break;
+                case KEYWORD_STATUS:
+                    if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+                        sprintf(output_buffer, "\r\nDemo mode: %s\r\n", scoreboard->demo_mode ? "on" : "off");
+                        print_terminal(scoreboard, output_buffer);
+                    } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+                        sprintf(output_buffer, "OK\t%s\n", scoreboard->demo_mode ? "on" : "off");
+                        print_pc_console(scoreboard, output_buffer);
+                    } else {
+                        sprintf(output_buffer, "{'demo_mode': '%s', 'status': 1}\r\n",
+                                scoreboard->demo_mode ? "on" : "off");
+                        print_scoreboard(scoreboard, output_buffer);
+                    }
+                    break;
+                case KEYWORD_RESET:
+                    for (int i = 0; i < scoreboard->num_consoles; i++) {
+                        scoreboard->scores[i].score1 = 0;
+                        scoreboard->scores[i].score2 = 0;
+                        scoreboard->scores[i].apples1 = 0;
+                        scoreboard->scores[i].apples2 = 0;
+                        scoreboard->scores[i].level = 1;
+                        scoreboard->scores[i].with_poison = 0;
+                        scoreboard->scores[i].playing_mode = 0;
+                        scoreboard->scores[i].game_status = 0;
+                    }
+                    if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+                        sprintf(output_buffer, "\r\nDemo mode reset\r\n");
+                        print_terminal(scoreboard, output_buffer);
+                    } else if (scoreboard->mode == PC_CONSOLE_MODE) {
+                        sprintf(output_buffer, "OK\tDemo mode reset\n");
+                        print_pc_console(scoreboard, output_buffer);
+                    } else {
+                        sprintf(output_buffer, "{'demo_mode': 'reset', 'status': 1}\r\n");
+                        print_scoreboard(scoreboard, output_buffer);
+                    }
+                    break;
             }
             break;
         case CMD_STATS:
-            if (scoreboard->mode == TERMINAL_CONSOLE_MODE) {
+            if (scoreboard->mode == BINARY_MODE) {
+                binary_pager_t pager;
+
+                pager_begin(&pager, scoreboard, BINARY_RECORD_STATS, sizeof(binary_page_t), sizeof(binary_stats_t),
+                        count_connected(scoreboard));
                 for (int i = 0; i < scoreboard->num_consoles; i++) {
                     if (scoreboard->scores[i].is_connected) {
-                        sprintf(output_buffer, "\r\nStats for %s console:\r\n",
-                                snake_names[scoreboard->scores[i].console_id]);
-                        print_terminal(scoreboard, output_buffer);
-                        sprintf(output_buffer,
-                                "Apples\r\n=======================\r\nEasy: %d, Medium: %d\r\nHard: %d, Insane: %d\r\n",
-                                scoreboard->stats[i].num_apples_easy, scoreboard->stats[i].num_apples_medium,
-                                scoreboard->stats[i].num_apples_hard, scoreboard->stats[i].num_apples_insane);
-                        print_terminal(scoreboard, output_buffer);
-                        sprintf(output_buffer,
-                                "High Scores\r\n=======================\r\nEasy: %d (%s), Medium: %d (%s)\r\nHard: %d (%s), Insane: %d (%s)\r\n",
-                                scoreboard->stats[i].high_score_easy, scoreboard->stats[i].initials_easy,
-                                scoreboard->stats[i].high_score_medium, scoreboard->stats[i].initials_medium,
-                                scoreboard->stats[i].high_score_hard, scoreboard->stats[i].initials_hard,
-                                scoreboard->stats[i].high_score_insane, scoreboard->stats[i].initials_insane);
-                        print_terminal(scoreboard, output_buffer);
+                        binary_pack_stats(scoreboard->scores[i].console_id, &scoreboard->stats[i], pager_entry(&pager));
                     }
                 }
-            } else if (scoreboard->mode == PC_CONSOLE_MODE) {
-                num_console = 0;
-                for (int i = 0; i < scoreboard->num_consoles; i++) {
-                    if (scoreboard->scores[i].is_connected)
-                        num_console++;
-                }
-                sprintf(output_buffer, "OK\t%d\n", num_console);
-                print_pc_console(scoreboard, output_buffer);
+                pager_end(&pager);
+            } else {
+                write_stats(scoreboard);
+            }
+            break;
+        case CMD_RATES:
+            if (scoreboard->mode == BINARY_MODE) {
+                poll_rate_t rate;
+                binary_rate_t *entry;
+                binary_pager_t pager;
+
+                pager_begin(&pager, scoreboard, BINARY_RECORD_RATES, sizeof(binary_page_t), sizeof(binary_rate_t),
+                        count_connected(scoreboard));
                 for (int i = 0; i < scoreboard->num_consoles; i++) {
                     if (scoreboard->scores[i].is_connected) {
-                        sprintf(output_buffer, "CONSOLE %d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d",
-                                scoreboard->scores[i].console_id, scoreboard->stats[i].num_apples_easy,
-                                scoreboard->stats[i].num_apples_medium, scoreboard->stats[i].num_apples_hard,
-                                scoreboard->stats[i].num_apples_insane, scoreboard->stats[i].high_score_easy,
-                                scoreboard->stats[i].high_score_medium, scoreboard->stats[i].high_score_hard,
-                                scoreboard->stats[i].high_score_insane,
-                                scoreboard->stats[i].high_score_insane);
-                        print_pc_console(scoreboard, output_buffer);
-                        sprintf(output_buffer, "\t%s\t%s\t%s\t%s\n", scoreboard->stats[i].initials_easy,
-                                scoreboard->stats[i].initials_medium, scoreboard->stats[i].initials_hard,
-                                scoreboard->stats[i].initials_insane);
+                        scoreboard_lock();
+                        poll_scheduler_get_rate(i, &rate);
+                        scoreboard_unlock();
+                        entry = pager_entry(&pager);
+                        entry->console_id = scoreboard->scores[i].console_id;
+                        entry->interval_ms = rate.interval_ms;
+                        entry->window_polls = rate.window_polls;
+                        entry->num_polls = rate.num_polls;
                     }
                 }
+                pager_end(&pager);
             } else {
-                uint8_t first = 1;
-                uint8_t has_stats = 0;
-                for (int i = 0; i < scoreboard->num_consoles; i++) {
-                    if (!scoreboard->scores[i].is_connected) {
-                        continue;
-                    }
-                    has_stats = 1;
-                    if (first) {
-                        print_scoreboard(scoreboard, "{\"stats\":[");
-                        first = 0;
-                    } else {
-                        print_scoreboard(scoreboard, ",");
-                    }
+                write_rates(scoreboard);
+            }
+            break;
+        case CMD_HEALTH:
+            if (scoreboard->mode == BINARY_MODE) {
+                i2c_engine_stats_t totals;
+                i2c_start_sync_t sync;
+                console_health_t health;
+                binary_health_header_t *header = (binary_health_header_t*) record;
+                binary_health_t *entry;
+                binary_pager_t pager;
 
-                    sprintf(output_buffer,
-                            "{\"console_id\":%d, \"num_apples_easy\":%d, \"num_apples_medium\": %d, \"num_apples_hard\": %d, \"num_apples_insane\": %d, ",
-                            scoreboard->scores[i].console_id, scoreboard->stats[i].num_apples_easy,
-                            scoreboard->stats[i].num_apples_medium, scoreboard->stats[i].num_apples_hard,
-                            scoreboard->stats[i].num_apples_insane);
-                    print_scoreboard(scoreboard, output_buffer);
-                    sprintf(output_buffer,
-                            "\"high_score_easy\": %d, \"high_score_medium\": %d, \"high_score_hard\": %d, \"high_score_insane\": %d, ",
-                            scoreboard->stats[i].high_score_easy, scoreboard->stats[i].high_score_medium,
-                            scoreboard->stats[i].high_score_hard, scoreboard->stats[i].high_score_insane);
-                    print_scoreboard(scoreboard, output_buffer);
-                    sprintf(output_buffer,
-                            "\"initials_easy\": \"%s\", \"initials_medium\": \"%s\", \"initials_hard\": \"%s\", \"initials_insane\": \"%s\"}",
-                            scoreboard->stats[i].initials_easy, scoreboard->stats[i].initials_medium,
-                            scoreboard->stats[i].initials_hard, scoreboard->stats[i].initials_insane);
-                    print_scoreboard(scoreboard, output_buffer);
-                }
-                if (has_stats) {
-                    print_scoreboard(scoreboard, "]}\r\n");
-                } else {
-                    print_scoreboard(scoreboard, "{'stats': 'none', 'status': 1}\r\n");
+                i2c_engine_get_stats(&totals);
+                header->num_reads = totals.num_reads;
+                header->num_writes = totals.num_writes;
+                header->num_errors = totals.num_errors;
+                header->num_timeouts = totals.num_timeouts;
+                header->num_dropped = totals.num_dropped;
+                i2c_engine_get_start_sync(&sync);
+                header->num_started = sync.num_started;
+                header->num_late = sync.num_late;
+                header->skew_us = sync.skew_us;
+                header->lead_us = sync.lead_us;
+                pager_begin(&pager, scoreboard, BINARY_RECORD_HEALTH, sizeof(binary_health_header_t),
+                        sizeof(binary_health_t), scoreboard->num_consoles);
+                for (int i = 0; i < scoreboard->num_consoles; i++) {
+                    scoreboard_lock();
+                    console_health_get(i, &health);
+                    scoreboard_unlock();
+                    entry = pager_entry(&pager);
+                    entry->console = i + 1;
+                    entry->state = health.state;
+                    entry->latency_us = health.latency_us;
+                    entry->latency_var_us = health.latency_var_us;
+                    entry->budget_us = health.budget_us;
+                    entry->consecutive_failures = health.consecutive_failures;
+                    entry->num_failures = health.num_failures;
+                    entry->num_trips = health.num_trips;
+                    entry->backoff_ms = health.backoff_ms;
+                    entry->num_torn = health.num_torn;
                 }
+                pager_end(&pager);
+            } else {
+                write_health(scoreboard);
+            }
+            break;
+        case CMD_SYSINFO:
+            if (scoreboard->mode != BINARY_MODE) {  // Text modes only, binary hosts get the status record
+                write_sysinfo(scoreboard);
             }
             break;
         default:
@@ -602,7 +952,7 @@ cmd_status_t execute_command(scoreboard_t *scoreboard, command_t command, uint8_
                 sprintf(output_buffer, "{'error': 'Unknown command', 'status': 0}\r\n");
                 print_scoreboard(scoreboard, output_buffer);
             }
-            return INVALID_COMMAND;
+            return CMD_INVALID;
             break;
     }
     return CMD_OK;
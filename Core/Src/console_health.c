@@ -0,0 +1,181 @@
+/*
+ * console_health.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include "console_health.h"
+#include "ram_budget.h"
+
+static console_health_t health[MAX_NUM_CONSOLES];
+
+const uint32_t console_health_ram_bytes = sizeof(health);
+static const char *const state_names[NUM_BREAKER_STATES] = { "closed", "open", "half-open" };
+
+// Signed difference so the comparison survives HAL_GetTick() wrapping
+static inline bool time_reached(uint32_t now, uint32_t deadline) {
+    return (int32_t) (now - deadline) >= 0;
+}
+
+void console_health_init(void) {
+    for (uint8_t i = 0; i < MAX_NUM_CONSOLES; i++) {
+        console_health_reset(i);
+        health[i].num_failures = 0;
+        health[i].num_trips = 0;
+        health[i].num_torn = 0;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: console_health_reset
+ *
+ * Forget the latency samples and close the breaker, e.g. when a different
+ * console may have been plugged into the slot. Counters are kept.
+ *
+ * Parameters: uint8_t console - console slot
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void console_health_reset(uint8_t console) {
+    console_health_t *h = &health[console];
+
+    h->state = BREAKER_CLOSED;
+    h->latency_us = 0;
+    h->latency_var_us = 0;
+    h->budget_us = HEALTH_LATENCY_MAX_US;
+    h->consecutive_failures = 0;
+    h->consecutive_reads = 0;
+    h->backoff_ms = 0;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: console_health_read_ok
+ *
+ * Account a successful read and update the smoothed latency:
+ *   latency += (sample - latency) / 8
+ *   latency_var += (|sample - latency| - latency_var) / 4
+ *   budget = latency + 4 * latency_var, within [HEALTH_LATENCY_MIN_US, HEALTH_LATENCY_MAX_US]
+ *
+ * Parameters: uint8_t console - console slot
+ *             uint16_t latency_us - time the read took beyond its wire time
+ * Return: uint16_t - latency budget for the console's next jobs
+ *---------------------------------------------------------------------------*/
+uint16_t console_health_read_ok(uint8_t console, uint16_t latency_us) {
+    console_health_t *h = &health[console];
+    int32_t error;
+    uint32_t budget;
+
+    if (h->latency_us == 0 && h->latency_var_us == 0) {  // First sample
+        h->latency_us = latency_us;
+        h->latency_var_us = latency_us / 2;
+    } else {
+        error = (int32_t) latency_us - h->latency_us;
+        h->latency_us += error / 8;
+        h->latency_var_us += ((error < 0 ? -error : error) - (int32_t) h->latency_var_us) / 4;
+    }
+    budget = h->latency_us + 4UL * h->latency_var_us;
+    if (budget < HEALTH_LATENCY_MIN_US) {
+        budget = HEALTH_LATENCY_MIN_US;
+    } else if (budget > HEALTH_LATENCY_MAX_US) {
+        budget = HEALTH_LATENCY_MAX_US;
+    }
+    h->budget_us = budget;
+
+    h->consecutive_failures = 0;
+    if (h->consecutive_reads < HEALTH_STABLE_READS) {
+        h->consecutive_reads++;
+    } else {
+        h->backoff_ms = 0;
+    }
+    return h->budget_us;
+}
+
+static void open_breaker(console_health_t *h, uint32_t now) {
+    if (h->backoff_ms == 0) {
+        h->backoff_ms = HEALTH_BACKOFF_MIN_MS;
+    } else if (h->backoff_ms < HEALTH_BACKOFF_MAX_MS / 2) {
+        h->backoff_ms *= 2;
+    } else {
+        h->backoff_ms = HEALTH_BACKOFF_MAX_MS;
+    }
+    h->state = BREAKER_OPEN;
+    h->next_probe = now + h->backoff_ms;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: console_health_read_failed
+ *
+ * Account a failed or timed out read. After HEALTH_BREAKER_THRESHOLD failures
+ * in a row the breaker opens.
+ *
+ * Parameters: uint8_t console - console slot
+ *             uint32_t now - HAL_GetTick()
+ * Return: bool - true if the breaker is open and the console must be taken out
+ *---------------------------------------------------------------------------*/
+bool console_health_read_failed(uint8_t console, uint32_t now) {
+    console_health_t *h = &health[console];
+
+    h->num_failures++;
+    h->consecutive_reads = 0;
+    if (++h->consecutive_failures >= HEALTH_BREAKER_THRESHOLD && h->state == BREAKER_CLOSED) {
+        h->num_trips++;
+        open_breaker(h, now);
+    }
+    return h->state != BREAKER_CLOSED;
+}
+
+void console_health_read_torn(uint8_t console) {
+    health[console].num_torn++;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: console_health_probe_due
+ *
+ * Check whether an open breaker's probe interval has passed. If so the
+ * breaker goes half-open and the caller must probe the console and report
+ * the outcome with console_health_probe_done.
+ *
+ * Parameters: uint8_t console - console slot
+ *             uint32_t now - HAL_GetTick()
+ * Return: bool - true if the console is to be probed now
+ *---------------------------------------------------------------------------*/
+bool console_health_probe_due(uint8_t console, uint32_t now) {
+    console_health_t *h = &health[console];
+
+    if (h->state != BREAKER_OPEN || !time_reached(now, h->next_probe)) {
+        return false;
+    }
+    h->state = BREAKER_HALF_OPEN;
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: console_health_probe_done
+ *
+ * Close the breaker after a successful probe, or open it again with twice the
+ * interval. Also used for consoles that did not answer at start-up, which
+ * start out with an open breaker.
+ *
+ * Parameters: uint8_t console - console slot
+ *             bool ok - true if the console answered
+ *             uint32_t now - HAL_GetTick()
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void console_health_probe_done(uint8_t console, bool ok, uint32_t now) {
+    console_health_t *h = &health[console];
+
+    if (ok) {
+        h->state = BREAKER_CLOSED;
+        h->consecutive_failures = 0;
+    } else {
+        open_breaker(h, now);
+    }
+}
+
+void console_health_get(uint8_t console, console_health_t *h) {
+    *h = health[console];
+}
+
+const char* console_health_state_name(uint8_t state) {
+    return state < NUM_BREAKER_STATES ? state_names[state] : "";
+}
@@ -0,0 +1,666 @@
+/*
+ * console_poller.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include <string.h>
+
+#include "console_poller.h"
+#include "i2c_master.h"
+#include "i2c_engine.h"
+#include "i2c_recovery.h"
+#include "led_indicator.h"
+#include "poll_scheduler.h"
+#include "link_monitor.h"
+#include "console_topology.h"
+#include "console_health.h"
+#include "telemetry.h"
+#include "sysinfo.h"
+#include "ram_budget.h"
+
+extern scoreboard_t scoreboard;
+extern led_indicator_t console_indicator[];
+extern uint8_t link_status[NUM_CONSOLE_PORTS];
+
+static i2c_scoreboard_t i2c_scoreboard[MAX_NUM_CONSOLES];
+static uint8_t console_registers[MAX_NUM_CONSOLES][REGISTERS_SIZE];  // Last register image read per console
+static device_list_t consoles[MAX_NUM_CONSOLES];
+
+static osThreadId_t consolePollerHandle = NULL;
+static osMessageQueueId_t request_queue = NULL;
+
+static StaticTask_t consolePoller_control_block;
+static uint32_t consolePoller_stack[POLLER_TASK_STACK_WORDS];
+static StaticQueue_t request_queue_control_block;
+static console_request_t request_queue_storage[CONSOLE_REQUEST_QUEUE_SIZE];
+
+static const osThreadAttr_t consolePoller_attributes = { .name = "consolePoller", .cb_mem = &consolePoller_control_block,
+        .cb_size = sizeof(consolePoller_control_block), .stack_mem = consolePoller_stack, .stack_size =
+                sizeof(consolePoller_stack), .priority = (osPriority_t) osPriorityAboveNormal, };
+static const osMessageQueueAttr_t request_queue_attributes = { .name = "consoleRequests", .cb_mem =
+        &request_queue_control_block, .cb_size = sizeof(request_queue_control_block), .mq_mem = request_queue_storage,
+        .mq_size = sizeof(request_queue_storage) };
+
+// Poller task state
+static uint8_t game_ended[MAX_NUM_CONSOLES] = { 0 };
+static console_mask_t reads_pending = 0;  // Bit per console with a poll read queued or on the wire
+static console_mask_t cold_pending = 0;   // Bit per console with a cold block read queued or on the wire
+static console_mask_t stats_valid = 0;    // Bit per console whose stats match stats_generation below
+static uint16_t stats_generation[MAX_NUM_CONSOLES] = { 0 };  // Generation of the stats last read
+static uint16_t cold_generation[MAX_NUM_CONSOLES] = { 0 };   // Generation seen when the cold read was queued
+static console_mask_t probe_pending = 0;  // Bit per console to re-probe
+static uint8_t bus_suspect = 0;           // Bit per bus on which a read failed, check it before probing
+static console_mask_t link_connected = 0;
+static uint8_t results_changed = 0;       // Console data updated since the telemetry task was told
+static uint32_t next_housekeeping;        // HAL_GetTick() of the next housekeeping pass
+static uint32_t num_rejected = 0;         // Requests refused because the queue was full
+
+const uint32_t console_poller_ram_bytes = sizeof(i2c_scoreboard) + sizeof(console_registers) + sizeof(consoles)
+        + sizeof(consolePoller_control_block) + sizeof(consolePoller_stack) + sizeof(request_queue_control_block)
+        + sizeof(request_queue_storage) + sizeof(game_ended) + sizeof(stats_generation) + sizeof(cold_generation);
+
+static void StartConsolePoller(void *argument);
+
+// Signed difference so the comparison survives HAL_GetTick() wrapping
+static inline bool time_reached(uint32_t now, uint32_t deadline) {
+    return (int32_t) (now - deadline) >= 0;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: console_poller_init
+ *
+ * Create the request queue and the poller task. The task scans the buses
+ * itself, so this returns straight away.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void console_poller_init(void) {
+    request_queue = osMessageQueueNew(CONSOLE_REQUEST_QUEUE_SIZE, sizeof(console_request_t),
+            &request_queue_attributes);
+    consolePollerHandle = osThreadNew(StartConsolePoller, NULL, &consolePoller_attributes);
+
+    if (request_queue == NULL || consolePollerHandle == NULL) {
+        Error_Handler();
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: console_poller_request
+ *
+ * Hand a command for the consoles to the poller task. Does not wait.
+ *
+ * Parameters: const console_request_t *request - command to send
+ * Return: bool - false if the request queue is full
+ *---------------------------------------------------------------------------*/
+bool console_poller_request(const console_request_t *request) {
+    if (osMessageQueuePut(request_queue, request, 0, 0) != osOK) {
+        num_rejected++;
+        return false;
+    }
+    osThreadFlagsSet(consolePollerHandle, POLLER_FLAG_REQUEST);
+    return true;
+}
+
+uint32_t console_poller_num_rejected(void) {
+    return num_rejected;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: demo_mode_init
+ *
+ * This function will initialize the scoreboard in demo mode. It will set the
+ * scores for each console to a random value.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void demo_mode_init(void) {
+    if (!scoreboard.is_demo_mode_initialized && scoreboard.demo_mode) {
+        scoreboard.is_demo_mode_initialized = 1;
+        for (int i = 0; i < MAX_NUM_CONSOLES; i++) {
+            memset(&scoreboard.scores[i], 0, sizeof(score_t));
+            memset(&scoreboard.stats[i], 0, sizeof(stats_t));
+            scoreboard.scores[i].console_id = i + 1;
+            scoreboard.scores[i].is_connected = 1;
+            scoreboard.scores[i].game_status = 1;
+            scoreboard.scores[i].playing_mode = rng_get(2) ? 1 : 0;
+            scoreboard.scores[i].score1 = rng_get(100);
+            scoreboard.scores[i].apples1 = rng_get(10);
+            if (scoreboard.scores[i].playing_mode) {
+                scoreboard.scores[i].grid_size = 1;
+                scoreboard.scores[i].score2 = rng_get(100);
+                scoreboard.scores[i].apples2 = rng_get(10);
+            } else {
+                scoreboard.scores[i].grid_size = 0;
+            }
+            scoreboard.scores[i].playing_time = rng_get(240);
+            scoreboard.scores[i].game_difficulty = rng_get(3);
+            scoreboard.scores[i].cause_of_death = 0;
+            scoreboard.scores[i].level = rng_get(3);
+            scoreboard.scores[i].game_speed = 50 - scoreboard.scores[i].level * 5;
+            scoreboard.scores[i].with_poison = rng_get(2) ? 1 : 0;
+            scoreboard.stats[i].num_apples_easy = rng_get(100);
+            scoreboard.stats[i].num_apples_medium = rng_get(100);
+            scoreboard.stats[i].num_apples_hard = rng_get(100);
+            scoreboard.stats[i].num_apples_insane = rng_get(100);
+            scoreboard.stats[i].high_score_easy = rng_get(100);
+            scoreboard.stats[i].high_score_medium = rng_get(100);
+            scoreboard.stats[i].high_score_hard = rng_get(100);
+            scoreboard.stats[i].high_score_insane = rng_get(100);
+            scoreboard.stats[i].initials_easy[0] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_easy[1] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_easy[2] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_medium[0] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_medium[1] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_medium[2] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_hard[0] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_hard[1] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_hard[2] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_insane[0] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_insane[1] = 'A' + rng_get(26);
+            scoreboard.stats[i].initials_insane[2] = 'A' + rng_get(26);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: update_console
+ *
+ * Decode the registers [first, end) of a console's register image and copy the hot block into
+ * the scoreboard scores. The stats are copied separately by update_stats once the cold block has
+ * been read.
+ *
+ * Parameters: uint8_t j - console slot
+ *             const device_list_t *console - device list entry of the console
+ *             uint8_t registers[] - register image of the console
+ *             uint8_t first - first register that was read
+ *             uint8_t end - one past the last register that was read
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void update_console(uint8_t j, const device_list_t *console, uint8_t registers[], uint8_t first,
+        uint8_t end) {
+    register_decode_range(registers, &i2c_scoreboard[j], first, end);
+    scoreboard.scores[j].console_id = console->device_id;
+    scoreboard.scores[j].grid_size = (i2c_scoreboard[j].current_game_state3 & GAME_GRID_SIZE)
+            >> GAME_GRID_SIZE_SHIFT;
+    scoreboard.scores[j].game_status = i2c_scoreboard[j].current_game_state & GAME_STATUS;
+    scoreboard.scores[j].game_difficulty = (i2c_scoreboard[j].console_info & GAME_LEVEL_MODE)
+            >> GAME_LEVEL_MODE_SHIFT;
+    scoreboard.scores[j].cause_of_death = (i2c_scoreboard[j].current_game_state3 & GAME_CAUSE_OF_DEATH)
+            >> GAME_CAUSE_OF_DEATH_SHIFT;
+    scoreboard.scores[j].game_speed = (i2c_scoreboard[j].current_game_state2 & GAME_SPEED) >> GAME_SPEED_SHIFT;
+    scoreboard.scores[j].is_connected = 1;
+    scoreboard.scores[j].score1 = i2c_scoreboard[j].current_score1;
+    scoreboard.scores[j].score2 = i2c_scoreboard[j].current_score2;
+    scoreboard.scores[j].apples1 = i2c_scoreboard[j].number_apples1;
+    scoreboard.scores[j].apples2 = i2c_scoreboard[j].number_apples2;
+    scoreboard.scores[j].playing_time = i2c_scoreboard[j].playing_time;
+    scoreboard.scores[j].level = (i2c_scoreboard[j].current_game_state & GAME_PLAYING_LEVEL)
+            >> GAME_PLAYING_LEVEL_SHIFT;
+    scoreboard.scores[j].playing_mode = i2c_scoreboard[j].current_game_state2 & GAME_NUM_PLAYERS;
+    scoreboard.scores[j].with_poison = (i2c_scoreboard[j].current_game_state2 & GAME_POISON_FLAG)
+            >> GAME_POISON_SHIFT;
+}
+
+static void update_stats(uint8_t j) {
+    scoreboard.stats[j].num_apples_easy = i2c_scoreboard[j].num_apples_easy;
+    scoreboard.stats[j].num_apples_medium = i2c_scoreboard[j].num_apples_medium;
+    scoreboard.stats[j].num_apples_hard = i2c_scoreboard[j].num_apples_hard;
+    scoreboard.stats[j].num_apples_insane = i2c_scoreboard[j].num_apples_insane;
+    scoreboard.stats[j].high_score_easy = i2c_scoreboard[j].high_score_easy;
+    scoreboard.stats[j].high_score_medium = i2c_scoreboard[j].high_score_medium;
+    scoreboard.stats[j].high_score_hard = i2c_scoreboard[j].high_score_hard;
+    scoreboard.stats[j].high_score_insane = i2c_scoreboard[j].high_score_insane;
+    strncpy(scoreboard.stats[j].initials_easy, i2c_scoreboard[j].initials_easy, 3);
+    strncpy(scoreboard.stats[j].initials_medium, i2c_scoreboard[j].initials_medium, 3);
+    strncpy(scoreboard.stats[j].initials_hard, i2c_scoreboard[j].initials_hard, 3);
+    strncpy(scoreboard.stats[j].initials_insane, i2c_scoreboard[j].initials_insane, 3);
+}
+
+static void clear_console(uint8_t j, const device_list_t *console) {
+    scoreboard.scores[j].console_id = console->device_id;
+    scoreboard.scores[j].is_connected = 0;
+    scoreboard.scores[j].score1 = 0;
+    scoreboard.scores[j].score2 = 0;
+    scoreboard.scores[j].apples1 = 0;
+    scoreboard.scores[j].apples2 = 0;
+    scoreboard.scores[j].level = 0;
+    scoreboard.scores[j].with_poison = 0;
+    scoreboard.scores[j].playing_mode = 0;
+    scoreboard.scores[j].game_status = 0;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: initial_scan
+ *
+ * Find the connected consoles and read their whole register image once,
+ * before the I2C engine takes over the buses.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void initial_scan(void) {
+    // Poll I2C slaves to get a list of connected devices
+    initialize_device_list(consoles);
+    i2c_master_scan(consoles);
+
+    // Fetch initial scoreboard data
+    for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
+        if (consoles[j].is_active) {
+            if (j < NUM_CONSOLE_PORTS) {
+                led_indicator_set_blink(&console_indicator[j], 400, 6);
+            }
+            if (fetch_scoreboard_data(consoles, j, console_registers[j]) != HAL_OK) {
+                consoles[j].is_active = 0;
+            }
+        }
+        scoreboard_lock();
+        if (consoles[j].is_active) {
+            memset(&scoreboard.scores[j], 0, sizeof(score_t));
+            memset(&scoreboard.stats[j], 0, sizeof(stats_t));
+            update_console(j, &consoles[j], console_registers[j], 0, REGISTERS_SIZE);
+            update_stats(j);
+            stats_generation[j] = i2c_scoreboard[j].stats_generation;
+            stats_valid |= 1UL << j;
+        } else {
+            clear_console(j, &consoles[j]);
+            scoreboard.scores[j].playing_time = 0;
+        }
+        scoreboard_unlock();
+    }
+    console_health_init();
+    // Consoles past the front panel ports have no link pin and count as always linked: they are
+    // found by the probes their breaker schedules
+    for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
+        if (j < NUM_CONSOLE_PORTS ? link_status[j] : j < topology_num_slots()) {
+            link_connected |= 1UL << j;
+        }
+        if (!consoles[j].is_active) {
+            console_health_probe_done(j, false, HAL_GetTick());  // Probed again once its breaker allows
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: check_links
+ *
+ * Re-probe only the consoles whose link settled in a new state, or whose
+ * breaker is due for a probe (see console_health.h). Polling of the other
+ * consoles carries on.
+ *
+ * Parameters: uint32_t now - HAL_GetTick()
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void check_links(uint32_t now) {
+    console_mask_t link_changed = link_monitor_poll(now, &link_connected);
+
+    for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
+        if (link_changed & ~link_connected & (1UL << j)) {
+            // Unplugged, nothing to ask the bus
+            consoles[j].is_active = 0;
+            scoreboard_lock();
+            clear_console(j, &consoles[j]);
+            scoreboard_unlock();
+            results_changed = 1;
+        } else if (link_changed & (1UL << j)) {
+            // Plugged in, possibly a different console: start over
+            console_health_reset(j);
+            i2c_engine_set_latency_budget(j, HEALTH_LATENCY_MAX_US);
+            probe_pending |= 1UL << j;
+        } else if ((link_connected & (1UL << j)) && console_health_probe_due(j, now)) {
+            probe_pending |= 1UL << j;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: probe_consoles
+ *
+ * Recover the buses a read failed on and probe the consoles queued by
+ * check_links. The I2C engine is suspended meanwhile; commands queued for it
+ * wait, the command task does not.
+ *
+ * Parameters: uint32_t now - HAL_GetTick()
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void probe_consoles(uint32_t now) {
+    uint8_t probe_ok;
+
+    if (!(probe_pending || bus_suspect) || scoreboard.demo_mode) {
+        return;
+    }
+    i2c_engine_suspend();
+    for (uint8_t b = 0; b < NUM_I2C_BUSES; b++) {
+        if ((bus_suspect & (1 << b)) && i2c_bus_is_stuck(b)) {
+            i2c_bus_recover(b);
+        }
+    }
+    for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
+        if (probe_pending & (1UL << j)) {
+            probe_ok = i2c_master_probe(consoles, j) == HAL_OK;
+            console_health_probe_done(j, probe_ok, now);
+            if (probe_ok) {
+                stats_valid &= ~(1UL << j);  // May be a different console, read its stats again
+                if (j < NUM_CONSOLE_PORTS) {
+                    led_indicator_set_blink(&console_indicator[j], 400, 6);
+                }
+            }
+        }
+    }
+    probe_pending = 0;
+    bus_suspect = 0;
+    i2c_engine_resume();
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: run_requests
+ *
+ * Put the queued console commands on the wire (ahead of any polling) and
+ * poll the consoles quickly for a while to pick up their effect.
+ *
+ * Parameters: uint32_t now - HAL_GetTick()
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void run_requests(uint32_t now) {
+    console_request_t request;
+
+    while (osMessageQueueGet(request_queue, &request, NULL, 0) == osOK) {
+        if (request.type == CONSOLE_REQUEST_START) {
+            scoreboard_lock();
+            scoreboard.is_tournament_mode = 1;
+            memset(game_ended, 0, sizeof(game_ended));
+            scoreboard_unlock();
+            i2c_engine_send_start(consoles, request.command, request.seed);
+        } else {
+            i2c_engine_send_command(consoles, request.command, request.seed);
+        }
+        for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
+            if (consoles[j].is_active) {
+                poll_scheduler_boost(j, now);
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: collect_results
+ *
+ * Collect console reads completed by the I2C engine and queue the consoles
+ * that are due. Polls read the hot block only; the cold block (stats) is
+ * read when its generation changed.
+ *
+ * Parameters: uint32_t now - HAL_GetTick()
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void collect_results(uint32_t now) {
+    i2c_read_result_t read;
+    uint8_t torn;
+    uint8_t decode_first;
+    uint8_t decode_end;
+
+    scoreboard_lock();
+    for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
+        if (i2c_engine_get_result(j, console_registers[j], &read)) {
+            if (!consoles[j].is_active) {
+                // Console taken out while the read was queued
+                reads_pending &= ~(1UL << j);
+                cold_pending &= ~(1UL << j);
+            } else if (read.status == HAL_OK) {
+                i2c_engine_set_latency_budget(j, console_health_read_ok(j, read.latency_us));
+
+                // A block the console updated while it was on the wire is left out and read
+                // again on its own right away; it stays pending until a clean copy arrives
+                torn = i2c_master_torn_blocks(console_registers[j], read.first, read.end);
+                decode_first = (torn & REG_BLOCK_HOT) ? REG_COLD_START : read.first;
+                decode_end = (torn & REG_BLOCK_COLD) ? REG_COLD_START : read.end;
+                if (torn & REG_BLOCK_HOT) {
+                    console_health_read_torn(j);
+                    if (!i2c_engine_read(I2C_PRIORITY_POLL, &consoles[j], j, REG_HOT_START, REG_HOT_SIZE)) {
+                        torn &= ~REG_BLOCK_HOT;  // Queue full, wait for the next poll
+                    }
+                }
+                if (torn & REG_BLOCK_COLD) {
+                    console_health_read_torn(j);
+                    if (!i2c_engine_read(I2C_PRIORITY_POLL, &consoles[j], j, REG_COLD_START, REG_COLD_SIZE)) {
+                        torn &= ~REG_BLOCK_COLD;
+                    }
+                }
+                if (decode_first < decode_end) {
+                    update_console(j, &consoles[j], console_registers[j], decode_first, decode_end);
+                }
+                if (read.first < REG_HOT_SIZE && !(torn & REG_BLOCK_HOT)) {
+                    reads_pending &= ~(1UL << j);
+                    poll_scheduler_completed(j, scoreboard.scores[j].game_status, now);
+                }
+                if (read.end > REG_COLD_START && !(torn & REG_BLOCK_COLD)) {
+                    cold_pending &= ~(1UL << j);
+                    if (decode_end > REG_COLD_START) {
+                        update_stats(j);
+                        stats_generation[j] = cold_generation[j];
+                        stats_valid |= 1UL << j;
+                    }
+                }
+            } else {
+                // Retried at the next poll; after repeated failures the breaker takes the
+                // console out of polling and commands until a probe succeeds
+                reads_pending &= ~(1UL << j);
+                cold_pending &= ~(1UL << j);
+                bus_suspect |= 1 << topology_slot(j)->bus;
+                if (console_health_read_failed(j, now)) {
+                    stats_valid &= ~(1UL << j);
+                    consoles[j].is_active = 0;
+                    clear_console(j, &consoles[j]);
+                }
+            }
+            results_changed = 1;
+        }
+        if (!consoles[j].is_active || scoreboard.demo_mode || scoreboard.is_demo_mode_initialized) {
+            continue;
+        }
+        if (!(cold_pending & (1UL << j))
+                && (!(stats_valid & (1UL << j)) || i2c_scoreboard[j].stats_generation != stats_generation[j])
+                && i2c_engine_read(I2C_PRIORITY_POLL, &consoles[j], j, REG_COLD_START, REG_COLD_SIZE)) {
+            cold_pending |= 1UL << j;
+            cold_generation[j] = i2c_scoreboard[j].stats_generation;
+        }
+        if (!(reads_pending & (1UL << j)) && poll_scheduler_is_due(j, now)
+                && i2c_engine_read(I2C_PRIORITY_POLL, &consoles[j], j, REG_HOT_START, REG_HOT_SIZE)) {
+            reads_pending |= 1UL << j;
+            poll_scheduler_started(j, now);
+        }
+    }
+    scoreboard_unlock();
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: demo_step
+ *
+ * Advance the simulated games of demo mode by one housekeeping interval.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void demo_step(void) {
+    for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
+        consoles[j].is_active = 1;
+        if (scoreboard.scores[j].game_status == 1) {
+            if (scoreboard.scores[j].score1 > 150 && rng_get(50) >= 35) {
+                scoreboard.scores[j].game_status = 3;
+                scoreboard.scores[j].cause_of_death = 1 + rng_get(4);
+            }
+            if (rng_get(20) >= 7) {
+                scoreboard.scores[j].score1 += rng_get(10) + 1;
+                scoreboard.scores[j].apples1 += rng_get(2) + 1;
+                if (scoreboard.scores[j].playing_mode) {
+                    scoreboard.scores[j].score2 += rng_get(10) + 1;
+                    scoreboard.scores[j].apples2 += rng_get(2) + 1;
+                }
+            }
+            scoreboard.scores[j].playing_time++;
+        } else if (scoreboard.scores[j].game_status == 3) {
+            if (rng_get(100) >= 87) {
+                scoreboard.scores[j].game_status = 1;
+                scoreboard.scores[j].playing_mode = rng_get(2) ? 1 : 0;
+                scoreboard.scores[j].score1 = rng_get(100);
+                scoreboard.scores[j].apples1 = rng_get(10);
+                scoreboard.scores[j].score2 = 0;
+                scoreboard.scores[j].apples2 = 0;
+                if (scoreboard.scores[j].playing_mode) {
+                    scoreboard.scores[j].grid_size = 1;
+                    scoreboard.scores[j].score2 = rng_get(100);
+                    scoreboard.scores[j].apples2 = rng_get(10);
+                } else {
+                    scoreboard.scores[j].grid_size = 0;
+                }
+                scoreboard.scores[j].playing_time = rng_get(120);
+                scoreboard.scores[j].game_difficulty = rng_get(3);
+                scoreboard.scores[j].cause_of_death = 0;
+                scoreboard.scores[j].level = rng_get(3);
+                scoreboard.scores[j].game_speed = 50 - scoreboard.scores[j].level * 5;
+                scoreboard.scores[j].with_poison = rng_get(2) ? 1 : 0;
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: housekeeping
+ *
+ * Once every POLLER_HOUSEKEEPING_MS: run demo mode, blink the LEDs of the
+ * linked ports and end the tournament once every console's game is over.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void housekeeping(void) {
+    uint8_t tournament_ended = 0;
+
+    scoreboard_lock();
+    if (scoreboard.demo_mode) {
+        if (!scoreboard.is_demo_mode_initialized) {
+            demo_mode_init();
+        }
+        demo_step();
+    } else if (!scoreboard.demo_mode && scoreboard.is_demo_mode_initialized) {
+        scoreboard.is_demo_mode_initialized = 0;
+        memset(scoreboard.scores, 0, sizeof(scoreboard.scores));
+        memset(scoreboard.stats, 0, sizeof(scoreboard.stats));
+    } else {
+        // Consoles are read by the poll scheduler, each at its own rate
+        for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
+            if (j < NUM_CONSOLE_PORTS && link_status[j]) {
+                led_indicator_set_blink(&console_indicator[j], 400, 6);
+            }
+            if (!consoles[j].is_active) {
+                clear_console(j, &consoles[j]);
+            }
+        }
+    }
+
+    // If the tournament mode is enabled, check if the tournament is over
+    if (scoreboard.is_tournament_mode) {
+        for (int k = 0; k < MAX_NUM_CONSOLES; k++) {
+            if (consoles[k].is_active) {
+                if (scoreboard.scores[k].game_status == 3) { // game ended
+                    game_ended[k] = 1;
+                }
+            } else {
+                game_ended[k] = 1; // If less than MAX_NUM_CONSOLES are connected, inactive slot is considered game ended
+            }
+        }
+
+        tournament_ended = 1;
+        for (int k = 0; k < MAX_NUM_CONSOLES; k++) {
+            if (game_ended[k] == 0) { // At least one console is still playing, so tournament is not over
+                tournament_ended = 0;
+            }
+        }
+        if (tournament_ended) {
+            scoreboard.is_tournament_mode = 0;
+        }
+    }
+    scoreboard_unlock();
+
+    if (tournament_ended) {
+        // Send tournament end command to all consoles
+        i2c_engine_send_command(consoles, I2C_CMD_TOURNAMENT_END, 0);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: next_wait
+ *
+ * Time the poller can sleep before something is due: a console poll, a
+ * link pin settling, housekeeping, or an I2C engine timeout. Read results,
+ * link edges and requests wake it earlier through its thread flags.
+ *
+ * Parameters: uint32_t now - HAL_GetTick()
+ * Return: uint32_t - ticks to wait
+ *---------------------------------------------------------------------------*/
+static uint32_t next_wait(uint32_t now) {
+    console_mask_t idle = 0;
+    uint32_t wait = POLLER_MAX_WAIT_MS;
+    uint32_t t;
+
+    if (!scoreboard.demo_mode && !scoreboard.is_demo_mode_initialized) {
+        for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
+            if (consoles[j].is_active && !(reads_pending & (1UL << j))) {
+                idle |= 1UL << j;
+            }
+        }
+        t = poll_scheduler_time_to_due(idle, now);
+        wait = t < wait ? t : wait;
+    }
+    t = link_monitor_time_to_settle(now);
+    wait = t < wait ? t : wait;
+    t = time_reached(now, next_housekeeping) ? 0 : next_housekeeping - now;
+    wait = t < wait ? t : wait;
+    if (!i2c_engine_is_idle() && wait > POLLER_SERVICE_MS) {
+        wait = POLLER_SERVICE_MS;
+    }
+    return wait;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: StartConsolePoller
+ *
+ * Poller task, see console_poller.h.
+ *
+ * Parameters: void *argument - unused
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void StartConsolePoller(void *argument) {
+    UNUSED(argument);
+
+    initial_scan();
+    link_monitor_set_notify(osThreadGetId(), POLLER_FLAG_LINK);
+    link_monitor_init(link_connected, HAL_GetTick());
+    i2c_engine_set_notify(osThreadGetId(), POLLER_FLAG_I2C);
+    i2c_engine_init();
+    poll_scheduler_init(HAL_GetTick());
+    next_housekeeping = HAL_GetTick() + POLLER_HOUSEKEEPING_MS;
+    telemetry_notify(TELEMETRY_EVENT_RESULTS);
+
+    for (;;) {
+        check_links(HAL_GetTick());
+        probe_consoles(HAL_GetTick());
+        i2c_engine_service();
+        run_requests(HAL_GetTick());
+        collect_results(HAL_GetTick());
+        if (time_reached(HAL_GetTick(), next_housekeeping)) {
+            next_housekeeping = HAL_GetTick() + POLLER_HOUSEKEEPING_MS;
+            housekeeping();
+            sysinfo_sample();
+            telemetry_notify(TELEMETRY_EVENT_TICK);
+            results_changed = 1;  // Demo changes and the keyframe interval are checked by the next publish
+        }
+        if (results_changed) {
+            results_changed = 0;
+            telemetry_notify(TELEMETRY_EVENT_RESULTS);
+        }
+        osThreadFlagsWait(POLLER_FLAGS, osFlagsWaitAny, next_wait(HAL_GetTick()));
+    }
+}
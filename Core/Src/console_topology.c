@@ -0,0 +1,156 @@
+/*
+ * console_topology.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include "console_topology.h"
+#include "ram_budget.h"
+
+#define MUX_UNKNOWN (0xFF)  // Channels of the multiplexer unknown, written before the next job
+
+#define I2C_BUS_EXTERN(bus, handle, rx_dma, ev_irq, er_irq, dma_irq, scl_port, scl_pin, sda_port, sda_pin) \
+    extern I2C_HandleTypeDef handle; \
+    extern DMA_HandleTypeDef rx_dma;
+#define I2C_BUS_CONFIG(bus, handle, rx_dma, ev_irq, er_irq, dma_irq, scl_port, scl_pin, sda_port, sda_pin) \
+    [bus] = { &handle, &rx_dma, ev_irq, er_irq, dma_irq, scl_port, scl_pin, sda_port, sda_pin },
+#define CONSOLE_SEGMENT(bus, mux_addr, mux_channel, first_addr, count) \
+    { bus, mux_addr, mux_channel, first_addr, count },
+
+I2C_BUSES(I2C_BUS_EXTERN)
+
+static const i2c_bus_config_t buses[NUM_I2C_BUSES] = { I2C_BUSES(I2C_BUS_CONFIG) };
+
+static const struct {
+    uint8_t bus;
+    uint8_t mux_addr;
+    uint8_t mux_channel;
+    uint8_t first_addr;
+    uint8_t count;
+} segments[] = { CONSOLE_SEGMENTS(CONSOLE_SEGMENT) };
+
+static console_slot_t slots[MAX_NUM_CONSOLES];
+static uint8_t num_slots = 0;
+static uint8_t bus_mux[NUM_I2C_BUSES];           // Multiplexer on each bus, TOPOLOGY_NO_MUX if none
+static volatile uint8_t mux_open[NUM_I2C_BUSES];  // Channel mask last written to it
+
+const uint32_t topology_ram_bytes = sizeof(slots) + sizeof(bus_mux) + sizeof(mux_open);
+
+/*-----------------------------------------------------------------------------
+ * Function: topology_init
+ *
+ * Lay the console segments out into the slot registry. A bus with two
+ * different multiplexers is a configuration error.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void topology_init(void) {
+    num_slots = 0;
+    for (uint8_t b = 0; b < NUM_I2C_BUSES; b++) {
+        bus_mux[b] = TOPOLOGY_NO_MUX;
+        mux_open[b] = MUX_UNKNOWN;
+    }
+    for (uint8_t s = 0; s < sizeof(segments) / sizeof(segments[0]); s++) {
+        if (segments[s].mux_addr != TOPOLOGY_NO_MUX) {
+            if (bus_mux[segments[s].bus] != TOPOLOGY_NO_MUX && bus_mux[segments[s].bus] != segments[s].mux_addr) {
+                Error_Handler();
+            }
+            bus_mux[segments[s].bus] = segments[s].mux_addr;
+        }
+        for (uint8_t i = 0; i < segments[s].count; i++) {
+            slots[num_slots].bus = segments[s].bus;
+            slots[num_slots].mux_addr = segments[s].mux_addr;
+            slots[num_slots].mux_channel = segments[s].mux_channel;
+            slots[num_slots].i2c_addr = segments[s].first_addr + i;
+            num_slots++;
+        }
+    }
+}
+
+uint8_t topology_num_slots(void) {
+    return num_slots;
+}
+
+const console_slot_t* topology_slot(uint8_t slot) {
+    return &slots[slot];
+}
+
+const i2c_bus_config_t* topology_bus(uint8_t bus) {
+    return &buses[bus];
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: topology_bus_of
+ *
+ * Find the bus of an I2C handle, e.g. in a HAL callback.
+ *
+ * Parameters: const I2C_HandleTypeDef *hi2c - I2C handle
+ * Return: uint8_t - i2c_bus_id_t, NUM_I2C_BUSES if the handle is not a console bus
+ *---------------------------------------------------------------------------*/
+uint8_t topology_bus_of(const I2C_HandleTypeDef *hi2c) {
+    uint8_t b = 0;
+
+    while (b < NUM_I2C_BUSES && buses[b].hi2c != hi2c) {
+        b++;
+    }
+    return b;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: topology_mux_step
+ *
+ * Check whether the multiplexer on a console's bus must be written before
+ * the console can be addressed: to open the console's channel, or to close
+ * all channels for a console on the bus itself, whose address a console
+ * behind an open channel could share. Report the outcome of the write with
+ * topology_mux_done.
+ *
+ * Parameters: uint8_t slot - console slot
+ *             uint8_t *mux_addr - set to the multiplexer to write
+ *             uint8_t *mask - set to the channel mask to write
+ * Return: bool - true if a multiplexer write is needed
+ *---------------------------------------------------------------------------*/
+bool topology_mux_step(uint8_t slot, uint8_t *mux_addr, uint8_t *mask) {
+    const console_slot_t *s = &slots[slot];
+    uint8_t target = s->mux_addr == TOPOLOGY_NO_MUX ? 0 : 1 << s->mux_channel;
+
+    if (bus_mux[s->bus] == TOPOLOGY_NO_MUX || mux_open[s->bus] == target) {
+        return false;
+    }
+    *mux_addr = bus_mux[s->bus];
+    *mask = target;
+    return true;
+}
+
+void topology_mux_done(uint8_t bus, uint8_t mask, bool ok) {
+    mux_open[bus] = ok ? mask : MUX_UNKNOWN;
+}
+
+// The multiplexer may have been reset along with the bus
+void topology_mux_forget(uint8_t bus) {
+    mux_open[bus] = MUX_UNKNOWN;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: topology_select
+ *
+ * Blocking counterpart of topology_mux_step for the HAL polling functions
+ * (probe, initial fetch). The I2C engine must be suspended.
+ *
+ * Parameters: uint8_t slot - console slot
+ * Return: HAL_StatusTypeDef - HAL_OK if the console can be addressed
+ *---------------------------------------------------------------------------*/
+HAL_StatusTypeDef topology_select(uint8_t slot) {
+    HAL_StatusTypeDef status;
+    uint8_t mux_addr;
+    uint8_t mask;
+
+    if (!topology_mux_step(slot, &mux_addr, &mask)) {
+        return HAL_OK;
+    }
+    status = HAL_I2C_Master_Transmit(buses[slots[slot].bus].hi2c, mux_addr << 1, &mask, 1, I2C_TIMEOUT);
+    topology_mux_done(slots[slot].bus, mask, status == HAL_OK);
+    return status;
+}
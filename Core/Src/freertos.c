@@ -24,6 +24,7 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "ram_budget.h"
 
 /* USER CODE END Includes */
 
@@ -34,7 +35,7 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+#define TIM5_COUNTS_PER_MS 10  // TIM5 runs at 10 kHz and keeps counting in sleep mode
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -44,7 +45,20 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
+extern TIM_HandleTypeDef htim4;  // HAL time base
+
+static uint32_t sleep_start;   // TIM5 count when the tickless sleep began
+static uint32_t sleep_residue; // TIM5 counts slept short of a whole HAL tick
 
+// Kernel memory, defined here rather than inside heap_4.c and cmsis_os2.c so it shows in the RAM map
+uint8_t ucHeap[configTOTAL_HEAP_SIZE];  // configAPPLICATION_ALLOCATED_HEAP
+static StaticTask_t idle_task_control_block;
+static StackType_t idle_task_stack[configMINIMAL_STACK_SIZE];
+static StaticTask_t timer_task_control_block;
+static StackType_t timer_task_stack[configTIMER_TASK_STACK_DEPTH];
+
+const uint32_t kernel_ram_bytes = sizeof(ucHeap) + sizeof(idle_task_control_block) + sizeof(idle_task_stack)
+        + sizeof(timer_task_control_block) + sizeof(timer_task_stack);
 /* USER CODE END Variables */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -52,6 +66,130 @@
 
 /* USER CODE END FunctionPrototypes */
 
+/* Functions needed when configGENERATE_RUN_TIME_STATS is on */
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
+
+/* Pre/Post sleep processing prototypes */
+void PreSleepProcessing(uint32_t ulExpectedIdleTime);
+void PostSleepProcessing(uint32_t ulExpectedIdleTime);
+
+/* Hook prototypes */
+void vApplicationIdleHook(void);
+
+/* USER CODE BEGIN 1 */
+/*-----------------------------------------------------------------------------
+ * Function: configureTimerForRunTimeStats
+ *
+ * The run time stats clock is TIM2, free running at the timer clock. It is
+ * started in main before the scheduler, so there is nothing left to do.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void configureTimerForRunTimeStats(void) {
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: getRunTimeCounterValue
+ *
+ * The counter wraps every 2^32 timer clocks (about 47 s), so task run times
+ * are only meaningful as differences over a shorter window (see sysinfo.c).
+ * TIM2 keeps counting in sleep mode, which is charged to the idle task.
+ *
+ * Parameters: None
+ * Return: unsigned long - TIM2 count
+ *---------------------------------------------------------------------------*/
+unsigned long getRunTimeCounterValue(void) {
+    return TIM2->CNT;
+}
+/* USER CODE END 1 */
+
+/* USER CODE BEGIN 2 */
+/*-----------------------------------------------------------------------------
+ * Function: vApplicationIdleHook
+ *
+ * Sleep until the next interrupt when the idle period is too short for a
+ * tickless sleep (configEXPECTED_IDLE_TIME_BEFORE_SLEEP). Longer idle
+ * periods are slept through by the port, see PreSleepProcessing.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void vApplicationIdleHook(void) {
+    __DSB();
+    __WFI();
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: vApplicationGetIdleTaskMemory
+ *
+ * Replaces the weak definition in cmsis_os2.c, see kernel_ram_bytes.
+ *
+ * Parameters: tcb - set to the idle task control block
+ *             stack - set to the idle task stack
+ *             stack_size - set to its size in words
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *stack_size) {
+    *tcb = &idle_task_control_block;
+    *stack = idle_task_stack;
+    *stack_size = sizeof(idle_task_stack) / sizeof(idle_task_stack[0]);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: vApplicationGetTimerTaskMemory
+ *
+ * Replaces the weak definition in cmsis_os2.c, see kernel_ram_bytes.
+ *
+ * Parameters: tcb - set to the timer task control block
+ *             stack - set to the timer task stack
+ *             stack_size - set to its size in words
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void vApplicationGetTimerTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *stack_size) {
+    *tcb = &timer_task_control_block;
+    *stack = timer_task_stack;
+    *stack_size = sizeof(timer_task_stack) / sizeof(timer_task_stack[0]);
+}
+/* USER CODE END 2 */
+
+/* USER CODE BEGIN PREPOSTSLEEP */
+/*-----------------------------------------------------------------------------
+ * Function: PreSleepProcessing
+ *
+ * Called by the tickless idle code with interrupts masked, right before it
+ * sleeps (WFI) with the SysTick stopped. The HAL time base on TIM4 would
+ * wake the core every millisecond, so it is suspended as well and the time
+ * spent asleep is measured on TIM5 instead.
+ *
+ * Parameters: uint32_t ulExpectedIdleTime - ticks until the next task is due
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void PreSleepProcessing(uint32_t ulExpectedIdleTime) {
+    HAL_SuspendTick();
+    sleep_start = TIM5->CNT;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: PostSleepProcessing
+ *
+ * Catch HAL_GetTick up with the time slept and resume the HAL time base.
+ * An update of TIM4 pending from the sleep is already part of that time.
+ *
+ * Parameters: uint32_t ulExpectedIdleTime - ticks until the next task is due
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void PostSleepProcessing(uint32_t ulExpectedIdleTime) {
+    uint32_t slept = TIM5->CNT - sleep_start + sleep_residue;
+
+    uwTick += slept / TIM5_COUNTS_PER_MS;
+    sleep_residue = slept % TIM5_COUNTS_PER_MS;
+    __HAL_TIM_CLEAR_FLAG(&htim4, TIM_FLAG_UPDATE);
+    HAL_ResumeTick();
+}
+/* USER CODE END PREPOSTSLEEP */
+
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
 
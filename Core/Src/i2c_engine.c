@@ -0,0 +1,598 @@
+/*
+ * i2c_engine.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include <string.h>
+
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "ring_buffer.h"
+#include "i2c_engine.h"
+#include "console_topology.h"
+#include "ram_budget.h"
+
+typedef enum {
+    ENGINE_IDLE, ENGINE_MUX, ENGINE_POINTER, ENGINE_READ, ENGINE_WRITE
+} engine_state_t;
+
+typedef struct {
+    uint8_t data[REGISTERS_SIZE];  // Register image, each read lands at its own offset
+    i2c_read_result_t read;
+} i2c_result_t;
+
+// One per I2C bus; the buses run their queues independently
+typedef struct {
+    I2C_HandleTypeDef *hi2c;
+    ring_buffer_t command_queue;
+    ring_buffer_t poll_queue;
+    i2c_job_t command_jobs[I2C_COMMAND_QUEUE_SIZE];
+    i2c_job_t poll_jobs[I2C_POLL_QUEUE_SIZE];
+    i2c_job_t job;                      // Job on the wire
+    volatile engine_state_t state;
+    volatile uint32_t job_start;        // DWT cycle count when the job was started
+    uint32_t job_timeout_us;            // Wire time plus latency budget of the job on the wire
+    uint8_t mux_mask;                   // Channel mask being written to the multiplexer
+    uint8_t dma_buffer[REGISTERS_SIZE];
+} i2c_bus_engine_t;
+
+static i2c_bus_engine_t buses[NUM_I2C_BUSES];
+static volatile bool suspended = false;
+static uint32_t cycles_per_us;
+static uint16_t latency_budget_us[MAX_NUM_CONSOLES];
+static i2c_start_sync_t start_sync;
+static int32_t start_min, start_max;        // Effective start relative to start_at, in cycles
+static i2c_result_t results[MAX_NUM_CONSOLES];
+static volatile console_mask_t results_ready;  // Bit per console with an uncollected result
+static i2c_engine_stats_t engine_stats = { 0 };
+static osThreadId_t notify_thread = NULL;   // Woken when a read result is published
+static uint32_t notify_flags;
+
+const uint32_t i2c_engine_ram_bytes = sizeof(buses) + sizeof(latency_budget_us) + sizeof(results);
+
+static void start_next(i2c_bus_engine_t *bus);
+
+static inline uint32_t job_elapsed_us(const i2c_bus_engine_t *bus) {
+    return (DWT->CYCCNT - bus->job_start) / cycles_per_us;
+}
+
+// Bus time of a job: address, register and data bytes at 9 clocks each
+static uint32_t wire_time_us(const i2c_bus_engine_t *bus, const i2c_job_t *j) {
+    return ((j->len + 3) * 9UL * 1000000UL) / bus->hi2c->Init.ClockSpeed;
+}
+
+static inline i2c_bus_engine_t* bus_of_console(uint8_t console) {
+    return &buses[topology_slot(console)->bus];
+}
+
+static inline i2c_bus_engine_t* bus_of_handle(const I2C_HandleTypeDef *hi2c) {
+    uint8_t b = topology_bus_of(hi2c);
+
+    return b < NUM_I2C_BUSES ? &buses[b] : NULL;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: set_start_delay
+ *
+ * Fill the start delay of the start job about to go on the wire: the time
+ * left until job.start_at once the write has completed, in
+ * START_DELAY_UNIT_US, rounded. A job already past the start gets 0.
+ *
+ * Parameters: i2c_bus_engine_t *bus - bus of the job
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void set_start_delay(i2c_bus_engine_t *bus) {
+    i2c_job_t *job = &bus->job;
+    int32_t left_us = (int32_t) (job->start_at - bus->job_start) / (int32_t) cycles_per_us
+            - (int32_t) wire_time_us(bus, job);
+    uint32_t delay = left_us > 0 ? (left_us + START_DELAY_UNIT_US / 2) / START_DELAY_UNIT_US : 0;
+
+    if (delay > (START_DELAY_MASK >> START_DELAY_SHIFT)) {
+        delay = START_DELAY_MASK >> START_DELAY_SHIFT;
+    }
+    job->data[1] = (job->data[1] & ~0x7F) | ((delay >> 8) & 0x7F);
+    job->data[2] = delay & 0xFF;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: record_start
+ *
+ * Account a start write that completed: the console starts the delay it was
+ * given after now. The spread of these times over all consoles is the skew.
+ *
+ * Parameters: const i2c_job_t *job - start job that completed
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void record_start(const i2c_job_t *job) {
+    uint32_t delay = ((job->data[1] & 0x7F) << 8) | job->data[2];
+    int32_t offset = (int32_t) (DWT->CYCCNT + delay * START_DELAY_UNIT_US * cycles_per_us - job->start_at);
+
+    if (start_sync.num_started == 0 || offset < start_min) {
+        start_min = offset;
+    }
+    if (start_sync.num_started == 0 || offset > start_max) {
+        start_max = offset;
+    }
+    if (delay == 0) {
+        start_sync.num_late++;
+    }
+    start_sync.num_started++;
+    start_sync.skew_us = (uint32_t) (start_max - start_min) / cycles_per_us;
+}
+
+static void publish_result(i2c_bus_engine_t *bus, HAL_StatusTypeDef status) {
+    const i2c_job_t *job = &bus->job;
+
+    if (status == HAL_ERROR) {
+        engine_stats.num_errors++;
+    }
+    if (job->type == I2C_JOB_START && status == HAL_OK) {
+        record_start(job);
+    }
+    if (job->type == I2C_JOB_READ && job->console < MAX_NUM_CONSOLES) {
+        i2c_read_result_t *read = &results[job->console].read;
+
+        if ((results_ready & (1UL << job->console)) == 0) {
+            read->first = read->end = job->reg;
+            read->status = HAL_OK;
+            read->latency_us = 0;
+        }
+        if (status == HAL_OK) {
+            uint32_t elapsed = job_elapsed_us(bus);
+            uint32_t wire = wire_time_us(bus, job);
+            uint32_t latency = elapsed > wire ? elapsed - wire : 0;
+
+            if (latency > read->latency_us) {
+                read->latency_us = latency > UINT16_MAX ? UINT16_MAX : latency;
+            }
+            memcpy(&results[job->console].data[job->reg], bus->dma_buffer, job->len);
+            if (read->first == read->end || job->reg < read->first) {
+                read->first = job->reg;
+            }
+            if (job->reg + job->len > read->end) {
+                read->end = job->reg + job->len;
+            }
+        } else if (read->status == HAL_OK) {
+            read->status = status;
+        }
+        results_ready |= 1UL << job->console;
+        if (notify_thread != NULL) {
+            osThreadFlagsSet(notify_thread, notify_flags);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: finish_job
+ *
+ * Publish the outcome of the current job and start the next one. Called from
+ * the I2C/DMA interrupts, or from the task with those interrupts masked.
+ *
+ * Parameters: i2c_bus_engine_t *bus - bus of the job
+ *             HAL_StatusTypeDef status - outcome of the job
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void finish_job(i2c_bus_engine_t *bus, HAL_StatusTypeDef status) {
+    publish_result(bus, status);
+    bus->state = ENGINE_IDLE;
+    start_next(bus);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: start_job
+ *
+ * Put the current job of a bus on the wire, after opening the multiplexer
+ * channel of its console if needed (the job continues from the completion
+ * of that write).
+ *
+ * Parameters: i2c_bus_engine_t *bus - bus of the job
+ * Return: HAL_StatusTypeDef - HAL_OK if a transfer was started
+ *---------------------------------------------------------------------------*/
+static HAL_StatusTypeDef start_job(i2c_bus_engine_t *bus) {
+    i2c_job_t *job = &bus->job;
+    uint8_t mux_addr;
+
+    bus->job_start = DWT->CYCCNT;
+    if (topology_mux_step(job->console, &mux_addr, &bus->mux_mask)) {
+        bus->state = ENGINE_MUX;
+        return HAL_I2C_Master_Transmit_IT(bus->hi2c, mux_addr << 1, &bus->mux_mask, 1);
+    }
+    if (job->type == I2C_JOB_READ) {
+        engine_stats.num_reads++;
+        bus->state = ENGINE_POINTER;
+        return HAL_I2C_Master_Transmit_IT(bus->hi2c, job->addr << 1, &job->reg, 1);
+    }
+    if (job->type == I2C_JOB_START) {
+        set_start_delay(bus);
+    }
+    engine_stats.num_writes++;
+    bus->state = ENGINE_WRITE;
+    return HAL_I2C_Mem_Write_IT(bus->hi2c, job->addr << 1, job->reg, I2C_MEMADD_SIZE_8BIT, job->data, job->len);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: start_next
+ *
+ * Take the next job of a bus, commands first, and put it on the wire. A job
+ * the HAL refuses to start is finished with that status and the next one is
+ * tried.
+ *
+ * Parameters: i2c_bus_engine_t *bus - bus to serve
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void start_next(i2c_bus_engine_t *bus) {
+    HAL_StatusTypeDef status;
+
+    while (bus->state == ENGINE_IDLE && !suspended) {
+        if (!ring_buffer_dequeue(&bus->command_queue, &bus->job)
+                && !ring_buffer_dequeue(&bus->poll_queue, &bus->job)) {
+            return;
+        }
+        // The multiplexer write is not timed separately, it is short against the latency budget
+        bus->job_timeout_us = wire_time_us(bus, &bus->job) + latency_budget_us[bus->job.console % MAX_NUM_CONSOLES];
+        status = start_job(bus);
+        if (status != HAL_OK) {
+            if (bus->state == ENGINE_MUX) {
+                topology_mux_done(bus - buses, bus->mux_mask, false);
+            }
+            bus->state = ENGINE_IDLE;
+            publish_result(bus, status);
+        }
+    }
+}
+
+static void kick(i2c_bus_engine_t *bus) {
+    taskENTER_CRITICAL();
+    if (bus->state == ENGINE_IDLE) {
+        start_next(bus);
+    }
+    taskEXIT_CRITICAL();
+}
+
+void i2c_engine_init(void) {
+    // The cycle counter times jobs with microsecond resolution
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cycles_per_us = SystemCoreClock / 1000000;
+    for (uint8_t i = 0; i < MAX_NUM_CONSOLES; i++) {
+        latency_budget_us[i] = I2C_TIMEOUT * 1000;
+    }
+    for (uint8_t b = 0; b < NUM_I2C_BUSES; b++) {
+        buses[b].hi2c = topology_bus(b)->hi2c;
+        buses[b].state = ENGINE_IDLE;
+        if (ring_buffer_init(&buses[b].command_queue, buses[b].command_jobs, I2C_COMMAND_QUEUE_SIZE,
+                sizeof(i2c_job_t)) != RING_BUFFER_OK
+                || ring_buffer_init(&buses[b].poll_queue, buses[b].poll_jobs, I2C_POLL_QUEUE_SIZE,
+                        sizeof(i2c_job_t)) != RING_BUFFER_OK) {
+            Error_Handler();
+        }
+    }
+}
+
+static bool enqueue(i2c_priority_t priority, const i2c_job_t *new_job) {
+    i2c_bus_engine_t *bus = bus_of_console(new_job->console);
+
+    if (!ring_buffer_enqueue(priority == I2C_PRIORITY_COMMAND ? &bus->command_queue : &bus->poll_queue, new_job)) {
+        engine_stats.num_dropped++;
+        return false;
+    }
+    kick(bus);
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_engine_read
+ *
+ * Queue a register read. The result is collected with i2c_engine_get_result.
+ * Reads queued for the same console before the result is collected merge
+ * into one result.
+ *
+ * Parameters: i2c_priority_t priority - queue to use
+ *             const device_list_t *device - console to read
+ *             uint8_t console - result slot (index into the device list)
+ *             uint8_t reg - first register
+ *             uint8_t len - number of bytes, clipped to the end of the register map
+ * Return: bool - false if the queue was full or reg is out of range
+ *---------------------------------------------------------------------------*/
+bool i2c_engine_read(i2c_priority_t priority, const device_list_t *device, uint8_t console, uint8_t reg,
+        uint8_t len) {
+    i2c_job_t new_job = { .type = I2C_JOB_READ, .console = console, .addr = device->i2c_addr, .reg = reg };
+
+    if (reg >= REGISTERS_SIZE) {
+        return false;
+    }
+    new_job.len = len > REGISTERS_SIZE - reg ? REGISTERS_SIZE - reg : len;
+    return enqueue(priority, &new_job);
+}
+
+bool i2c_engine_write(i2c_priority_t priority, const device_list_t *device, uint8_t console, uint8_t reg,
+        const uint8_t *data, uint8_t len) {
+    i2c_job_t new_job = { .type = I2C_JOB_WRITE, .console = console, .addr = device->i2c_addr, .reg = reg };
+
+    new_job.len = len > I2C_JOB_MAX_WRITE ? I2C_JOB_MAX_WRITE : len;
+    memcpy(new_job.data, data, new_job.len);
+    return enqueue(priority, &new_job);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_engine_send_command
+ *
+ * Queue a command register write (command and random seed, big-endian at
+ * REG_COMMAND) to every active console, ahead of any pending polls.
+ *
+ * Parameters: device_list_t device[] - device list
+ *             uint32_t command - command register value
+ *             uint32_t random_seed - random seed register value
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void i2c_engine_send_command(device_list_t device[], uint32_t command, uint32_t random_seed) {
+    uint8_t data[I2C_JOB_MAX_WRITE];
+
+    store_be32(&data[0], command);
+    store_be32(&data[4], random_seed);
+
+    for (uint8_t i = 0; i < MAX_NUM_CONSOLES; i++) {
+        if (device[i].is_active) {
+            i2c_engine_write(I2C_PRIORITY_COMMAND, &device[i], i, REG_COMMAND, data, sizeof(data));
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_engine_send_start
+ *
+ * Queue a game start for every active console so that they all start at the
+ * same moment. The start time is planned far enough ahead for every console
+ * to be written even if each write takes its full timeout; the buses are
+ * written in parallel, so the busiest bus sets the lead. Each write then
+ * carries the time left until that moment (START_DELAY_MASK), filled in when
+ * it goes on the wire. The outcome is reported by i2c_engine_get_start_sync.
+ *
+ * Parameters: device_list_t device[] - device list
+ *             uint32_t command - I2C_CMD_START_GAME command register value
+ *             uint32_t random_seed - random seed register value
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void i2c_engine_send_start(device_list_t device[], uint32_t command, uint32_t random_seed) {
+    i2c_job_t new_job = { .type = I2C_JOB_START, .reg = REG_COMMAND, .len = I2C_JOB_MAX_WRITE };
+    i2c_job_t longest = { .len = REGISTERS_SIZE };
+    uint32_t bus_lead_us[NUM_I2C_BUSES];
+    uint32_t lead_us = 0;
+    uint32_t write_us;
+
+    // Whatever is ahead of the start writes on each bus: the job on the wire and queued commands
+    for (uint8_t b = 0; b < NUM_I2C_BUSES; b++) {
+        write_us = wire_time_us(&buses[b], &new_job);
+        bus_lead_us[b] = ring_buffer_count(&buses[b].command_queue) * (write_us + I2C_TIMEOUT * 1000);
+        if (buses[b].state != ENGINE_IDLE) {
+            bus_lead_us[b] += wire_time_us(&buses[b], &longest) + I2C_TIMEOUT * 1000;
+        }
+    }
+    for (uint8_t i = 0; i < MAX_NUM_CONSOLES; i++) {
+        if (device[i].is_active) {
+            bus_lead_us[topology_slot(i)->bus] += wire_time_us(bus_of_console(i), &new_job) + latency_budget_us[i];
+        }
+    }
+    for (uint8_t b = 0; b < NUM_I2C_BUSES; b++) {
+        if (bus_lead_us[b] > lead_us) {
+            lead_us = bus_lead_us[b];
+        }
+    }
+
+    command &= ~START_DELAY_MASK;
+    store_be32(&new_job.data[0], command);
+    store_be32(&new_job.data[4], random_seed);
+    new_job.start_at = DWT->CYCCNT + lead_us * cycles_per_us;
+
+    taskENTER_CRITICAL();
+    memset(&start_sync, 0, sizeof(start_sync));
+    start_sync.lead_us = lead_us;
+    taskEXIT_CRITICAL();
+
+    for (uint8_t i = 0; i < MAX_NUM_CONSOLES; i++) {
+        if (device[i].is_active) {
+            new_job.console = i;
+            new_job.addr = device[i].i2c_addr;
+            enqueue(I2C_PRIORITY_COMMAND, &new_job);
+        }
+    }
+}
+
+void i2c_engine_get_start_sync(i2c_start_sync_t *sync) {
+    taskENTER_CRITICAL();
+    *sync = start_sync;
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_engine_get_result
+ *
+ * Collect the reads completed for a console since the last collection, if
+ * there are any. Only the registers in [first, end) are copied into data, at
+ * their register offsets; the rest of the caller's register image is left as
+ * it was.
+ *
+ * Parameters: uint8_t console - result slot
+ *             uint8_t *data - register image of the console (REGISTERS_SIZE bytes)
+ *             i2c_read_result_t *result - receives the range read and the outcome
+ * Return: bool - true if a new result was returned
+ *---------------------------------------------------------------------------*/
+bool i2c_engine_get_result(uint8_t console, uint8_t *data, i2c_read_result_t *result) {
+    console_mask_t bit = 1UL << console;
+    bool ready = false;
+
+    if ((results_ready & bit) == 0) {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    if (results_ready & bit) {
+        results_ready &= ~bit;
+        *result = results[console].read;
+        memcpy(&data[result->first], &results[console].data[result->first], result->end - result->first);
+        ready = true;
+    }
+    taskEXIT_CRITICAL();
+    return ready;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: service_bus
+ *
+ * Abort the job on a bus if it has not completed within its wire time plus
+ * the latency budget of its console (e.g. a console holding SCL low or one
+ * that was unplugged mid-transfer). The peripheral is re-initialised and the
+ * job finished with HAL_TIMEOUT.
+ *
+ * Parameters: i2c_bus_engine_t *bus - bus to check
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void service_bus(i2c_bus_engine_t *bus) {
+    const i2c_bus_config_t *config = topology_bus(bus - buses);
+
+    if (bus->state == ENGINE_IDLE || job_elapsed_us(bus) <= bus->job_timeout_us) {
+        return;
+    }
+
+    HAL_NVIC_DisableIRQ(config->ev_irq);
+    HAL_NVIC_DisableIRQ(config->er_irq);
+    HAL_NVIC_DisableIRQ(config->dma_irq);
+    if (bus->state != ENGINE_IDLE) {
+        HAL_DMA_Abort(config->hdma_rx);
+        HAL_I2C_DeInit(bus->hi2c);
+        HAL_I2C_Init(bus->hi2c);  // MSP init re-enables the interrupts
+        topology_mux_forget(bus - buses);
+        engine_stats.num_timeouts++;
+        taskENTER_CRITICAL();
+        finish_job(bus, HAL_TIMEOUT);
+        taskEXIT_CRITICAL();
+    } else {
+        HAL_NVIC_EnableIRQ(config->ev_irq);
+        HAL_NVIC_EnableIRQ(config->er_irq);
+        HAL_NVIC_EnableIRQ(config->dma_irq);
+    }
+}
+
+// Abort timed out jobs on every bus. Task context only.
+void i2c_engine_service(void) {
+    for (uint8_t b = 0; b < NUM_I2C_BUSES; b++) {
+        service_bus(&buses[b]);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_engine_suspend
+ *
+ * Stop starting new jobs and wait for the ones on the wire to finish, so the
+ * blocking HAL functions (bus scan, reset) can use the buses. Queued jobs are
+ * kept and run after i2c_engine_resume. Task context only.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void i2c_engine_suspend(void) {
+    suspended = true;
+    for (uint8_t b = 0; b < NUM_I2C_BUSES; b++) {
+        while (buses[b].state != ENGINE_IDLE) {
+            service_bus(&buses[b]);
+            osDelay(1);
+        }
+    }
+}
+
+void i2c_engine_resume(void) {
+    suspended = false;
+    for (uint8_t b = 0; b < NUM_I2C_BUSES; b++) {
+        kick(&buses[b]);
+    }
+}
+
+bool i2c_engine_is_idle(void) {
+    for (uint8_t b = 0; b < NUM_I2C_BUSES; b++) {
+        if (buses[b].state != ENGINE_IDLE || !is_ring_buffer_empty(&buses[b].command_queue)
+                || !is_ring_buffer_empty(&buses[b].poll_queue)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_engine_set_latency_budget
+ *
+ * Set the time a console's jobs may take beyond their wire time before they
+ * are aborted. Applies from the next job started.
+ *
+ * Parameters: uint8_t console - result slot
+ *             uint16_t budget_us - latency budget in microseconds
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void i2c_engine_set_latency_budget(uint8_t console, uint16_t budget_us) {
+    if (console < MAX_NUM_CONSOLES) {
+        latency_budget_us[console] = budget_us;
+    }
+}
+
+void i2c_engine_set_notify(osThreadId_t thread, uint32_t flags) {
+    notify_flags = flags;
+    notify_thread = thread;
+}
+
+void i2c_engine_get_stats(i2c_engine_stats_t *stats) {
+    taskENTER_CRITICAL();
+    *stats = engine_stats;
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------------------------
+ * HAL completion callbacks (I2C event/error and RX DMA interrupts of the buses)
+ *---------------------------------------------------------------------------*/
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_engine_t *bus = bus_of_handle(hi2c);
+    HAL_StatusTypeDef status;
+
+    if (bus == NULL) {
+        return;
+    }
+    if (bus->state == ENGINE_MUX) {
+        topology_mux_done(bus - buses, bus->mux_mask, true);
+        status = start_job(bus);
+        if (status != HAL_OK) {
+            finish_job(bus, status);
+        }
+    } else if (bus->state == ENGINE_POINTER) {
+        bus->state = ENGINE_READ;
+        if (HAL_I2C_Master_Receive_DMA(hi2c, bus->job.addr << 1, bus->dma_buffer, bus->job.len) != HAL_OK) {
+            finish_job(bus, HAL_ERROR);
+        }
+    }
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_engine_t *bus = bus_of_handle(hi2c);
+
+    if (bus != NULL && bus->state == ENGINE_READ) {
+        finish_job(bus, HAL_OK);
+    }
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_engine_t *bus = bus_of_handle(hi2c);
+
+    if (bus != NULL && bus->state == ENGINE_WRITE) {
+        finish_job(bus, HAL_OK);
+    }
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    i2c_bus_engine_t *bus = bus_of_handle(hi2c);
+
+    if (bus != NULL && bus->state != ENGINE_IDLE) {
+        if (bus->state == ENGINE_MUX) {
+            topology_mux_done(bus - buses, bus->mux_mask, false);
+        }
+        finish_job(bus, HAL_ERROR);
+    }
+}
@@ -9,6 +9,9 @@
 #include "game_stats.h"
 #include "i2c_master.h"
 #include "scoreboard.h"
+#include "console_topology.h"
+#include "ram_budget.h"
+#include <stddef.h>
 #include <string.h>
 
 volatile uint8_t i2c_rx_buffer[I2C_BUFFER_SIZE];
@@ -17,11 +20,27 @@ volatile uint8_t i2c_tx_index = 0;
 volatile uint8_t bytes_received = 0;
 volatile uint8_t start_position = 0;
 //volatile i2c_scoreboard_t i2c_register_struct;
-volatile uint8_t i2c_register[REGISTERS_SIZE] = { 0 };
+
+// Console side register banks, see struct2register
+static uint8_t register_banks[2][REGISTERS_SIZE];
+static volatile uint8_t active_bank = 0;      // Bank new reads are served from
+static volatile uint8_t transfer_active = 0;  // A read is being served from the active bank
+static volatile uint8_t flip_pending = 0;     // The other bank holds a newer update
+
+const uint32_t i2c_slave_ram_bytes = sizeof(register_banks) + sizeof(i2c_rx_buffer);
 
 extern I2C_HandleTypeDef hi2c2;
 extern RTC_HandleTypeDef hrtc;
 
+// Sequence registers framing each block, in REG_BLOCK_* bit order
+static const struct {
+    uint8_t begin;
+    uint8_t end;
+} reg_blocks[NUM_REG_BLOCKS] = {
+    { REG_ADDR_hot_seq_begin, REG_ADDR_hot_seq_end },
+    { REG_ADDR_cold_seq_begin, REG_ADDR_cold_seq_end },
+};
+
 void volatile_memcpy(volatile void *dest, void *src, size_t n) {
     for (size_t i = 0; i < n; i++) {
         *((volatile uint8_t*) dest + i) = *((uint8_t*) src + i);
@@ -46,123 +65,189 @@ void initialize_scoreboard_data(i2c_scoreboard_t *data) {
     memset(data, 0, sizeof(i2c_scoreboard_t));
 }
 
+#if REGISTER_BLOCK_CRC
+/*-----------------------------------------------------------------------------
+ * Function: block_crc
+ *
+ * CRC-32 (poly 0x04C11DB7, init 0xFFFFFFFF, not reflected) of a block, fed
+ * as big-endian words with the last word padded with zeros. The CRC unit
+ * does the work on the target; host builds use the bitwise equivalent.
+ *
+ * Parameters: const uint8_t *p - first byte of the block
+ *             uint8_t len - length of the block
+ * Return: uint8_t - low byte of the CRC
+ *---------------------------------------------------------------------------*/
+static uint8_t block_crc(const uint8_t *p, uint8_t len) {
+    uint8_t last[4] = { 0 };
+    uint32_t word;
+#if defined(__ARM_ARCH_7EM__)
+    __HAL_RCC_CRC_CLK_ENABLE();
+    CRC->CR = CRC_CR_RESET;
+#else
+    uint32_t crc = 0xFFFFFFFF;
+#endif
+
+    while (len > 0) {
+        if (len < 4) {
+            memcpy(last, p, len);
+            p = last;
+            len = 4;
+        }
+        word = load_be32(p);
+#if defined(__ARM_ARCH_7EM__)
+        CRC->DR = word;
+#else
+        crc ^= word;
+        for (uint8_t bit = 0; bit < 32; bit++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+        }
+#endif
+        p += 4;
+        len -= 4;
+    }
+#if defined(__ARM_ARCH_7EM__)
+    return (uint8_t) CRC->DR;
+#else
+    return (uint8_t) crc;
+#endif
+}
+#endif
+
+// Value the trailing sequence register of a block must hold
+static uint8_t block_check(const uint8_t reg[], uint8_t block) {
+#if REGISTER_BLOCK_CRC
+    return block_crc(&reg[reg_blocks[block].begin], reg_blocks[block].end - reg_blocks[block].begin);
+#else
+    return reg[reg_blocks[block].begin];
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: struct2register
+ *
+ * Publish the registers to the master. The registers are double buffered:
+ * the update is encoded into the bank the slave interrupt is not serving
+ * and the banks are flipped, at once if no read is in progress, otherwise
+ * when that read ends (i2c_slave_transfer_end). A read is always served
+ * from one bank, so it never sees half an update.
+ *
+ * The sequence register pair of a block advances only when the block
+ * changed, so the master can still tell what is new (i2c_master_torn_blocks).
+ *
+ * Parameters: i2c_scoreboard_t *data - register values
+ * Return: None
+ *---------------------------------------------------------------------------*/
 void struct2register(i2c_scoreboard_t *data) {
-    uint8_t i = 0;
-    i2c_register[i++] = data->console_info;
-    i2c_register[i++] = data->current_game_state;
-    i2c_register[i++] = data->current_game_state2;
-    i2c_register[i++] = data->current_game_state3;
-    i2c_register[i++] = (uint8_t) (data->current_score1 >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->current_score1 & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->current_score2 >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->current_score2 & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->number_apples1 >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->number_apples1 & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->number_apples2 >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->number_apples2 & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->high_score >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->high_score & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->playing_time >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->playing_time & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->num_apples_easy >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->num_apples_easy & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->num_apples_medium >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->num_apples_medium & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->num_apples_hard >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->num_apples_hard & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->num_apples_insane >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->num_apples_insane & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->high_score_easy >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->high_score_easy & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->high_score_medium >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->high_score_medium & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->high_score_hard >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->high_score_hard & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->high_score_insane >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->high_score_insane & 0xFF;
-    i2c_register[i++] = (uint8_t) data->initials_easy[0];
-    i2c_register[i++] = (uint8_t) data->initials_easy[1];
-    i2c_register[i++] = (uint8_t) data->initials_easy[2];
-    i2c_register[i++] = (uint8_t) data->initials_medium[0];
-    i2c_register[i++] = (uint8_t) data->initials_medium[1];
-    i2c_register[i++] = (uint8_t) data->initials_medium[2];
-    i2c_register[i++] = (uint8_t) data->initials_hard[0];
-    i2c_register[i++] = (uint8_t) data->initials_hard[1];
-    i2c_register[i++] = (uint8_t) data->initials_hard[2];
-    i2c_register[i++] = (uint8_t) data->initials_insane[0];
-    i2c_register[i++] = (uint8_t) data->initials_insane[1];
-    i2c_register[i++] = (uint8_t) data->initials_insane[2];
-    i2c_register[i++] = (uint8_t) (data->date_time >> 24) & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->date_time >> 16) & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->date_time >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->date_time & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->command >> 24) & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->command >> 16) & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->command >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->command & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->random_seed >> 24) & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->random_seed >> 16) & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->random_seed >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->random_seed & 0xFF;
+    uint32_t primask;
+    const uint8_t *current;
+    uint8_t *next;
+    uint8_t begin, end;
+
+    // Take back an update still waiting for its flip; the bank is rewritten as a whole
+    primask = __get_PRIMASK();
+    __disable_irq();
+    flip_pending = 0;
+    __set_PRIMASK(primask);
+
+    current = register_banks[active_bank];
+    next = register_banks[active_bank ^ 1];
+    register_encode(data, next);
+    for (uint8_t b = 0; b < NUM_REG_BLOCKS; b++) {
+        begin = reg_blocks[b].begin;
+        end = reg_blocks[b].end;
+        next[begin] = current[begin];
+        if (memcmp(&next[begin + 1], &current[begin + 1], end - begin - 1) != 0) {
+            next[begin]++;
+        }
+        next[end] = block_check(next, b);
+    }
+    data->hot_seq_begin = next[REG_ADDR_hot_seq_begin];
+    data->hot_seq_end = next[REG_ADDR_hot_seq_end];
+    data->cold_seq_begin = next[REG_ADDR_cold_seq_begin];
+    data->cold_seq_end = next[REG_ADDR_cold_seq_end];
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (transfer_active) {
+        flip_pending = 1;
+    } else {
+        active_bank ^= 1;
+    }
+    __set_PRIMASK(primask);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_slave_read_begin
+ *
+ * Called by the console's slave interrupt when the master starts reading at
+ * register reg. The returned bytes stay unchanged until
+ * i2c_slave_transfer_end, so they can be handed to
+ * HAL_I2C_Slave_Seq_Transmit_IT as they are; the register address
+ * auto-increments through the buffer.
+ *
+ * Parameters: uint8_t reg - register the master addressed
+ *             uint8_t *len - set to the number of registers from reg to the end
+ * Return: const uint8_t* - register reg in the bank being served
+ *---------------------------------------------------------------------------*/
+const uint8_t* i2c_slave_read_begin(uint8_t reg, uint8_t *len) {
+    if (reg >= REGISTERS_SIZE) {
+        reg = REGISTERS_SIZE;
+    }
+    transfer_active = 1;
+    *len = REGISTERS_SIZE - reg;
+    return &register_banks[active_bank][reg];
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_slave_transfer_end
+ *
+ * Called by the console's slave interrupt when a transfer ends (STOP, or the
+ * master's NACK of the last byte). Flips in an update that was made while
+ * the transfer was in progress.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void i2c_slave_transfer_end(void) {
+    transfer_active = 0;
+    if (flip_pending) {
+        active_bank ^= 1;
+        flip_pending = 0;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_master_torn_blocks
+ *
+ * Check the blocks that lie entirely within [first, end) of a register image
+ * read from a console. A block is torn when the console updated it while it
+ * was being read; its values are a mix of two updates and must be read again.
+ *
+ * Parameters: const uint8_t reg[] - register image
+ *             uint8_t first - first register that was read
+ *             uint8_t end - one past the last register that was read
+ * Return: uint8_t - REG_BLOCK_* bit per torn block, 0 if the image is consistent
+ *---------------------------------------------------------------------------*/
+uint8_t i2c_master_torn_blocks(const uint8_t reg[], uint8_t first, uint8_t end) {
+    uint8_t torn = 0;
+
+    for (uint8_t b = 0; b < NUM_REG_BLOCKS; b++) {
+        if (reg_blocks[b].begin >= first && reg_blocks[b].end < end && reg[reg_blocks[b].end] != block_check(reg, b)) {
+            torn |= 1 << b;
+        }
+    }
+    return torn;
 }
 
 void register2struct(uint8_t reg[], i2c_scoreboard_t *data) {
-    uint8_t i = 0;
-    data->console_info = reg[i++];
-    data->current_game_state = reg[i++];
-    data->current_game_state2 = reg[i++];
-    data->current_game_state3 = reg[i++];
-    data->current_score1 = (reg[i++] << 8);
-    data->current_score1 |= reg[i++];
-    data->current_score2 = (reg[i++] << 8);
-    data->current_score2 |= reg[i++];
-    data->number_apples1 = (reg[i++] << 8);
-    data->number_apples1 |= reg[i++];
-    data->number_apples2 = (reg[i++] << 8);
-    data->number_apples2 |= reg[i++];
-    data->high_score = (reg[i++] << 8);
-    data->high_score |= reg[i++];
-    data->playing_time = (reg[i++] << 8);
-    data->playing_time |= reg[i++];
-    data->num_apples_easy = (reg[i++] << 8);
-    data->num_apples_easy |= reg[i++];
-    data->num_apples_medium = (reg[i++] << 8);
-    data->num_apples_medium |= reg[i++];
-    data->num_apples_hard = (reg[i++] << 8);
-    data->num_apples_hard |= reg[i++];
-    data->num_apples_insane = (reg[i++] << 8);
-    data->num_apples_insane |= reg[i++];
-    data->high_score_easy = (reg[i++] << 8);
-    data->high_score_easy |= reg[i++];
-    data->high_score_medium = (reg[i++] << 8);
-    data->high_score_medium |= reg[i++];
-    data->high_score_hard = (reg[i++] << 8);
-    data->high_score_hard |= reg[i++];
-    data->high_score_insane = (reg[i++] << 8);
-    data->high_score_insane |= reg[i++];
-    memcpy(data->initials_easy, (char*) &reg[i], 3);
-    i += 3;
-    memcpy(data->initials_medium, (char*) &reg[i], 3);
-    i += 3;
-    memcpy(data->initials_hard, (char*) &reg[i], 3);
-    i += 3;
-    memcpy(data->initials_insane, (char*) &reg[i], 3);
-    i += 3;
-    data->date_time = (reg[i++] << 24);
-    data->date_time |= (reg[i++] << 16);
-    data->date_time |= (reg[i++] << 8);
-    data->date_time |= reg[i++];
+    register_decode(reg, data);
     // Clear out command since it's write only
     data->command = 0;
 }
 
 void update_command_register(i2c_scoreboard_t *data, uint32_t command) {
     data->command = command;
-    uint8_t i = 0x30;
-    i2c_register[i++] = (uint8_t) (data->command >> 24) & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->command >> 16) & 0xFF;
-    i2c_register[i++] = (uint8_t) (data->command >> 8) & 0xFF;
-    i2c_register[i++] = (uint8_t) data->command & 0xFF;
+    struct2register(data);
 }
 
 void update_register(i2c_scoreboard_t *data, game_stats_t game_stats[], uint16_t current_score[],
@@ -172,6 +257,7 @@ void update_register(i2c_scoreboard_t *data, game_stats_t game_stats[], uint16_t
 
     RTC_TimeTypeDef sTime;
     RTC_DateTypeDef sDate;
+    i2c_scoreboard_t previous = *data;
 
     HAL_RTC_GetTime(&hrtc, &sTime, RTC_FORMAT_BIN);
     HAL_RTC_GetDate(&hrtc, &sDate, RTC_FORMAT_BIN);
@@ -212,6 +298,12 @@ void update_register(i2c_scoreboard_t *data, game_stats_t game_stats[], uint16_t
     memcpy(data->initials_hard, game_stats[HARD].player_name, 3);
     memcpy(data->initials_insane, game_stats[INSANE].player_name, 3);
 
+    // Tell the master to re-read the cold block (stats_generation is in the hot block)
+    if (memcmp(&previous.num_apples_easy, &data->num_apples_easy,
+            offsetof(i2c_scoreboard_t, initials_insane) + 3 - offsetof(i2c_scoreboard_t, num_apples_easy)) != 0) {
+        data->stats_generation++;
+    }
+
     data->date_time = (sDate.Year << YEAR_SHIFT) | (sDate.Month << MONTH_SHIFT) | (sDate.Date << DAY_SHIFT)
             | (sTime.Hours << HOUR_SHIFT) | (sTime.Minutes << MINUTE_SHIFT) | (sTime.Seconds << SECOND_SHIFT);
     struct2register(data);
@@ -243,62 +335,80 @@ HAL_StatusTypeDef get_console_data(I2C_HandleTypeDef *hi2c, uint16_t i2c_addr, u
     }
 }
 
-HAL_StatusTypeDef fetch_scoreboard_data(I2C_HandleTypeDef *hi2c, device_list_t *device,
-        uint8_t scoreboard_data[]) {
+/*-----------------------------------------------------------------------------
+ * Function: fetch_scoreboard_data
+ *
+ * Read the whole register image of a console on its bus, again if a block
+ * came back torn. Blocking; the I2C engine must be suspended.
+ *
+ * Parameters: device_list_t device[] - device list
+ *             uint8_t device_index - console slot
+ *             uint8_t scoreboard_data[] - receives REGISTERS_SIZE bytes
+ * Return: HAL_StatusTypeDef - HAL_BUSY if the blocks stayed torn
+ *---------------------------------------------------------------------------*/
+HAL_StatusTypeDef fetch_scoreboard_data(device_list_t device[], uint8_t device_index, uint8_t scoreboard_data[]) {
+    I2C_HandleTypeDef *hi2c = topology_bus(topology_slot(device_index)->bus)->hi2c;
+    uint16_t i2c_addr = device[device_index].i2c_addr;
     HAL_StatusTypeDef status;
     uint8_t reg_addr[1] = { 0 };
-    status = HAL_I2C_Master_Transmit(hi2c, device->i2c_addr << 1, reg_addr, 1, I2C_TIMEOUT);
-    if (status == HAL_OK) {
-        status = HAL_I2C_Master_Receive(hi2c, device->i2c_addr << 1, scoreboard_data, REGISTERS_SIZE,
-        I2C_TIMEOUT);
+
+    status = topology_select(device_index);
+    for (uint8_t attempt = 0; status == HAL_OK && attempt <= REG_TORN_RETRIES; attempt++) {
+        status = HAL_I2C_Master_Transmit(hi2c, i2c_addr << 1, reg_addr, 1, I2C_TIMEOUT);
+        if (status == HAL_OK) {
+            status = HAL_I2C_Master_Receive(hi2c, i2c_addr << 1, scoreboard_data, REGISTERS_SIZE, I2C_TIMEOUT);
+        }
+        if (status != HAL_OK || i2c_master_torn_blocks(scoreboard_data, 0, REGISTERS_SIZE) == 0) {
+            return status;
+        }
     }
-    return status;
+    return status != HAL_OK ? status : HAL_BUSY;  // Console kept updating its registers under the read
 }
 
-HAL_StatusTypeDef i2c_send_command(I2C_HandleTypeDef *hi2c, device_list_t device[], uint32_t command, uint32_t random_seed) {
-    HAL_StatusTypeDef status;
-    uint8_t data[8] = { 0 };
-
-    data[0] = (uint8_t) (command >> 24) & 0xFF;
-    data[1] = (uint8_t) (command >> 16) & 0xFF;
-    data[2] = (uint8_t) (command >> 8) & 0xFF;
-    data[3] = (uint8_t) command & 0xFF;
-    data[4] = (uint8_t) (random_seed >> 24) & 0xFF;
-    data[5] = (uint8_t) (random_seed >> 16) & 0xFF;
-    data[6] = (uint8_t) (random_seed >> 8) & 0xFF;
-    data[7] = (uint8_t) random_seed & 0xFF;
-
-    for (uint8_t i = 0; i < MAX_NUM_CONSOLES; i++) {
-        if (device[i].is_active) {
-            status = HAL_I2C_Mem_Write(hi2c, device[i].i2c_addr << 1, 0x30, sizeof(uint8_t), data, 8, I2C_TIMEOUT);
-            if (status != HAL_OK) {
-                __NOP(); // Ignore error, continue to next device
-            }
-        }
+HAL_StatusTypeDef i2c_master_scan(device_list_t device[]) {
+    HAL_StatusTypeDef status = HAL_OK;
+
+    for (uint8_t device_index = 0; device_index < topology_num_slots(); device_index++) {
+        status = i2c_master_probe(device, device_index);
     }
     return status;
 }
 
-HAL_StatusTypeDef i2c_master_scan(I2C_HandleTypeDef *hi2c, device_list_t device[]) {
+/*-----------------------------------------------------------------------------
+ * Function: i2c_master_probe
+ *
+ * Check whether the console for one slot answers at the bus, multiplexer
+ * channel and address of that slot (console_topology.h) and carries the
+ * console signature, and update its device list entry. A console that does
+ * not answer is marked inactive.
+ *
+ * Parameters: device_list_t device[] - device list
+ *             uint8_t device_index - console slot
+ * Return: HAL_StatusTypeDef - HAL_OK if the console was found
+ *---------------------------------------------------------------------------*/
+HAL_StatusTypeDef i2c_master_probe(device_list_t device[], uint8_t device_index) {
+    const console_slot_t *slot = topology_slot(device_index);
+    I2C_HandleTypeDef *hi2c = topology_bus(slot->bus)->hi2c;
     HAL_StatusTypeDef status;
-    uint16_t device_addr;
-    uint8_t device_index;
+    uint16_t device_addr = slot->i2c_addr;
     uint8_t data[2] = { 0, 0 };
 
-    for (device_addr = 0x10; device_addr <= 0x14; device_addr++) {
+    device[device_index].is_active = 0;
+    status = topology_select(device_index);
+    if (status == HAL_OK) {
         status = HAL_I2C_IsDeviceReady(hi2c, device_addr << 1, 1, 10);
-        if (status == HAL_OK) {
-            memset(&data, 0, 2);
-            status = get_console_data(hi2c, device_addr << 1, 0, data, 1);
-            if (status == HAL_OK) {
-                if (data[0] & CONSOLE_SIGNATURE) {
-                    device_index = device_addr - 16;
-                    device[device_index].i2c_addr = device_addr;
-                    device[device_index].device_id = data[0] & CONSOLE_IDENTIFIER;
-                    device[device_index].is_active = 1;
-                }
-            }
-        }
+    }
+    if (status == HAL_OK) {
+        status = get_console_data(hi2c, device_addr << 1, REG_ADDR_console_info, data, 1);
+    }
+    if (status == HAL_OK && !(data[0] & CONSOLE_SIGNATURE)) {
+        status = HAL_ERROR;
+    }
+    if (status == HAL_OK) {
+        device[device_index].i2c_addr = device_addr;
+        // CONSOLE_IDENTIFIER repeats on every multiplexer channel, the slot does not
+        device[device_index].device_id = device_index + 1;
+        device[device_index].is_active = 1;
     }
     return status;
 }
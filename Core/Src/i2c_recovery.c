@@ -0,0 +1,123 @@
+/*
+ * i2c_recovery.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include "i2c_recovery.h"
+
+static void delay_us(uint32_t us) {
+    uint32_t start = DWT->CYCCNT;
+    uint32_t cycles = us * (SystemCoreClock / 1000000);
+
+    while (DWT->CYCCNT - start < cycles) {
+    }
+}
+
+static inline bool sda_is_high(const i2c_bus_config_t *config) {
+    return HAL_GPIO_ReadPin(config->sda_port, config->sda_pin) == GPIO_PIN_SET;
+}
+
+static inline bool scl_is_high(const i2c_bus_config_t *config) {
+    return HAL_GPIO_ReadPin(config->scl_port, config->scl_pin) == GPIO_PIN_SET;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: release_scl
+ *
+ * Let SCL go high and wait for a slave that is stretching the clock.
+ *
+ * Parameters: const i2c_bus_config_t *config - bus pins
+ * Return: bool - false if SCL is still held low after I2C_RECOVERY_STRETCH_US
+ *---------------------------------------------------------------------------*/
+static bool release_scl(const i2c_bus_config_t *config) {
+    uint32_t waited = 0;
+
+    HAL_GPIO_WritePin(config->scl_port, config->scl_pin, GPIO_PIN_SET);
+    while (!scl_is_high(config)) {
+        if (waited++ >= I2C_RECOVERY_STRETCH_US) {
+            return false;
+        }
+        delay_us(1);
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_bus_is_stuck
+ *
+ * Check whether the bus is idle. Both lines must be high and the peripheral
+ * must not consider itself busy (its BUSY flag can stay latched after a
+ * glitch on the lines, see the STM32F446 errata).
+ *
+ * Parameters: uint8_t bus - i2c_bus_id_t
+ * Return: bool - true if the bus needs to be recovered
+ *---------------------------------------------------------------------------*/
+bool i2c_bus_is_stuck(uint8_t bus) {
+    const i2c_bus_config_t *config = topology_bus(bus);
+
+    return !sda_is_high(config) || !scl_is_high(config) || __HAL_I2C_GET_FLAG(config->hi2c, I2C_FLAG_BUSY);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: i2c_bus_recover
+ *
+ * Free the bus by clocking SCL until the slave holding SDA lets go, then
+ * generate a STOP and re-initialise the peripheral (HAL_I2C_Init also
+ * resets it, which clears a latched BUSY flag). Blocks for well under a
+ * millisecond unless a slave stretches the clock. A multiplexer on the bus
+ * may have been reset along with it, so its channels are written again
+ * before the next job.
+ *
+ * Parameters: uint8_t bus - i2c_bus_id_t
+ * Return: bool - true if both lines are high afterwards
+ *---------------------------------------------------------------------------*/
+bool i2c_bus_recover(uint8_t bus) {
+    const i2c_bus_config_t *config = topology_bus(bus);
+    I2C_HandleTypeDef *hi2c = config->hi2c;
+    GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+    bool released;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    HAL_I2C_DeInit(hi2c);
+
+    // Drive both lines as open-drain GPIO, released
+    HAL_GPIO_WritePin(config->scl_port, config->scl_pin, GPIO_PIN_SET);
+    HAL_GPIO_WritePin(config->sda_port, config->sda_pin, GPIO_PIN_SET);
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    GPIO_InitStruct.Pin = config->scl_pin;
+    HAL_GPIO_Init(config->scl_port, &GPIO_InitStruct);
+    GPIO_InitStruct.Pin = config->sda_pin;
+    HAL_GPIO_Init(config->sda_port, &GPIO_InitStruct);
+    delay_us(I2C_RECOVERY_HALF_US);
+
+    released = release_scl(config);
+    for (uint8_t i = 0; released && i < I2C_RECOVERY_PULSES && !sda_is_high(config); i++) {
+        HAL_GPIO_WritePin(config->scl_port, config->scl_pin, GPIO_PIN_RESET);
+        delay_us(I2C_RECOVERY_HALF_US);
+        released = release_scl(config);
+        delay_us(I2C_RECOVERY_HALF_US);
+    }
+
+    // STOP: SDA low to high while SCL is high
+    if (released) {
+        HAL_GPIO_WritePin(config->scl_port, config->scl_pin, GPIO_PIN_RESET);
+        delay_us(I2C_RECOVERY_HALF_US);
+        HAL_GPIO_WritePin(config->sda_port, config->sda_pin, GPIO_PIN_RESET);
+        delay_us(I2C_RECOVERY_HALF_US);
+        released = release_scl(config);
+        delay_us(I2C_RECOVERY_HALF_US);
+        HAL_GPIO_WritePin(config->sda_port, config->sda_pin, GPIO_PIN_SET);
+        delay_us(I2C_RECOVERY_HALF_US);
+    }
+    released = released && sda_is_high(config) && scl_is_high(config);
+
+    HAL_I2C_Init(hi2c);  // MSP init gives the pins back to the peripheral
+    topology_mux_forget(bus);
+    return released;
+}
@@ -5,13 +5,179 @@
  *      Author: josh
  */
 
+#include "FreeRTOS.h"
+#include "task.h"
 #include "led_indicator.h"
 
+#define LED_NO_LAYER LED_NUM_PRIORITIES
+
+extern TIM_HandleTypeDef htim5;
+
+static led_indicator_t *indicators[LED_MAX_INDICATORS];
+static uint8_t num_indicators = 0;
+
+static inline bool is_due(uint32_t edge, uint32_t now) {
+    return (int32_t) (edge - now) <= 0;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: start_cycle
+ *
+ * Begin a cycle of the shown pattern at led->cycle_start. Steady patterns
+ * that repeat forever have no edges and need no interrupts.
+ *
+ * Parameters: led_indicator_t *led - pointer to the LED indicator
+ *
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void start_cycle(led_indicator_t *led) {
+    const led_pattern_t *p = &led->layer[led->shown];
+
+    led->lit = p->on_time > 0;
+    if (p->on_time > 0 && p->on_time < p->period) {
+        led->next_edge = led->cycle_start + p->on_time;
+    } else {
+        led->next_edge = led->cycle_start + p->period;
+    }
+    led->timed = p->count != LED_FOREVER || (p->on_time > 0 && p->on_time < p->period);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: select_layer
+ *
+ * Show the highest priority running layer, starting its cycle now.
+ *
+ * Parameters: led_indicator_t *led - pointer to the LED indicator
+ *             uint32_t now - TIM5 count
+ *
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void select_layer(led_indicator_t *led, uint32_t now) {
+    led->shown = LED_NO_LAYER;
+    for (int8_t l = LED_NUM_PRIORITIES - 1; l >= 0; l--) {
+        if (led->active & (1 << l)) {
+            led->shown = l;
+            break;
+        }
+    }
+    if (led->shown == LED_NO_LAYER) {
+        led->lit = 0;
+        led->timed = 0;
+        return;
+    }
+    led->cycle_start = now;
+    start_cycle(led);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: advance
+ *
+ * Step the indicator past the edge at led->next_edge: the end of the lit
+ * part of a cycle or the end of the cycle.
+ *
+ * Parameters: led_indicator_t *led - pointer to the LED indicator
+ *
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void advance(led_indicator_t *led) {
+    const led_pattern_t *p = &led->layer[led->shown];
+    uint32_t edge = led->next_edge;
+
+    if (led->lit && p->on_time < p->period) {
+        led->lit = 0;
+        led->next_edge = led->cycle_start + p->period;
+        return;
+    }
+    if (p->count != LED_FOREVER && --led->remaining[led->shown] == 0) {
+        led->active &= ~(1 << led->shown);
+        select_layer(led, edge);
+        return;
+    }
+    led->cycle_start = edge;
+    start_cycle(led);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: write_outputs
+ *
+ * Drive every LED to its current state, one BSRR write per GPIO port.
+ *
+ * Parameters: None
+ *
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void write_outputs(void) {
+    GPIO_TypeDef *ports[LED_MAX_INDICATORS];
+    uint32_t bsrr[LED_MAX_INDICATORS];
+    uint8_t num_ports = 0;
+
+    for (uint8_t i = 0; i < num_indicators; i++) {
+        led_indicator_t *led = indicators[i];
+        uint8_t p = 0;
+
+        while (p < num_ports && ports[p] != led->port) {
+            p++;
+        }
+        if (p == num_ports) {
+            ports[p] = led->port;
+            bsrr[p] = 0;
+            num_ports++;
+        }
+        bsrr[p] |= led->lit ? (uint32_t) led->pin << 16 : led->pin; // High turns off LED
+    }
+    for (uint8_t p = 0; p < num_ports; p++) {
+        ports[p]->BSRR = bsrr[p];
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: run_engine
+ *
+ * Process all edges that are due, update the outputs and arm the TIM5
+ * compare for the next edge, or disable it if nothing is blinking. Called
+ * from the compare interrupt, or from a task inside a critical section.
+ *
+ * Parameters: None
+ *
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void run_engine(void) {
+    uint32_t now;
+    uint32_t next = 0;
+    bool armed;
+
+    do {
+        now = TIM5->CNT;
+        armed = false;
+        for (uint8_t i = 0; i < num_indicators; i++) {
+            led_indicator_t *led = indicators[i];
+
+            while (led->timed && is_due(led->next_edge, now)) {
+                advance(led);
+            }
+            if (led->timed && (!armed || (int32_t) (led->next_edge - next) < 0)) {
+                next = led->next_edge;
+                armed = true;
+            }
+        }
+        write_outputs();
+        if (armed) {
+            __HAL_TIM_SET_COMPARE(&htim5, TIM_CHANNEL_1, next);
+        }
+        // The counter may have reached the edge while the compare was set
+    } while (armed && is_due(next, TIM5->CNT));
+
+    if (armed) {
+        __HAL_TIM_ENABLE_IT(&htim5, TIM_IT_CC1);
+    } else {
+        __HAL_TIM_DISABLE_IT(&htim5, TIM_IT_CC1);
+    }
+}
 
 /*-----------------------------------------------------------------------------
  * Function: led_indicator_init
  *
- * This function will initialize the LED indicator
+ * This function will initialize the LED indicator and add it to the engine
  *
  * Parameters: led_indicator_t *led - pointer to the LED indicator
  *             GPIO_TypeDef *port - GPIO port
@@ -20,18 +186,61 @@
  * Return: None
  *---------------------------------------------------------------------------*/
 void led_indicator_init(led_indicator_t *led, GPIO_TypeDef *port, uint16_t pin) {
+    if (num_indicators >= LED_MAX_INDICATORS) {
+        Error_Handler();
+    }
     led->port = port;
     led->pin = pin;
-    led->state = LED_OFF;
-    led->blink_period = 0;
-    led->blink_counter = 0;
-    led->last_update = 0;
+    led->active = 0;
+    led->shown = LED_NO_LAYER;
+    led->lit = 0;
+    led->timed = 0;
+
+    taskENTER_CRITICAL();
+    indicators[num_indicators++] = led;
+    run_engine();
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: led_indicator_set_pattern
+ *
+ * Replace the pattern at the given priority. The indicator restarts unless
+ * a higher priority pattern is shown. Task context only.
+ *
+ * Parameters: led_indicator_t *led - pointer to the LED indicator
+ *             const led_pattern_t *pattern - pattern, period 0 clears the layer
+ *
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void led_indicator_set_pattern(led_indicator_t *led, const led_pattern_t *pattern) {
+    uint8_t l = pattern->priority;
+
+    taskENTER_CRITICAL();
+    led->layer[l] = *pattern;
+    led->remaining[l] = pattern->count;
+    if (pattern->period > 0) {
+        led->active |= 1 << l;
+    } else {
+        led->active &= ~(1 << l);
+    }
+    if (led->shown == LED_NO_LAYER || l >= led->shown) {
+        select_layer(led, TIM5->CNT);
+    }
+    run_engine();
+    taskEXIT_CRITICAL();
+}
+
+void led_indicator_clear(led_indicator_t *led, led_priority_t priority) {
+    led_pattern_t off = { .period = 0, .priority = priority };
+
+    led_indicator_set_pattern(led, &off);
 }
 
 /*-----------------------------------------------------------------------------
  * Function: led_indicator_set_state
  *
- * This function will set the state of the LED indicator
+ * This function will set the steady state of the LED indicator (base layer)
  *
  * Parameters: led_indicator_t *led - pointer to the LED indicator
  *             led_state_t state - state of the LED
@@ -39,58 +248,61 @@ void led_indicator_init(led_indicator_t *led, GPIO_TypeDef *port, uint16_t pin)
  * Return: None
  *---------------------------------------------------------------------------*/
 void led_indicator_set_state(led_indicator_t *led, led_state_t state) {
-    HAL_GPIO_WritePin(led->port, led->pin, state);
+    led_pattern_t pattern = { .period = LED_BLINK_PERIOD, .count = LED_FOREVER, .priority = LED_PRIORITY_BASE };
+
+    switch (state) {
+        case LED_ON:
+            pattern.on_time = LED_BLINK_PERIOD;
+            break;
+        case LED_BLINK:
+            pattern.on_time = LED_BLINK_PERIOD / 2;
+            break;
+        default:
+            pattern.period = 0;
+            break;
+    }
+    led_indicator_set_pattern(led, &pattern);
 }
 
 /*-----------------------------------------------------------------------------
  * Function: led_indicator_set_blink
  *
- * This function will set the LED indicator to blink
+ * This function will blink the LED indicator on top of its steady state.
+ * Blinks requested while the indicator is still blinking are added on.
  *
  * Parameters: led_indicator_t *led - pointer to the LED indicator
- *             uint32_t period - period of the blink
- *             uint16_t count - number of blinks
+ *             uint32_t period - time between toggles, TIM5 counts
+ *             uint16_t count - number of toggles
  *
  * Return: None
  *---------------------------------------------------------------------------*/
 void led_indicator_set_blink(led_indicator_t *led, uint32_t period, uint16_t count) {
+    led_pattern_t pattern = { .period = period * 2, .on_time = period, .priority = LED_PRIORITY_OVERLAY };
+
     if (count == 0) {
         count = 2;
     }
-    led->blink_period = period;
-    led->blink_counter += count;
-    led->last_update = TIM5->CNT;
-    led->state = LED_BLINK;
+    pattern.count = (count + 1) / 2; // Two toggles per cycle
+
+    taskENTER_CRITICAL();
+    if ((led->active & (1 << LED_PRIORITY_OVERLAY)) && led->layer[LED_PRIORITY_OVERLAY].period == pattern.period) {
+        led->remaining[LED_PRIORITY_OVERLAY] += pattern.count;
+        taskEXIT_CRITICAL();
+        return;
+    }
+    taskEXIT_CRITICAL();
+    led_indicator_set_pattern(led, &pattern);
 }
 
 /*-----------------------------------------------------------------------------
- * Function: led_indicator_update
+ * Function: led_indicator_isr
  *
- * This function will update the LED indicator
+ * TIM5 channel 1 compare interrupt: the next LED edge is due.
  *
- * Parameters: led_indicator_t *led - pointer to the LED indicator
- *             uint32_t time - current time
+ * Parameters: None
  *
  * Return: None
  *---------------------------------------------------------------------------*/
-void led_indicator_update(led_indicator_t *led, uint32_t time) {
-    if (led->state == LED_BLINK && led->blink_counter > 0) {
-        if (time - led->last_update >= led->blink_period) {
-            led->last_update = time;
-            HAL_GPIO_TogglePin(led->port, led->pin);
-            if (led->blink_counter > 0) {
-                led->blink_counter--;
-                if (led->blink_counter == 0) {
-                    led->state = LED_OFF;
-                    HAL_GPIO_WritePin(led->port, led->pin, GPIO_PIN_SET); // High turns off LED
-                }
-            }
-        }
-    }
-}
-
-void led_indicator_update_all(led_indicator_t *led[], uint8_t num_leds, uint32_t time) {
-    for (int i = 0; i < num_leds; i++) {
-        led_indicator_update(led[i], time);
-    }
+void led_indicator_isr(void) {
+    run_engine();
 }
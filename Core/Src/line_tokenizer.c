@@ -0,0 +1,156 @@
+/*
+ * line_tokenizer.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include <string.h>
+
+#include "line_tokenizer.h"
+
+/*-----------------------------------------------------------------------------
+ * Function: line_tokenizer_init
+ *
+ * Set up the line queue in the tokenizer's own storage and reset the state
+ * machine.
+ *
+ * Parameters: line_tokenizer_t *t - tokenizer to initialize
+ *             line_barrier_t is_barrier - recognises lines that may change
+ *                 the framing, or NULL
+ * Return: uint8_t - RING_BUFFER_OK or the ring_buffer_init error
+ *---------------------------------------------------------------------------*/
+uint8_t line_tokenizer_init(line_tokenizer_t *t, line_barrier_t is_barrier) {
+    t->current = NULL;
+    t->state = LINE_STATE_TEXT;
+    t->zero_delimited = false;
+    t->is_barrier = is_barrier;
+    t->held = false;
+    t->num_discarded = 0;
+    return ring_buffer_init(&t->lines, t->storage, LINE_QUEUE_SIZE, sizeof(command_line_t));
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: line_tokenizer_feed
+ *
+ * Run received bytes through the state machine. Each byte is looked at once
+ * and copied straight into the queue slot of the line it belongs to, so a
+ * command split across USB packets is simply continued by the next call.
+ * CR, LF and CRLF all end a line (0x00 in zero-delimited mode); empty lines
+ * are ignored.
+ *
+ * Stops early when the line queue is full. The caller keeps the remaining
+ * bytes and feeds them again once lines have been released.
+ *
+ * Also stops after a line is_barrier recognises, such as "@binary", and takes
+ * nothing more until every queued line has been released. The bytes after
+ * it are then framed the way the executed command left the tokenizer (see
+ * line_tokenizer_set_framing), even if the host sent them in the same packet.
+ *
+ * Parameters: line_tokenizer_t *t - tokenizer
+ *             const uint8_t *data - received bytes
+ *             uint16_t len - number of bytes
+ * Return: uint16_t - number of bytes consumed
+ *---------------------------------------------------------------------------*/
+uint16_t line_tokenizer_feed(line_tokenizer_t *t, const uint8_t *data, uint16_t len) {
+    command_line_t *line = t->current;
+    uint16_t n = 0;
+    uint8_t c;
+
+    if (t->held) {
+        if (!is_ring_buffer_empty(&t->lines)) {
+            return 0;
+        }
+        t->held = false;
+    }
+
+    while (n < len) {
+        if (line == NULL) {
+            line = ring_buffer_write_slot(&t->lines);
+            if (line == NULL) {
+                break;  // Queue full
+            }
+            line->len = 0;
+        }
+        c = data[n++];
+
+        if (c == '\n' && t->state == LINE_STATE_CR) {
+            t->state = LINE_STATE_TEXT;  // Second half of CRLF, also when "@binary\r\n" switched the framing
+            continue;
+        }
+        if (t->zero_delimited ? c == 0 : (c == '\r' || c == '\n')) {
+            if (t->state == LINE_STATE_DISCARD) {
+                t->num_discarded++;
+                line->len = 0;
+            } else if (line->len > 0) {
+                line->text[line->len] = '\0';
+                ring_buffer_commit(&t->lines, 1);
+                if (t->is_barrier != NULL && t->is_barrier(line, t->zero_delimited)) {
+                    t->held = true;
+                }
+                line = NULL;
+            }
+            t->state = (c == '\r' && !t->zero_delimited) ? LINE_STATE_CR : LINE_STATE_TEXT;
+            if (t->held) {
+                break;
+            }
+            continue;
+        }
+
+        if (t->state == LINE_STATE_DISCARD) {
+            continue;
+        }
+        t->state = LINE_STATE_TEXT;
+        if (line->len == LINE_MAX_LENGTH - 1) {
+            t->state = LINE_STATE_DISCARD;
+            continue;
+        }
+        line->text[line->len++] = c;
+    }
+
+    t->current = line;
+    return n;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: line_tokenizer_next
+ *
+ * Oldest complete line, left in the queue (and writable, e.g. for strtok)
+ * until line_tokenizer_release is called.
+ *
+ * Parameters: line_tokenizer_t *t - tokenizer
+ * Return: command_line_t* - the line, or NULL if none is complete
+ *---------------------------------------------------------------------------*/
+command_line_t* line_tokenizer_next(line_tokenizer_t *t) {
+    void *line;
+
+    if (ring_buffer_read_span(&t->lines, &line) == 0) {
+        return NULL;
+    }
+    return (command_line_t*) line;
+}
+
+void line_tokenizer_release(line_tokenizer_t *t) {
+    ring_buffer_consume(&t->lines, 1);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: line_tokenizer_set_framing
+ *
+ * Switch between CR/LF terminated lines and 0x00 terminated (COBS) frames.
+ * Lines already queued are not affected. An LF straight after the CR that
+ * ended the switching line still counts as its line ending; a host that ends
+ * "@binary" with a bare CR should send a 0x00 before its first frame.
+ *
+ * Parameters: line_tokenizer_t *t - tokenizer
+ *             bool zero_delimited - true for binary mode framing
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void line_tokenizer_set_framing(line_tokenizer_t *t, bool zero_delimited) {
+    if (t->zero_delimited != zero_delimited) {
+        t->zero_delimited = zero_delimited;
+        if (t->state != LINE_STATE_CR) {
+            t->state = LINE_STATE_TEXT;
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * link_monitor.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "link_monitor.h"
+
+static volatile console_mask_t link_level;          // Bit per console, pin level at the last edge
+static volatile console_mask_t link_bouncing;       // Bit per console with an edge not yet settled
+static volatile uint32_t last_edge[NUM_CONSOLE_PORTS];
+static console_mask_t link_reported;                // Debounced state last reported to the task
+static osThreadId_t notify_thread = NULL;           // Woken on every edge
+static uint32_t notify_flags;
+
+// An edge can be stamped after the task read the tick it passes in: count that as no time
+static inline uint32_t elapsed_since(uint32_t now, uint32_t then) {
+    return (int32_t) (now - then) > 0 ? now - then : 0;
+}
+
+void link_monitor_init(console_mask_t connected, uint32_t now) {
+    link_level = connected;
+    link_reported = connected;
+    link_bouncing = 0;
+    for (uint8_t i = 0; i < NUM_CONSOLE_PORTS; i++) {
+        last_edge[i] = now;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: link_monitor_edge
+ *
+ * Record an edge on a console's link pin. Called from the EXTI callback.
+ *
+ * Parameters: uint8_t console - front panel port
+ *             uint8_t connected - 1 if the link pin reads connected
+ *             uint32_t now - HAL_GetTick()
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void link_monitor_edge(uint8_t console, uint8_t connected, uint32_t now) {
+    if (console >= NUM_CONSOLE_PORTS) {
+        return;
+    }
+    if (connected) {
+        link_level |= 1UL << console;
+    } else {
+        link_level &= ~(1UL << console);
+    }
+    last_edge[console] = now;
+    link_bouncing |= 1UL << console;
+    if (notify_thread != NULL) {
+        osThreadFlagsSet(notify_thread, notify_flags);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: link_monitor_poll
+ *
+ * Report the consoles whose link has settled in a state different from the
+ * one last reported. A cable that bounced back to its previous state is not
+ * reported at all. Task context only.
+ *
+ * Parameters: uint32_t now - HAL_GetTick()
+ *             console_mask_t *connected - receives the debounced link state, bit per console
+ * Return: console_mask_t - bit per console whose link changed
+ *---------------------------------------------------------------------------*/
+console_mask_t link_monitor_poll(uint32_t now, console_mask_t *connected) {
+    console_mask_t changed = 0;
+
+    console_mask_t settled = 0;
+    console_mask_t level;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < NUM_CONSOLE_PORTS; i++) {
+        if ((link_bouncing & (1UL << i)) && elapsed_since(now, last_edge[i]) >= LINK_DEBOUNCE_MS) {
+            settled |= 1UL << i;
+        }
+    }
+    link_bouncing &= ~settled;
+    level = link_level;
+    taskEXIT_CRITICAL();
+
+    changed = (level ^ link_reported) & settled;
+    link_reported ^= changed;
+    *connected = link_reported;
+    return changed;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: link_monitor_time_to_settle
+ *
+ * Time until the next pin that is still bouncing settles, i.e. until
+ * link_monitor_poll may report a change.
+ *
+ * Parameters: uint32_t now - HAL_GetTick()
+ * Return: uint32_t - milliseconds, osWaitForever if no pin is bouncing
+ *---------------------------------------------------------------------------*/
+uint32_t link_monitor_time_to_settle(uint32_t now) {
+    uint32_t wait = osWaitForever;
+    uint32_t elapsed;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < NUM_CONSOLE_PORTS; i++) {
+        if (link_bouncing & (1UL << i)) {
+            elapsed = elapsed_since(now, last_edge[i]);
+            if (elapsed >= LINK_DEBOUNCE_MS) {
+                wait = 0;
+            } else if (LINK_DEBOUNCE_MS - elapsed < wait) {
+                wait = LINK_DEBOUNCE_MS - elapsed;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+    return wait;
+}
+
+void link_monitor_set_notify(osThreadId_t thread, uint32_t flags) {
+    notify_flags = flags;
+    notify_thread = thread;
+}
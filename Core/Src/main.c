@@ -31,10 +31,15 @@
 #include "usbd_cdc_if.h"
 #include "scoreboard.h"
 #include "led_indicator.h"
+#include "link_monitor.h"
+#include "usb_tx.h"
+#include "memory_config.h"
+#include "ram_budget.h"
 
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
+typedef StaticTask_t osStaticThreadDef_t;
 /* USER CODE BEGIN PTD */
 
 /* USER CODE END PTD */
@@ -51,6 +56,7 @@
 
 /* Private variables ---------------------------------------------------------*/
 I2C_HandleTypeDef hi2c1;
+I2C_HandleTypeDef hi2c3;
 
 RTC_HandleTypeDef hrtc;
 
@@ -61,22 +67,23 @@ TIM_HandleTypeDef htim5;
 
 /* Definitions for defaultTask */
 osThreadId_t defaultTaskHandle;
-const osThreadAttr_t defaultTask_attributes = { .name = "defaultTask", .stack_size = 512 * 4, .priority =
-        (osPriority_t) osPriorityNormal, };
-/* Definitions for heartbeatTask */
-osThreadId_t heartbeatTaskHandle;
-const osThreadAttr_t heartbeatTask_attributes = { .name = "heartbeatTask", .stack_size = 128 * 4, .priority =
-        (osPriority_t) osPriorityAboveNormal, };
-/* Definitions for rj45LEDTask */
-osThreadId_t rj45LEDTaskHandle;
-const osThreadAttr_t rj45LEDTask_attributes = { .name = "rj45LEDTask", .stack_size = 128 * 4, .priority =
-        (osPriority_t) osPriorityHigh, };
+uint32_t defaultTaskBuffer[384];
+osStaticThreadDef_t defaultTaskControlBlock;
+const osThreadAttr_t defaultTask_attributes = { .name = "defaultTask", .cb_mem = &defaultTaskControlBlock, .cb_size =
+        sizeof(defaultTaskControlBlock), .stack_mem = &defaultTaskBuffer[0], .stack_size = sizeof(defaultTaskBuffer),
+        .priority = (osPriority_t) osPriorityNormal, };
 /* USER CODE BEGIN PV */
 ring_buffer_t rx_buffer;
-led_indicator_t console_indicator[MAX_NUM_CONSOLES];
+static cdc_rx_packet_t rx_packets[CDC_RX_NUM_BANKS];
+_Static_assert(sizeof(defaultTaskBuffer) == COMMAND_TASK_STACK_WORDS * 4, "defaultTask stack in the .ioc differs from memory_config.h");
+const uint32_t command_task_ram_bytes = sizeof(defaultTaskBuffer) + sizeof(defaultTaskControlBlock);
+const uint32_t usb_rx_ram_bytes = sizeof(rx_packets);
+led_indicator_t console_indicator[NUM_CONSOLE_PORTS];
 led_indicator_t serial_indicator;
-uint8_t delta_link = 0;
-uint8_t link_status[MAX_NUM_CONSOLES] = { 0 };
+led_indicator_t heartbeat_indicator;
+static const led_pattern_t heartbeat_pattern = { .period = 2 * HEARTBEAT_PERIOD_MS * LED_TICKS_PER_MS, .on_time =
+        HEARTBEAT_PERIOD_MS * LED_TICKS_PER_MS, .count = LED_FOREVER, .priority = LED_PRIORITY_BASE };
+uint8_t link_status[NUM_CONSOLE_PORTS] = { 0 };
 
 /* USER CODE END PV */
 
@@ -88,9 +95,8 @@ static void MX_RTC_Init(void);
 static void MX_SPI1_Init(void);
 static void MX_TIM5_Init(void);
 static void MX_TIM2_Init(void);
+static void MX_I2C3_Init(void);
 void StartDefaultTask(void *argument);
-void StartHeartbeat(void *argument);
-void StartRj45LED(void *argument);
 
 /* USER CODE BEGIN PFP */
 
@@ -133,15 +139,33 @@ int main(void) {
     MX_SPI1_Init();
     MX_TIM5_Init();
     MX_TIM2_Init();
+    MX_I2C3_Init();
     /* USER CODE BEGIN 2 */
     HAL_TIM_Base_Start(&htim2);
     HAL_TIM_Base_Start(&htim5);
 
+    // Queue of filled USB OUT banks, must exist before the USB device is started
+    if (ring_buffer_init(&rx_buffer, rx_packets, CDC_RX_NUM_BANKS, sizeof(cdc_rx_packet_t)) != RING_BUFFER_OK) {
+        Error_Handler();
+    }
+
     link_status[0] = !HAL_GPIO_ReadPin(LINK1_GPIO_Port, LINK1_Pin);
     link_status[1] = !HAL_GPIO_ReadPin(LINK2_GPIO_Port, LINK2_Pin);
     link_status[2] = !HAL_GPIO_ReadPin(LINK3_GPIO_Port, LINK3_Pin);
     link_status[3] = !HAL_GPIO_ReadPin(LINK4_GPIO_Port, LINK4_Pin);
     link_status[4] = !HAL_GPIO_ReadPin(LINK5_GPIO_Port, LINK5_Pin);
+
+    led_indicator_init(&console_indicator[0], I2C_LED1_GPIO_Port, I2C_LED1_Pin);
+    led_indicator_init(&console_indicator[1], I2C_LED2_GPIO_Port, I2C_LED2_Pin);
+    led_indicator_init(&console_indicator[2], I2C_LED3_GPIO_Port, I2C_LED3_Pin);
+    led_indicator_init(&console_indicator[3], I2C_LED4_GPIO_Port, I2C_LED4_Pin);
+    led_indicator_init(&console_indicator[4], I2C_LED5_GPIO_Port, I2C_LED5_Pin);
+    for (int i = 0; i < NUM_CONSOLE_PORTS; i++) {
+        led_indicator_set_blink(&console_indicator[i], 400, 10);
+    }
+
+    led_indicator_init(&heartbeat_indicator, LED_HB_GPIO_Port, LED_HB_Pin);
+    led_indicator_set_pattern(&heartbeat_indicator, &heartbeat_pattern);
     /* USER CODE END 2 */
 
     /* Init scheduler */
@@ -167,13 +191,8 @@ int main(void) {
     /* creation of defaultTask */
     defaultTaskHandle = osThreadNew(StartDefaultTask, NULL, &defaultTask_attributes);
 
-    /* creation of heartbeatTask */
-    heartbeatTaskHandle = osThreadNew(StartHeartbeat, NULL, &heartbeatTask_attributes);
-
-    /* creation of rj45LEDTask */
-    rj45LEDTaskHandle = osThreadNew(StartRj45LED, NULL, &rj45LEDTask_attributes);
-
     /* USER CODE BEGIN RTOS_THREADS */
+    usb_tx_init();
     /* add threads, ... */
     /* USER CODE END RTOS_THREADS */
 
@@ -277,6 +296,38 @@ static void MX_I2C1_Init(void) {
 
 }
 
+/**
+ * @brief I2C3 Initialization Function
+ * @param None
+ * @retval None
+ */
+static void MX_I2C3_Init(void) {
+
+    /* USER CODE BEGIN I2C3_Init 0 */
+
+    /* USER CODE END I2C3_Init 0 */
+
+    /* USER CODE BEGIN I2C3_Init 1 */
+
+    /* USER CODE END I2C3_Init 1 */
+    hi2c3.Instance = I2C3;
+    hi2c3.Init.ClockSpeed = 100000;
+    hi2c3.Init.DutyCycle = I2C_DUTYCYCLE_2;
+    hi2c3.Init.OwnAddress1 = 0;
+    hi2c3.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+    hi2c3.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+    hi2c3.Init.OwnAddress2 = 0;
+    hi2c3.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+    hi2c3.Init.NoStretchMode = I2C_NOSTRETCH_ENABLE;
+    if (HAL_I2C_Init(&hi2c3) != HAL_OK) {
+        Error_Handler();
+    }
+    /* USER CODE BEGIN I2C3_Init 2 */
+
+    /* USER CODE END I2C3_Init 2 */
+
+}
+
 /**
  * @brief RTC Initialization Function
  * @param None
@@ -449,7 +500,16 @@ static void MX_TIM5_Init(void) {
         Error_Handler();
     }
     /* USER CODE BEGIN TIM5_Init 2 */
-
+    // Channel 1 compare, without an output, paces the LED engine (led_indicator.c)
+    TIM_OC_InitTypeDef sConfigOC = { 0 };
+
+    sConfigOC.OCMode = TIM_OCMODE_TIMING;
+    sConfigOC.Pulse = 0;
+    sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+    sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+    if (HAL_TIM_OC_ConfigChannel(&htim5, &sConfigOC, TIM_CHANNEL_1) != HAL_OK) {
+        Error_Handler();
+    }
     /* USER CODE END TIM5_Init 2 */
 
 }
@@ -568,27 +628,42 @@ static void MX_GPIO_Init(void) {
 }
 
 /* USER CODE BEGIN 4 */
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim) {
+    if (htim->Instance == TIM5 && htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1) {
+        led_indicator_isr(); // Next LED edge is due
+    }
+}
+
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    uint8_t console;
+
     switch (GPIO_Pin) {
         case LINK1_Pin:
+            console = 0;
             link_status[0] = !HAL_GPIO_ReadPin(LINK1_GPIO_Port, LINK1_Pin);
             break;
         case LINK2_Pin:
+            console = 1;
             link_status[1] = !HAL_GPIO_ReadPin(LINK2_GPIO_Port, LINK2_Pin);
             break;
         case LINK3_Pin:
+            console = 2;
             link_status[2] = !HAL_GPIO_ReadPin(LINK3_GPIO_Port, LINK3_Pin);
             break;
         case LINK4_Pin:
+            console = 3;
             link_status[3] = !HAL_GPIO_ReadPin(LINK4_GPIO_Port, LINK4_Pin);
             break;
         case LINK5_Pin:
+            console = 4;
             link_status[4] = !HAL_GPIO_ReadPin(LINK5_GPIO_Port, LINK5_Pin);
             break;
         default:
             __NOP();
-            break;
+            return;
     }
+    // The poller task re-probes the console once its link pin has settled
+    link_monitor_edge(console, link_status[console], HAL_GetTick());
 }
 
 /* USER CODE END 4 */
@@ -614,59 +689,6 @@ void StartDefaultTask(void *argument) {
     /* USER CODE END 5 */
 }
 
-/* USER CODE BEGIN Header_StartHeartbeat */
-/**
- * @brief Function implementing the heartbeatTask thread.
- * @param argument: Not used
- * @retval None
- */
-/* USER CODE END Header_StartHeartbeat */
-void StartHeartbeat(void *argument) {
-    /* USER CODE BEGIN StartHeartbeat */
-    /* Infinite loop */
-    for (;;) {
-        for (;;) {
-            HAL_GPIO_TogglePin(LED_HB_GPIO_Port, LED_HB_Pin);
-            osDelay(500);
-        }
-    }
-    /* USER CODE END StartHeartbeat */
-}
-
-/* USER CODE BEGIN Header_StartRj45LED */
-/**
- * @brief Function implementing the rj45LEDTask thread.
- * @param argument: Not used
- * @retval None
- */
-/* USER CODE END Header_StartRj45LED */
-void StartRj45LED(void *argument) {
-    /* USER CODE BEGIN StartRj45LED */
-    led_indicator_init(&console_indicator[0], I2C_LED1_GPIO_Port, I2C_LED1_Pin);
-    led_indicator_set_blink(&console_indicator[0], 400, 10);
-    led_indicator_init(&console_indicator[1], I2C_LED2_GPIO_Port, I2C_LED2_Pin);
-    led_indicator_set_blink(&console_indicator[1], 400, 10);
-    led_indicator_init(&console_indicator[2], I2C_LED3_GPIO_Port, I2C_LED3_Pin);
-    led_indicator_set_blink(&console_indicator[2], 400, 10);
-    led_indicator_init(&console_indicator[3], I2C_LED4_GPIO_Port, I2C_LED4_Pin);
-    led_indicator_set_blink(&console_indicator[3], 400, 10);
-    led_indicator_init(&console_indicator[4], I2C_LED5_GPIO_Port, I2C_LED5_Pin);
-    led_indicator_set_blink(&console_indicator[4], 400, 10);
-
-    //    for (int i = 0; i < MAX_NUM_CONSOLES; i++) {
-    //        led_indicator_init(&LED_indicator[i], GPIOB, GPIO_PIN_0);
-    //    }
-
-    /* Infinite loop */
-    for (;;) {
-        for (int i = 0; i < MAX_NUM_CONSOLES; i++) {
-            led_indicator_update(&console_indicator[i], TIM5->CNT);
-        }
-        osDelay(5);
-    }
-    /* USER CODE END StartRj45LED */
-}
-
 /**
  * @brief  Period elapsed callback in non blocking mode
  * @note   This function is called  when TIM4 interrupt took place, inside
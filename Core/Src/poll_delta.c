@@ -0,0 +1,286 @@
+/*
+ * poll_delta.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "poll_delta.h"
+#include "stream_writer.h"
+#include "binary_protocol.h"
+#include "ui.h"
+
+#define DELTA_ENTRIES_PER_RECORD ((BINARY_MAX_PAYLOAD - sizeof(binary_delta_header_t)) / sizeof(binary_delta_entry_t))
+
+typedef struct {
+    const char *name;
+    uint8_t offset;
+    uint8_t size;
+    uint8_t in_stats;  // 0 = score_t, 1 = stats_t
+    field_kind_t kind;
+} field_desc_t;
+
+#define IN_STATS_score 0
+#define IN_STATS_stats 1
+#define POLL_FIELD_DESC(token, name, source, member, kind) \
+    [token] = { name, offsetof(source##_t, member), sizeof(((source##_t*) 0)->member), IN_STATS_##source, kind },
+
+static const field_desc_t fields[NUM_POLL_FIELDS] = { POLL_FIELD_TABLE(POLL_FIELD_DESC) };
+
+// Last state sent to the host
+static struct {
+    score_t scores[MAX_NUM_CONSOLES];
+    stats_t stats[MAX_NUM_CONSOLES];
+    uint8_t tournament_mode;
+    mode_t mode;             // Output mode the state was published in
+    uint32_t seq;            // Sequence number of the last update
+    uint32_t keyframe_time;  // HAL_GetTick() of the last keyframe
+    bool keyframe_pending;
+} published = { .keyframe_pending = true };
+
+/*-----------------------------------------------------------------------------
+ * Function: field_value
+ *
+ * Read one field of a console as a number. Initials are packed into the low
+ * three bytes, first letter in the low byte.
+ *
+ * Parameters: poll_field_t field - field to read
+ *             const score_t *score - console scores
+ *             const stats_t *stats - console stats
+ * Return: uint32_t - value of the field
+ *---------------------------------------------------------------------------*/
+static uint32_t field_value(poll_field_t field, const score_t *score, const stats_t *stats) {
+    const field_desc_t *desc = &fields[field];
+    const uint8_t *p = (desc->in_stats ? (const uint8_t*) stats : (const uint8_t*) score) + desc->offset;
+
+    if (desc->kind == FIELD_TEXT) {
+        return p[0] | (p[1] << 8) | ((uint32_t) p[2] << 16);
+    }
+    switch (desc->size) {
+        case 1:
+            return *p;
+        case 2:
+            return *(const uint16_t*) p;
+        default:
+            return *(const uint32_t*) p;
+    }
+}
+
+static uint32_t changed_fields(uint8_t i, const scoreboard_t *s, bool keyframe) {
+    uint32_t mask = 0;
+
+    if (!s->scores[i].is_connected) {
+        // A disconnected console only reports that it went away
+        if (!keyframe && published.scores[i].is_connected) {
+            mask = 1UL << FIELD_IS_CONNECTED;
+        }
+        return mask;
+    }
+    for (uint8_t f = 0; f < NUM_POLL_FIELDS; f++) {
+        if (keyframe || field_value(f, &s->scores[i], &s->stats[i])
+                != field_value(f, &published.scores[i], &published.stats[i])) {
+            mask |= 1UL << f;
+        }
+    }
+    return mask;
+}
+
+static void write_value(stream_writer_t *w, poll_field_t f, uint32_t value) {
+    if (fields[f].kind == FIELD_TEXT) {
+        for (uint8_t k = 0; k < 3 && (value & 0xFF) != 0; k++, value >>= 8) {
+            sw_putc(w, value & 0xFF);
+        }
+    } else {
+        sw_uint(w, value);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: write_text_update
+ *
+ * Stream one update in the current text mode:
+ *
+ *   Scoreboard: {"seq": 7, "keyframe": 0, "tournament_mode": 0,
+ *                "consoles":[{"console_id":2, "score1": 130, "apples1": 7}]}
+ *   PC console: DELTA<tab>seq<tab>keyframe<tab>tournament_mode<tab>lines, then one
+ *               "CONSOLE id<tab>name=value..." line per changed console
+ *   Terminal:   the same as the PC console in a readable layout
+ *
+ * Parameters: scoreboard_t *s - pointer to the scoreboard
+ *             const uint32_t *masks - changed fields per console
+ *             uint8_t num_changed - number of consoles with changes
+ *             bool keyframe - true if this is a keyframe
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void write_text_update(scoreboard_t *s, const uint32_t *masks, uint8_t num_changed, bool keyframe) {
+    stream_writer_t w;
+    bool first = true;
+
+    sw_begin(&w, s, s->mode);
+    if (s->mode == SCOREBOARD_MODE) {
+        sw_puts(&w, "{\"seq\": ");
+        sw_uint(&w, published.seq);
+        sw_puts(&w, keyframe ? ", \"keyframe\": 1" : ", \"keyframe\": 0");
+        sw_puts(&w, ", \"tournament_mode\": ");
+        sw_uint(&w, s->is_tournament_mode);
+        sw_puts(&w, ", \"consoles\":[");
+    } else if (s->mode == PC_CONSOLE_MODE) {
+        sw_puts(&w, "DELTA\t");
+        sw_uint(&w, published.seq);
+        sw_putc(&w, '\t');
+        sw_uint(&w, keyframe);
+        sw_putc(&w, '\t');
+        sw_uint(&w, s->is_tournament_mode);
+        sw_putc(&w, '\t');
+        sw_uint(&w, num_changed);
+        sw_putc(&w, '\n');
+    } else {
+        sw_puts(&w, keyframe ? "\r\nKeyframe " : "\r\nUpdate ");
+        sw_uint(&w, published.seq);
+        sw_puts(&w, ", tournament: ");
+        sw_uint(&w, s->is_tournament_mode);
+        sw_puts(&w, "\r\n");
+    }
+
+    for (uint8_t i = 0; i < s->num_consoles; i++) {
+        if (masks[i] == 0) {
+            continue;
+        }
+        if (s->mode == SCOREBOARD_MODE) {
+            sw_puts(&w, first ? "{\"console_id\":" : ",{\"console_id\":");
+        } else {
+            sw_puts(&w, s->mode == PC_CONSOLE_MODE ? "CONSOLE " : "Console ");
+        }
+        sw_uint(&w, s->scores[i].console_id);
+        first = false;
+        for (uint8_t f = 0; f < NUM_POLL_FIELDS; f++) {
+            if ((masks[i] & (1UL << f)) == 0) {
+                continue;
+            }
+            if (s->mode == SCOREBOARD_MODE) {
+                sw_puts(&w, ", \"");
+                sw_puts(&w, fields[f].name);
+                sw_puts(&w, fields[f].kind == FIELD_TEXT ? "\": \"" : "\": ");
+                write_value(&w, f, field_value(f, &s->scores[i], &s->stats[i]));
+                if (fields[f].kind == FIELD_TEXT) {
+                    sw_putc(&w, '"');
+                }
+            } else {
+                sw_putc(&w, s->mode == PC_CONSOLE_MODE ? '\t' : ' ');
+                sw_puts(&w, fields[f].name);
+                sw_putc(&w, '=');
+                write_value(&w, f, field_value(f, &s->scores[i], &s->stats[i]));
+            }
+        }
+        if (s->mode == SCOREBOARD_MODE) {
+            sw_putc(&w, '}');
+        } else {
+            sw_puts(&w, s->mode == PC_CONSOLE_MODE ? "\n" : "\r\n");
+        }
+    }
+    if (s->mode == SCOREBOARD_MODE) {
+        sw_puts(&w, "]}\r\n");
+    }
+    sw_flush(&w);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: write_binary_update
+ *
+ * Send one update as BINARY_RECORD_DELTA records. An update that does not
+ * fit into one record is split; every record takes its own sequence number
+ * and only the first record of a keyframe has BINARY_DELTA_KEYFRAME set.
+ *
+ * Parameters: scoreboard_t *s - pointer to the scoreboard
+ *             const uint32_t *masks - changed fields per console
+ *             bool keyframe - true if this is a keyframe
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void write_binary_update(scoreboard_t *s, const uint32_t *masks, bool keyframe) {
+    uint8_t record[BINARY_MAX_PAYLOAD];
+    binary_delta_header_t *header = (binary_delta_header_t*) record;
+    binary_delta_entry_t *entries = (binary_delta_entry_t*) &record[sizeof(binary_delta_header_t)];
+    uint8_t num_entries = 0;
+
+    header->seq = published.seq;
+    header->flags = keyframe ? BINARY_DELTA_KEYFRAME : 0;
+    header->tournament_mode = s->is_tournament_mode;
+    for (uint8_t i = 0; i < s->num_consoles; i++) {
+        for (uint8_t f = 0; f < NUM_POLL_FIELDS; f++) {
+            if ((masks[i] & (1UL << f)) == 0) {
+                continue;
+            }
+            if (num_entries == DELTA_ENTRIES_PER_RECORD) {
+                print_binary(s, BINARY_RECORD_DELTA, record,
+                        sizeof(binary_delta_header_t) + sizeof(entries[0]) * num_entries);
+                num_entries = 0;
+                header->seq = ++published.seq;
+                header->flags = 0;
+            }
+            entries[num_entries].console_id = s->scores[i].console_id;
+            entries[num_entries].field = f;
+            entries[num_entries].value = field_value(f, &s->scores[i], &s->stats[i]);
+            num_entries++;
+        }
+    }
+    print_binary(s, BINARY_RECORD_DELTA, record, sizeof(binary_delta_header_t) + sizeof(entries[0]) * num_entries);
+}
+
+void poll_delta_reset(void) {
+    published.seq = 0;
+    published.keyframe_pending = true;
+}
+
+void poll_delta_request_keyframe(void) {
+    published.keyframe_pending = true;
+}
+
+uint32_t poll_delta_get_seq(void) {
+    return published.seq;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: poll_delta_publish
+ *
+ * Send the fields that changed since the last update, or a keyframe if one
+ * was requested, the output mode changed or POLL_KEYFRAME_INTERVAL_MS has
+ * passed. Nothing is sent when nothing changed.
+ *
+ * Parameters: scoreboard_t *s - pointer to the scoreboard
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void poll_delta_publish(scoreboard_t *s) {
+    uint32_t masks[MAX_NUM_CONSOLES];
+    uint8_t num_changed = 0;
+    bool keyframe = published.keyframe_pending || published.mode != s->mode
+            || HAL_GetTick() - published.keyframe_time >= POLL_KEYFRAME_INTERVAL_MS;
+
+    for (uint8_t i = 0; i < s->num_consoles; i++) {
+        masks[i] = changed_fields(i, s, keyframe);
+        if (masks[i] != 0) {
+            num_changed++;
+        }
+    }
+    if (!keyframe && num_changed == 0 && published.tournament_mode == s->is_tournament_mode) {
+        return;
+    }
+
+    published.seq++;
+    if (s->mode == BINARY_MODE) {
+        write_binary_update(s, masks, keyframe);
+    } else {
+        write_text_update(s, masks, num_changed, keyframe);
+    }
+
+    memcpy(published.scores, s->scores, sizeof(published.scores));
+    memcpy(published.stats, s->stats, sizeof(published.stats));
+    published.tournament_mode = s->is_tournament_mode;
+    published.mode = s->mode;
+    if (keyframe) {
+        published.keyframe_pending = false;
+        published.keyframe_time = HAL_GetTick();
+    }
+}
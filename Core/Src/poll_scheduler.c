@@ -0,0 +1,141 @@
+/*
+ * poll_scheduler.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include "poll_scheduler.h"
+#include "ram_budget.h"
+
+typedef struct {
+    uint32_t next_poll;     // HAL_GetTick() at which the console is due
+    uint32_t boost_until;   // Boosted interval applies until this time
+    uint32_t window_start;
+    uint16_t window_count;  // Polls completed in the current rate window
+    poll_rate_t rate;
+} console_schedule_t;
+
+static console_schedule_t schedule[MAX_NUM_CONSOLES];
+
+const uint32_t poll_scheduler_ram_bytes = sizeof(schedule);
+
+// Signed difference so the comparisons survive HAL_GetTick() wrapping
+static inline bool time_reached(uint32_t now, uint32_t deadline) {
+    return (int32_t) (now - deadline) >= 0;
+}
+
+void poll_scheduler_init(uint32_t now) {
+    for (uint8_t i = 0; i < MAX_NUM_CONSOLES; i++) {
+        schedule[i].next_poll = now;
+        schedule[i].boost_until = now;
+        schedule[i].window_start = now;
+        schedule[i].window_count = 0;
+        schedule[i].rate.interval_ms = POLL_INTERVAL_IDLE_MS;
+        schedule[i].rate.window_polls = 0;
+        schedule[i].rate.num_polls = 0;
+    }
+}
+
+bool poll_scheduler_is_due(uint8_t console, uint32_t now) {
+    return time_reached(now, schedule[console].next_poll);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: poll_scheduler_time_to_due
+ *
+ * Time until the first of a set of consoles is due.
+ *
+ * Parameters: console_mask_t consoles - bit per console to consider
+ *             uint32_t now - HAL_GetTick()
+ * Return: uint32_t - milliseconds, 0 if one is due, UINT32_MAX if the set is empty
+ *---------------------------------------------------------------------------*/
+uint32_t poll_scheduler_time_to_due(console_mask_t consoles, uint32_t now) {
+    uint32_t wait = UINT32_MAX;
+
+    for (uint8_t i = 0; i < MAX_NUM_CONSOLES; i++) {
+        if (consoles & (1UL << i)) {
+            if (time_reached(now, schedule[i].next_poll)) {
+                return 0;
+            }
+            if (schedule[i].next_poll - now < wait) {
+                wait = schedule[i].next_poll - now;
+            }
+        }
+    }
+    return wait;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: poll_scheduler_started
+ *
+ * Record that a poll was queued. The next one is due one interval after the
+ * start of this one, so the rate does not drift with the bus latency.
+ *
+ * Parameters: uint8_t console - console slot
+ *             uint32_t now - HAL_GetTick()
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void poll_scheduler_started(uint8_t console, uint32_t now) {
+    schedule[console].next_poll = now + schedule[console].rate.interval_ms;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: poll_scheduler_completed
+ *
+ * Pick the next interval from the game state just read: fast while running
+ * (status 1), otherwise doubling from POLL_INTERVAL_IDLE_MS up to
+ * POLL_INTERVAL_MAX_MS. A boost overrides both until it expires.
+ *
+ * Parameters: uint8_t console - console slot
+ *             uint8_t game_status - 0 stopped, 1 running, 2 paused, 3 game over
+ *             uint32_t now - HAL_GetTick()
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void poll_scheduler_completed(uint8_t console, uint8_t game_status, uint32_t now) {
+    console_schedule_t *c = &schedule[console];
+    uint16_t interval = c->rate.interval_ms;
+
+    if (!time_reached(now, c->boost_until)) {
+        interval = POLL_INTERVAL_BOOST_MS;
+    } else if (game_status == 1) {
+        interval = POLL_INTERVAL_PLAYING_MS;
+    } else if (interval < POLL_INTERVAL_IDLE_MS) {
+        interval = POLL_INTERVAL_IDLE_MS;
+    } else if (interval < POLL_INTERVAL_MAX_MS) {
+        interval = (interval * 2 > POLL_INTERVAL_MAX_MS) ? POLL_INTERVAL_MAX_MS : interval * 2;
+    }
+    if (interval < c->rate.interval_ms) {
+        // Speeding up: do not wait out the rest of the long interval
+        c->next_poll = now + interval;
+    }
+    c->rate.interval_ms = interval;
+
+    c->rate.num_polls++;
+    c->window_count++;
+    if (now - c->window_start >= POLL_RATE_WINDOW_MS) {
+        c->rate.window_polls = c->window_count;
+        c->window_count = 0;
+        c->window_start = now;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: poll_scheduler_boost
+ *
+ * Poll a console right away and then at POLL_INTERVAL_BOOST_MS for
+ * POLL_BOOST_DURATION_MS, e.g. after a command was sent to it.
+ *
+ * Parameters: uint8_t console - console slot
+ *             uint32_t now - HAL_GetTick()
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void poll_scheduler_boost(uint8_t console, uint32_t now) {
+    schedule[console].boost_until = now + POLL_BOOST_DURATION_MS;
+    schedule[console].next_poll = now;
+    schedule[console].rate.interval_ms = POLL_INTERVAL_BOOST_MS;
+}
+
+void poll_scheduler_get_rate(uint8_t console, poll_rate_t *rate) {
+    *rate = schedule[console].rate;
+}
@@ -0,0 +1,30 @@
+/*
+ * ram_budget.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include "ram_budget.h"
+
+#define RAM_BUDGET_ENTRY(owner, subsystem) { subsystem, &owner##_ram_bytes },
+
+const ram_budget_entry_t ram_budget[] = { RAM_BUDGET(RAM_BUDGET_ENTRY) };
+const uint8_t ram_budget_count = sizeof(ram_budget) / sizeof(ram_budget[0]);
+
+/*-----------------------------------------------------------------------------
+ * Function: ram_budget_total
+ *
+ * Sum of the RAM map, to compare with RAM_BUDGET_LIMIT (memory_config.h).
+ *
+ * Parameters: None
+ * Return: uint32_t - statically allocated bytes
+ *---------------------------------------------------------------------------*/
+uint32_t ram_budget_total(void) {
+    uint32_t total = 0;
+
+    for (uint8_t i = 0; i < ram_budget_count; i++) {
+        total += *ram_budget[i].bytes;
+    }
+    return total;
+}
@@ -0,0 +1,101 @@
+/*
+ * register_map.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include <stddef.h>
+
+#include "register_map.h"
+
+// Byte arrays have no padding, so each member lands where REGISTER_MAP must say it is
+#define REGISTER_LAYOUT(member, reg, type, access) uint8_t member[type##_SIZE];
+#define REGISTER_CHECK(member, reg, type, access) \
+    _Static_assert(offsetof(register_layout_t, member) == (reg), "REGISTER_MAP: " #member " has a gap or overlap");
+
+typedef struct {
+    REGISTER_MAP(REGISTER_LAYOUT)
+} register_layout_t;
+
+REGISTER_MAP(REGISTER_CHECK)
+
+// One field, per register type
+#define ENCODE_REG_TYPE_U8(member, reg)    reg[REG_ADDR_##member] = data->member;
+#define ENCODE_REG_TYPE_U16(member, reg)   store_be16(&reg[REG_ADDR_##member], data->member);
+#define ENCODE_REG_TYPE_U32(member, reg)   store_be32(&reg[REG_ADDR_##member], data->member);
+#define ENCODE_REG_TYPE_TEXT3(member, reg) memcpy(&reg[REG_ADDR_##member], data->member, 3);
+#define DECODE_REG_TYPE_U8(member, reg)    data->member = reg[REG_ADDR_##member];
+#define DECODE_REG_TYPE_U16(member, reg)   data->member = load_be16(&reg[REG_ADDR_##member]);
+#define DECODE_REG_TYPE_U32(member, reg)   data->member = load_be32(&reg[REG_ADDR_##member]);
+#define DECODE_REG_TYPE_TEXT3(member, reg) memcpy(data->member, &reg[REG_ADDR_##member], 3);
+
+#define REGISTER_ENCODE(member, addr, type, access) ENCODE_##type(member, reg)
+#define REGISTER_DECODE(member, addr, type, access) \
+    if (access == REG_READ) { \
+        DECODE_##type(member, reg) \
+    }
+#define REGISTER_DECODE_RANGE(member, addr, type, access) \
+    if (access == REG_READ && (addr) >= first && (addr) + type##_SIZE <= end) { \
+        DECODE_##type(member, reg) \
+    }
+// Entered at the case of the first register, falls through until a register ends past end
+#define REGISTER_DECODE_FROM(member, addr, type, access) \
+    case addr: \
+        if ((addr) + type##_SIZE > end) { \
+            break; \
+        } \
+        if (access == REG_READ) { \
+            DECODE_##type(member, reg) \
+        }
+
+/*-----------------------------------------------------------------------------
+ * Function: register_encode
+ *
+ * Encode every register, including the ones written by the master.
+ *
+ * Parameters: const i2c_scoreboard_t *data - register values
+ *             uint8_t reg[] - register image, REGISTERS_SIZE bytes
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void register_encode(const i2c_scoreboard_t *data, uint8_t reg[]) {
+    REGISTER_MAP(REGISTER_ENCODE)
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: register_decode
+ *
+ * Decode the registers written by the console. The REG_WRITE registers are
+ * left as they are.
+ *
+ * Parameters: const uint8_t reg[] - register image, REGISTERS_SIZE bytes
+ *             i2c_scoreboard_t *data - receives the register values
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void register_decode(const uint8_t reg[], i2c_scoreboard_t *data) {
+    REGISTER_MAP(REGISTER_DECODE)
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: register_decode_range
+ *
+ * Decode the console registers that lie entirely within [first, end), e.g.
+ * the block a partial read returned. Other fields are left as they are.
+ * A range that starts on a register boundary (all reads issued by the
+ * scoreboard do) costs one compare per decoded register.
+ *
+ * Parameters: const uint8_t reg[] - register image, REGISTERS_SIZE bytes
+ *             i2c_scoreboard_t *data - receives the register values
+ *             uint8_t first - first register
+ *             uint8_t end - one past the last register
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void register_decode_range(const uint8_t reg[], i2c_scoreboard_t *data, uint8_t first, uint8_t end) {
+    switch (first) {
+        REGISTER_MAP(REGISTER_DECODE_FROM)
+        break;
+    default:
+        REGISTER_MAP(REGISTER_DECODE_RANGE)
+        break;
+    }
+}
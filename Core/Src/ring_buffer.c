@@ -7,70 +7,81 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include <stdlib.h>
 #include <string.h>
 
 #include "ring_buffer.h"
 
-uint8_t ring_buffer_init(ring_buffer_t *buffer, uint16_t buffer_size, size_t data_size) {
-    buffer->data = malloc((size_t) buffer_size * data_size);
-    if (buffer->data == NULL) {
-        return RING_BUFFER_MALLOC_FAILED;
+// The index published by one side must not become visible before the element
+// data it covers (release), and must be read before touching that data (acquire).
+#define LOAD_ACQUIRE(x)         __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(x, value) __atomic_store_n(&(x), (value), __ATOMIC_RELEASE)
+
+static inline uint8_t* slot(const ring_buffer_t *buffer, uint16_t index) {
+    return (uint8_t*) buffer->data + (size_t) (index & buffer->mask) * buffer->size;
+}
+
+uint8_t ring_buffer_init(ring_buffer_t *buffer, void *storage, uint16_t buffer_size, size_t data_size) {
+    if (storage == NULL || buffer_size == 0 || buffer_size > 0x8000 || (buffer_size & (buffer_size - 1)) != 0) {
+        return RING_BUFFER_ERROR;
     }
+    buffer->data = storage;
     memset(buffer->data, 0, buffer_size * data_size);
     buffer->size = data_size;
     buffer->buffer_size = buffer_size;
-    buffer->count = 0;
+    buffer->mask = buffer_size - 1;
     buffer->head = 0;
     buffer->tail = 0;
-    buffer->isFull = false;
     buffer->new_data = false;
+    buffer->num_overflows = 0;
+    buffer->num_new_data = 0;
 
     return RING_BUFFER_OK;
 }
 
 uint8_t ring_buffer_destroy(ring_buffer_t *buffer) {
-    free(buffer->data);
-    if (buffer->data != NULL) {
+    if (buffer->data == NULL) {
         return RING_BUFFER_ERROR;
     }
-    buffer->data = NULL;
+    buffer->data = NULL;  // The storage belongs to the owner
     buffer->buffer_size = 0;
-    buffer->count = 0;
+    buffer->mask = 0;
     buffer->size = 0;
     buffer->head = 0;
     buffer->tail = 0;
-    buffer->isFull = false;
 
     return RING_BUFFER_OK;
 }
 
+uint16_t ring_buffer_count(const ring_buffer_t *buffer) {
+    return (uint16_t) (LOAD_ACQUIRE(buffer->head) - LOAD_ACQUIRE(buffer->tail));
+}
+
+uint16_t ring_buffer_space(const ring_buffer_t *buffer) {
+    return buffer->buffer_size - ring_buffer_count(buffer);
+}
+
 bool is_ring_buffer_empty(const ring_buffer_t *buffer) {
-    return (!buffer->isFull && buffer->head == buffer->tail);
+    return ring_buffer_count(buffer) == 0;
 }
 
 bool is_ring_buffer_full(const ring_buffer_t *buffer) {
-    return buffer->isFull;
+    return ring_buffer_count(buffer) == buffer->buffer_size;
 }
 
 bool ring_buffer_enqueue(ring_buffer_t *buffer, const void *value) {
-    if (buffer->isFull) {
-        return false;  // Buffer is full, cannot enqueue
-    }
+    uint16_t head = buffer->head;
 
-    uint8_t *buffer_data = (uint8_t*) buffer->data;
-    const uint8_t *value_data = (const uint8_t*) value;
-
-    for (int i = 0; i < buffer->size; i++) {
-        buffer_data[(buffer->head * buffer->size + i) % (buffer->size * buffer->buffer_size)] = value_data[i];
+    if ((uint16_t) (head - LOAD_ACQUIRE(buffer->tail)) == buffer->buffer_size) {
+        buffer->num_overflows++;
+        return false;  // Buffer is full, cannot enqueue
     }
-    buffer->peek = buffer->head;
-    buffer->head = (buffer->head + 1) % buffer->buffer_size;
-    buffer->count++;
 
-    if (buffer->count == buffer->buffer_size) {
-        buffer->isFull = true;  // Buffer is full after enqueueing
+    if (buffer->size == 1) {
+        *slot(buffer, head) = *(const uint8_t*) value;
+    } else {
+        memcpy(slot(buffer, head), value, buffer->size);
     }
+    STORE_RELEASE(buffer->head, (uint16_t) (head + 1));
 
     buffer->new_data = true;
     buffer->num_new_data++;
@@ -78,77 +89,192 @@ bool ring_buffer_enqueue(ring_buffer_t *buffer, const void *value) {
 }
 
 bool ring_buffer_dequeue(ring_buffer_t *buffer, void *value) {
-    if (is_ring_buffer_empty(buffer)) {
+    uint16_t tail = buffer->tail;
+
+    if (LOAD_ACQUIRE(buffer->head) == tail) {
         return false;  // Buffer is empty, cannot dequeue
     }
 
-    uint8_t *buffer_data = (uint8_t*) buffer->data;
-    uint8_t *value_data = (uint8_t*) value;
-
-    for (size_t i = 0; i < buffer->size; i++) {
-        value_data[i] = buffer_data[(buffer->tail * buffer->size + i) % (buffer->size * buffer->buffer_size)];
+    if (buffer->size == 1) {
+        *(uint8_t*) value = *slot(buffer, tail);
+    } else {
+        memcpy(value, slot(buffer, tail), buffer->size);
     }
-    memset(&buffer_data[(buffer->tail * buffer->size) % (buffer->size * buffer->buffer_size)], 0,
-            buffer->size);
-    buffer->tail = (buffer->tail + 1) % buffer->buffer_size;
-    buffer->count--;
-    buffer->isFull = false;  // Buffer is no longer full
+    STORE_RELEASE(buffer->tail, (uint16_t) (tail + 1));
 
     return true;
 }
 
-bool ring_buffer_pop(ring_buffer_t *buffer, void *value) {
-    if (is_ring_buffer_empty(buffer) || buffer->tail == buffer->head) {
-        return false;  // Buffer is empty, cannot dequeue
+/*-----------------------------------------------------------------------------
+ * Function: ring_buffer_enqueue_bulk
+ *
+ * Copy up to num_values elements into the buffer with at most two memcpy calls
+ * (one up to the end of the storage, one from the start after wrapping).
+ * Elements that do not fit are counted in num_overflows.
+ *
+ * Parameters: ring_buffer_t *buffer - pointer to the ring buffer
+ *             const void *values - elements to enqueue
+ *             uint16_t num_values - number of elements
+ * Return: uint16_t - number of elements actually enqueued
+ *---------------------------------------------------------------------------*/
+uint16_t ring_buffer_enqueue_bulk(ring_buffer_t *buffer, const void *values, uint16_t num_values) {
+    uint16_t head = buffer->head;
+    uint16_t space = buffer->buffer_size - (uint16_t) (head - LOAD_ACQUIRE(buffer->tail));
+    uint16_t offset = head & buffer->mask;
+    uint16_t first;
+
+    if (num_values > space) {
+        buffer->num_overflows += num_values - space;
+        num_values = space;
+    }
+    if (num_values == 0) {
+        return 0;
+    }
+
+    first = buffer->buffer_size - offset;
+    if (first > num_values) {
+        first = num_values;
+    }
+    memcpy(slot(buffer, head), values, first * buffer->size);
+    if (num_values > first) {
+        memcpy(buffer->data, (const uint8_t*) values + first * buffer->size, (num_values - first) * buffer->size);
     }
+    STORE_RELEASE(buffer->head, (uint16_t) (head + num_values));
 
-    uint8_t *buffer_data = (uint8_t*) buffer->data;
-    uint8_t *value_data = (uint8_t*) value;
+    buffer->new_data = true;
+    buffer->num_new_data += num_values;
+    return num_values;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: ring_buffer_dequeue_bulk
+ *
+ * Copy up to num_values elements out of the buffer with at most two memcpy calls.
+ *
+ * Parameters: ring_buffer_t *buffer - pointer to the ring buffer
+ *             void *values - destination for the elements
+ *             uint16_t num_values - maximum number of elements to dequeue
+ * Return: uint16_t - number of elements actually dequeued
+ *---------------------------------------------------------------------------*/
+uint16_t ring_buffer_dequeue_bulk(ring_buffer_t *buffer, void *values, uint16_t num_values) {
+    uint16_t tail = buffer->tail;
+    uint16_t count = (uint16_t) (LOAD_ACQUIRE(buffer->head) - tail);
+    uint16_t offset = tail & buffer->mask;
+    uint16_t first;
 
-    for (size_t i = 0; i < buffer->size; i++) {
-        value_data[i] = buffer_data[(buffer->head * buffer->size + i) % (buffer->size * buffer->buffer_size)];
+    if (num_values > count) {
+        num_values = count;
     }
-    memset(&buffer_data[(buffer->head * buffer->size) % (buffer->size * buffer->buffer_size)], 0,
-            buffer->size);
-    if (buffer->head == 0) {
-        buffer->head = buffer->buffer_size - 1;
-    } else {
-        buffer->head = (buffer->head - 1) % buffer->buffer_size;
+    if (num_values == 0) {
+        return 0;
+    }
+
+    first = buffer->buffer_size - offset;
+    if (first > num_values) {
+        first = num_values;
+    }
+    memcpy(values, slot(buffer, tail), first * buffer->size);
+    if (num_values > first) {
+        memcpy((uint8_t*) values + first * buffer->size, buffer->data, (num_values - first) * buffer->size);
     }
-    buffer->count--;
-    buffer->isFull = false;  // Buffer is no longer full
+    STORE_RELEASE(buffer->tail, (uint16_t) (tail + num_values));
+
+    return num_values;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: ring_buffer_read_span
+ *
+ * Zero-copy read access for the consumer. Returns the longest run of queued
+ * elements that is contiguous in memory (up to the wrap point). The elements
+ * stay in the buffer until released with ring_buffer_consume.
+ *
+ * Parameters: ring_buffer_t *buffer - pointer to the ring buffer
+ *             void **span - set to the first readable element
+ * Return: uint16_t - number of contiguous elements available at *span
+ *---------------------------------------------------------------------------*/
+uint16_t ring_buffer_read_span(ring_buffer_t *buffer, void **span) {
+    uint16_t tail = buffer->tail;
+    uint16_t count = (uint16_t) (LOAD_ACQUIRE(buffer->head) - tail);
+    uint16_t contiguous = buffer->buffer_size - (tail & buffer->mask);
+
+    *span = slot(buffer, tail);
+    return count < contiguous ? count : contiguous;
+}
+
+void ring_buffer_consume(ring_buffer_t *buffer, uint16_t num_values) {
+    uint16_t tail = buffer->tail;
+    uint16_t count = (uint16_t) (LOAD_ACQUIRE(buffer->head) - tail);
+
+    if (num_values > count) {
+        num_values = count;
+    }
+    STORE_RELEASE(buffer->tail, (uint16_t) (tail + num_values));
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: ring_buffer_write_slot
+ *
+ * Zero-copy write access for the producer. Returns the next free slot so an
+ * element can be built in place; it only becomes visible to the consumer once
+ * published with ring_buffer_commit.
+ *
+ * Parameters: ring_buffer_t *buffer - pointer to the ring buffer
+ * Return: void* - the free slot, or NULL if the buffer is full
+ *---------------------------------------------------------------------------*/
+void* ring_buffer_write_slot(ring_buffer_t *buffer) {
+    uint16_t head = buffer->head;
+
+    if ((uint16_t) (head - LOAD_ACQUIRE(buffer->tail)) == buffer->buffer_size) {
+        return NULL;
+    }
+    return slot(buffer, head);
+}
+
+void ring_buffer_commit(ring_buffer_t *buffer, uint16_t num_values) {
+    uint16_t head = buffer->head;
+    uint16_t space = buffer->buffer_size - (uint16_t) (head - LOAD_ACQUIRE(buffer->tail));
+
+    if (num_values > space) {
+        num_values = space;
+    }
+    STORE_RELEASE(buffer->head, (uint16_t) (head + num_values));
+
+    buffer->new_data = true;
+    buffer->num_new_data += num_values;
+}
+
+bool ring_buffer_pop(ring_buffer_t *buffer, void *value) {
+    uint16_t head = LOAD_ACQUIRE(buffer->head);
+
+    if (head == buffer->tail) {
+        return false;  // Buffer is empty, cannot pop
+    }
+
+    head--;
+    memcpy(value, slot(buffer, head), buffer->size);
+    STORE_RELEASE(buffer->head, head);
 
     return true;
 }
 
 uint8_t ring_buffer_peek(const ring_buffer_t *buffer, uint16_t offset, void *value) {
-    if (is_ring_buffer_empty(buffer)) {
+    uint16_t head = LOAD_ACQUIRE(buffer->head);
+    uint16_t count = (uint16_t) (head - buffer->tail);
+
+    if (count == 0) {
         return RING_BUFFER_EMPTY;
     }
-
-    uint8_t *buffer_data = (uint8_t*) buffer->data;
-    uint8_t *value_data = (uint8_t*) value;
-    uint16_t peek = 0;
-    uint16_t idx = 0;
-
-    if (offset * buffer->size > buffer->head) {
+    if (offset >= count) {
         return RING_BUFFER_OFFSET_OUT_OF_BOUNDS;
-    } else {
-        peek = buffer->peek - (offset * buffer->size);
-    }
-    for (size_t i = 0; i < buffer->size; i++) {
-        idx = (peek * buffer->size + i) % (buffer->size * buffer->buffer_size);
-        value_data[i] = buffer_data[idx];
     }
 
+    // Offset 0 is the most recently enqueued element
+    memcpy(value, slot(buffer, (uint16_t) (head - 1 - offset)), buffer->size);
+
     return RING_BUFFER_OK;
 }
 
 void ring_buffer_flush(ring_buffer_t *buffer) {
-    memset(buffer->data, 0, buffer->size * buffer->buffer_size);
-    buffer->count = 0;
-    buffer->head = 0;
-    buffer->tail = 0;
-    buffer->peek = 0;
-    buffer->isFull = false;
+    STORE_RELEASE(buffer->tail, LOAD_ACQUIRE(buffer->head));
 }
@@ -13,20 +13,39 @@
 #include "ui.h"
 #include "commands.h"
 #include "rtc.h"
-#include "i2c_master.h"
-#include "led_indicator.h"
+#include "line_tokenizer.h"
+#include "binary_protocol.h"
+#include "console_topology.h"
+#include "console_poller.h"
+#include "telemetry.h"
+#include "ram_budget.h"
 
 extern ring_buffer_t rx_buffer;
-extern I2C_HandleTypeDef hi2c1;
-extern led_indicator_t serial_indicator;
-extern led_indicator_t console_indicator[];
-extern uint8_t delta_link;
-extern uint8_t link_status[MAX_NUM_CONSOLES];
 
 scoreboard_t scoreboard;
-i2c_scoreboard_t i2c_scoreboard[MAX_NUM_CONSOLES];
 uint32_t random_seed = 3;
 
+static osMutexId_t scoreboard_mutex = NULL;
+static osMutexId_t response_mutex = NULL;
+static osThreadId_t commandTaskHandle = NULL;
+
+static StaticSemaphore_t scoreboard_mutex_control_block;
+static const osMutexAttr_t scoreboard_mutex_attributes = { .name = "scoreboard", .attr_bits = osMutexPrioInherit,
+        .cb_mem = &scoreboard_mutex_control_block, .cb_size = sizeof(scoreboard_mutex_control_block) };
+static StaticSemaphore_t response_mutex_control_block;
+static const osMutexAttr_t response_mutex_attributes = { .name = "response", .attr_bits = osMutexPrioInherit,
+        .cb_mem = &response_mutex_control_block, .cb_size = sizeof(response_mutex_control_block) };
+
+// Copy of the scoreboard the current response is formatted from, guarded by response_mutex
+static scoreboard_t response_view;
+
+// Command task state, static so that the task stack only holds call frames
+static line_tokenizer_t tokenizer;
+static uint8_t output_buffer[COMMAND_OUTPUT_SIZE];
+
+const uint32_t scoreboard_ram_bytes = sizeof(scoreboard) + sizeof(scoreboard_mutex_control_block)
+        + sizeof(response_mutex_control_block) + sizeof(response_view) + sizeof(tokenizer) + sizeof(output_buffer);
+
 /*-------------------------------------------------------------------------------------------------
  * Function: time_elapsed
  *
@@ -66,6 +85,63 @@ uint32_t rng_get(uint32_t max_value) {
     return counter % max_value;
 }
 
+/*-------------------------------------------------------------------------------------------------
+ * Function: split_request_id
+ *
+ * Split an optional request id off the front of a command line, e.g. "#12 @scores". The id is
+ * NUL-terminated in place so the line must stay valid until the response is finished.
+ *
+ * Parameters: uint8_t *line - command line
+ *             char **request_id - set to the id including the '#', or NULL if there is none
+ * Return: uint8_t* - the command that follows the id
+ *-----------------------------------------------------------------------------------------------*/
+static uint8_t* split_request_id(uint8_t *line, char **request_id) {
+    uint8_t *end;
+
+    *request_id = NULL;
+    if (line[0] != '#') {
+        return line;
+    }
+    end = (uint8_t*) strchr((char*) line, ' ');
+    if (end == NULL || end - line < 2 || end - line >= REQUEST_ID_LENGTH) {
+        return line;
+    }
+    *end++ = '\0';
+    while (*end == ' ') {
+        end++;
+    }
+    *request_id = (char*) line;
+    return end;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * Function: is_mode_change
+ *
+ * Tokenizer barrier: true for a line that switches between text and binary framing, so the bytes
+ * after it are not framed until it has been executed. In text mode that is "@binary" (after an
+ * optional request id). In binary mode it is a request for one of the text modes; a COBS frame
+ * starts with a code byte, followed by the request type unless the type byte is 0.
+ *
+ * Parameters: const command_line_t *line - completed line
+ *             bool zero_delimited - framing the line was received with
+ * Return: bool - true if executing the line may change the framing
+ *-----------------------------------------------------------------------------------------------*/
+static bool is_mode_change(const command_line_t *line, bool zero_delimited) {
+    const char *text = (const char*) line->text;
+
+    if (zero_delimited) {
+        return line->len >= 2 && line->text[0] >= 2
+                && (line->text[1] == CMD_TERMINAL_MODE || line->text[1] == CMD_PC_MODE
+                        || line->text[1] == CMD_SCOREBOARD_MODE);
+    }
+    if (text[0] == '#' && (text = strchr(text, ' ')) != NULL) {
+        while (*text == ' ') {
+            text++;
+        }
+    }
+    return text != NULL && strncmp(text, "@binary", 7) == 0 && (text[7] == '\0' || text[7] == ' ');
+}
+
 /*-------------------------------------------------------------------------------------------------
  * Function: scoreboard_init
  *
@@ -76,253 +152,237 @@ uint32_t rng_get(uint32_t max_value) {
  * Return: None
  *-----------------------------------------------------------------------------------------------*/
 void scoreboard_init() {
+    if (scoreboard_mutex == NULL) {
+        scoreboard_mutex = osMutexNew(&scoreboard_mutex_attributes);
+        response_mutex = osMutexNew(&response_mutex_attributes);
+        if (scoreboard_mutex == NULL || response_mutex == NULL) {
+            Error_Handler();
+        }
+    }
     memset(&scoreboard, 0, sizeof(scoreboard_t));
     scoreboard.mode = SCOREBOARD_MODE;
-    scoreboard.num_consoles = MAX_NUM_CONSOLES;
-    scoreboard.polling_mode = 0;
+    topology_init();
+    scoreboard.num_consoles = topology_num_slots();
+    scoreboard.polling_mode = POLL_OFF;
     scoreboard.demo_mode = 0;
     scoreboard.is_demo_mode_initialized = 0;
     memset(scoreboard.scores, 0, sizeof(scoreboard.scores));
-    for (int i = 0; i < MAX_NUM_CONSOLES; i++) {
-        memset(&i2c_scoreboard[i], 0, sizeof(i2c_scoreboard_t));
-    }
     RTC_sync_set_time(23, 59, 30); // Set the time to 23:59:00 by default to
                                    // verify midnight rollover is working properly
     RTC_sync_set_date(2024, 1, 1); // Set the date to January 1, 2024 by default
+    if (!commands_init()) {
+        Error_Handler();
+    }
 }
 
 /*-------------------------------------------------------------------------------------------------
- * Function: scoreboard_demo_mode_init
+ * Function: scoreboard_lock
  *
- * This function will initialize the scoreboard in demo mode. It will set the
- * scores for each console to a random value.
+ * Serialise access to the scoreboard data between the command, poller and telemetry tasks. It is
+ * only held for short updates and copies, never while writing to the host, so the poller does not
+ * wait behind a slow USB host.
  *
  * Parameters: None
  * Return: None
  *-----------------------------------------------------------------------------------------------*/
-void scoreboard_demo_mode_init() {
-    if (!scoreboard.is_demo_mode_initialized && scoreboard.demo_mode) {
-        scoreboard.is_demo_mode_initialized = 1;
-        for (int i = 0; i < MAX_NUM_CONSOLES; i++) {
-            memset(&scoreboard.scores[i], 0, sizeof(score_t));
-            memset(&scoreboard.stats[i], 0, sizeof(stats_t));
-            scoreboard.scores[i].console_id = i + 1;
-            scoreboard.scores[i].is_connected = 1;
-            scoreboard.scores[i].game_status = 1;
-            scoreboard.scores[i].playing_mode = rng_get(2) ? 1 : 0;
-            scoreboard.scores[i].score1 = rng_get(100);
-            scoreboard.scores[i].apples1 = rng_get(10);
-            if (scoreboard.scores[i].playing_mode) {
-                scoreboard.scores[i].grid_size = 1;
-                scoreboard.scores[i].score2 = rng_get(100);
-                scoreboard.scores[i].apples2 = rng_get(10);
-            } else {
-                scoreboard.scores[i].grid_size = 0;
-            }
-            scoreboard.scores[i].playing_time = rng_get(240);
-            scoreboard.scores[i].game_difficulty = rng_get(3);
-            scoreboard.scores[i].cause_of_death = 0;
-            scoreboard.scores[i].level = rng_get(3);
-            scoreboard.scores[i].game_speed = 50 - scoreboard.scores[i].level * 5;
-            scoreboard.scores[i].with_poison = rng_get(2) ? 1 : 0;
-            scoreboard.stats[i].num_apples_easy = rng_get(100);
-            scoreboard.stats[i].num_apples_medium = rng_get(100);
-            scoreboard.stats[i].num_apples_hard = rng_get(100);
-            scoreboard.stats[i].num_apples_insane = rng_get(100);
-            scoreboard.stats[i].high_score_easy = rng_get(100);
-            scoreboard.stats[i].high_score_medium = rng_get(100);
-            scoreboard.stats[i].high_score_hard = rng_get(100);
-            scoreboard.stats[i].high_score_insane = rng_get(100);
-            scoreboard.stats[i].initials_easy[0] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_easy[1] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_easy[2] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_medium[0] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_medium[1] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_medium[2] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_hard[0] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_hard[1] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_hard[2] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_insane[0] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_insane[1] = 'A' + rng_get(26);
-            scoreboard.stats[i].initials_insane[2] = 'A' + rng_get(26);
-        }
+void scoreboard_lock(void) {
+    osMutexAcquire(scoreboard_mutex, osWaitForever);
+}
+
+void scoreboard_unlock(void) {
+    osMutexRelease(scoreboard_mutex);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * Function: scoreboard_response_lock
+ *
+ * Serialise the writers: the command and telemetry tasks hold it for a whole response, so output
+ * is never interleaved. It also guards the response snapshot and the response state in ui.c and
+ * poll_delta.c. Take it before scoreboard_lock, never while holding it.
+ *
+ * Parameters: None
+ * Return: None
+ *-----------------------------------------------------------------------------------------------*/
+void scoreboard_response_lock(void) {
+    osMutexAcquire(response_mutex, osWaitForever);
+}
+
+void scoreboard_response_unlock(void) {
+    osMutexRelease(response_mutex);
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * Function: scoreboard_snapshot
+ *
+ * Copy the scoreboard under the data lock, so a response can be formatted and written from the
+ * copy while the poller carries on. The caller must hold the response lock until it is done with
+ * the copy.
+ *
+ * Parameters: None
+ * Return: scoreboard_t* - the copy
+ *-----------------------------------------------------------------------------------------------*/
+scoreboard_t* scoreboard_snapshot(void) {
+    scoreboard_lock();
+    memcpy(&response_view, &scoreboard, sizeof(scoreboard_t));
+    scoreboard_unlock();
+    return &response_view;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * Function: commit_settings
+ *
+ * Apply what a command changed in the response snapshot to the scoreboard. The mode, polling and
+ * demo settings are only ever written by the command task, so copying them back cannot undo
+ * another task's update; a demo reset also clears the scores.
+ *
+ * Parameters: const scoreboard_t *view - snapshot the command was executed on
+ *             const command_args_t *args - the command
+ * Return: None
+ *-----------------------------------------------------------------------------------------------*/
+static void commit_settings(const scoreboard_t *view, const command_args_t *args) {
+    scoreboard_lock();
+    scoreboard.mode = view->mode;
+    scoreboard.polling_mode = view->polling_mode;
+    scoreboard.demo_mode = view->demo_mode;
+    if (args->command == CMD_DEMO_MODE && args->value[0] == KEYWORD_RESET) {
+        memcpy(scoreboard.scores, view->scores, sizeof(scoreboard.scores));
+    }
+    scoreboard_unlock();
+}
+
+/*-------------------------------------------------------------------------------------------------
+ * Function: scoreboard_rx_isr
+ *
+ * Wake the command task for a USB packet. Called from CDC_Receive_FS.
+ *
+ * Parameters: None
+ * Return: None
+ *-----------------------------------------------------------------------------------------------*/
+void scoreboard_rx_isr(void) {
+    if (commandTaskHandle != NULL) {
+        osThreadFlagsSet(commandTaskHandle, SCOREBOARD_FLAG_RX);
     }
 }
 
+/*-------------------------------------------------------------------------------------------------
+ * Function: scoreboard_lines_discarded
+ *
+ * Number of command lines the tokenizer dropped for being longer than LINE_MAX_LENGTH.
+ *
+ * Parameters: None
+ * Return: uint16_t - lines discarded since reset
+ *-----------------------------------------------------------------------------------------------*/
+uint16_t scoreboard_lines_discarded(void) {
+    return tokenizer.num_discarded;
+}
+
 /*-------------------------------------------------------------------------------------------------
  * Function: scoreboard_start
  *
- * This function will start the scoreboard and begin query scores from
- * connected gaming consoles via I2C bus. It will listen for serial requests
- * from a PC and respond with the current score.
+ * Start the console poller and telemetry tasks and run the command task in the calling thread:
+ * tokenize the USB input and execute the commands. The command task sleeps while there is no
+ * input and never waits on the I2C buses; commands for the consoles are queued to the poller.
  *
  * Parameters: None
  * Return: None
  *------------------------------------------------------------------------------------------------*/
 void scoreboard_start() {
 
-    uint8_t output_buffer[256];
-    uint8_t command_buffer[128];
-    uint8_t command[32];
-    command_t cmd_token;
-    uint8_t parameter[64];
-    uint8_t rx_value;
-    uint8_t ring_buffer_status;
-    device_list_t consoles[5];
-    uint8_t scoreboard_register[REGISTERS_SIZE];
-    uint16_t link_counter = 5;
-    bool has_command = false;
-    int i = 0; // command buffer index
-    HAL_StatusTypeDef status;
-    uint32_t i2c_command = 0;
+    command_args_t args;
+    parse_status_t parse_status;
+    command_line_t *command_line;
+    uint8_t *command_text;
+    char *request_id;
+    binary_status_t binary_status;
+    uint8_t request_seq;
+    cdc_rx_packet_t rx_packet;
+    uint16_t rx_offset = 0;  // Bytes of the oldest USB packet already tokenized
+    uint16_t consumed;
+    console_request_t request;
     uint32_t seed = 0;
-    uint8_t game_ended[MAX_NUM_CONSOLES] = { 0 };
-    uint8_t tournament_ended = 0;
-    uint32_t previous_time = TIM5->CNT;
-
-    // Initialize the ring buffer
-    ring_buffer_init(&rx_buffer, 256, sizeof(uint8_t));
-
-    // Print banner
-    //print_pc_console(&scoreboard, "Scanning for connected devices\r\n");
-
-    // Poll I2C slaves to get a list of connected devices
-    initialize_device_list(consoles);
-    i2c_master_scan(&hi2c1, consoles);
+    scoreboard_t *view;
 
-    // Fetch initial scoreboard data
-    for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
-        if (consoles[j].is_active) {
-            led_indicator_set_blink(&console_indicator[j], 400, 6);
-            fetch_scoreboard_data(&hi2c1, &consoles[j], scoreboard_register);
-            register2struct(scoreboard_register, &i2c_scoreboard[j]);
-            memset(&scoreboard.scores[j], 0, sizeof(score_t));
-            memset(&scoreboard.stats[j], 0, sizeof(stats_t));
-            scoreboard.scores[j].console_id = consoles[j].device_id;
-            scoreboard.scores[j].grid_size = (i2c_scoreboard[j].current_game_state3 & GAME_GRID_SIZE)
-                    >> GAME_GRID_SIZE_SHIFT;
-            scoreboard.scores[j].game_status = i2c_scoreboard[j].current_game_state & GAME_STATUS;
-            scoreboard.scores[j].game_difficulty = (i2c_scoreboard[j].console_info & GAME_LEVEL_MODE)
-                    >> GAME_LEVEL_MODE_SHIFT;
-            scoreboard.scores[j].cause_of_death =
-                    (i2c_scoreboard[j].current_game_state3 & GAME_CAUSE_OF_DEATH) >> GAME_CAUSE_OF_DEATH_SHIFT;
-            scoreboard.scores[j].game_speed = (i2c_scoreboard[j].current_game_state2 & GAME_SPEED)
-                    >> GAME_SPEED_SHIFT;
-            scoreboard.scores[j].is_connected = 1;
-            scoreboard.scores[j].score1 = i2c_scoreboard[j].current_score1;
-            scoreboard.scores[j].score2 = i2c_scoreboard[j].current_score2;
-            scoreboard.scores[j].apples1 = i2c_scoreboard[j].number_apples1;
-            scoreboard.scores[j].apples2 = i2c_scoreboard[j].number_apples2;
-            scoreboard.scores[j].playing_time = i2c_scoreboard[j].playing_time;
-            scoreboard.scores[j].level = (i2c_scoreboard[j].current_game_state & GAME_PLAYING_LEVEL)
-                    >> GAME_PLAYING_LEVEL_SHIFT;
-            scoreboard.scores[j].playing_mode = i2c_scoreboard[j].current_game_state2 & GAME_NUM_PLAYERS;
-            scoreboard.scores[j].with_poison = (i2c_scoreboard[j].current_game_state2 & GAME_POISON_FLAG)
-                    >> GAME_POISON_SHIFT;
-            scoreboard.stats[j].num_apples_easy = i2c_scoreboard[j].num_apples_easy;
-            scoreboard.stats[j].num_apples_medium = i2c_scoreboard[j].num_apples_medium;
-            scoreboard.stats[j].num_apples_hard = i2c_scoreboard[j].num_apples_hard;
-            scoreboard.stats[j].num_apples_insane = i2c_scoreboard[j].num_apples_insane;
-            scoreboard.stats[j].high_score_easy = i2c_scoreboard[j].high_score_easy;
-            scoreboard.stats[j].high_score_medium = i2c_scoreboard[j].high_score_medium;
-            scoreboard.stats[j].high_score_hard = i2c_scoreboard[j].high_score_hard;
-            scoreboard.stats[j].high_score_insane = i2c_scoreboard[j].high_score_insane;
-            strncpy(scoreboard.stats[j].initials_easy, i2c_scoreboard[j].initials_easy, 3);
-            strncpy(scoreboard.stats[j].initials_medium, i2c_scoreboard[j].initials_medium, 3);
-            strncpy(scoreboard.stats[j].initials_hard, i2c_scoreboard[j].initials_hard, 3);
-            strncpy(scoreboard.stats[j].initials_insane, i2c_scoreboard[j].initials_insane, 3);
-        } else {
-            scoreboard.scores[j].console_id = consoles[j].device_id;
-            scoreboard.scores[j].is_connected = 0;
-            scoreboard.scores[j].score1 = 0;
-            scoreboard.scores[j].score2 = 0;
-            scoreboard.scores[j].apples1 = 0;
-            scoreboard.scores[j].apples2 = 0;
-            scoreboard.scores[j].playing_time = 0;
-            scoreboard.scores[j].level = 0;
-            scoreboard.scores[j].with_poison = 0;
-            scoreboard.scores[j].playing_mode = 0;
-            scoreboard.scores[j].game_status = 0;
-        }
+    if (line_tokenizer_init(&tokenizer, is_mode_change) != RING_BUFFER_OK) {
+        Error_Handler();
     }
+    commandTaskHandle = osThreadGetId();
+    telemetry_init();
+    console_poller_init();
 
     /* Infinite loop */
     for (;;) {
-        if (delta_link || link_counter == 0) {
-            // Reset I2C bus and scan for connected devices
-            SYSCFG->CFGR |= SYSCFG_CFGR_FMPI2C1_SCL;
-            SYSCFG->CFGR |= SYSCFG_CFGR_FMPI2C1_SDA;
-            HAL_I2C_DeInit(&hi2c1);
-            SYSCFG->CFGR &= ~SYSCFG_CFGR_FMPI2C1_SCL;
-            SYSCFG->CFGR &= ~SYSCFG_CFGR_FMPI2C1_SDA;
-            HAL_I2C_Init(&hi2c1);
-
-            i2c_master_scan(&hi2c1, consoles);
-            for (int i = 0; i < MAX_NUM_CONSOLES; i++) {
-                if (link_status[i]) {
-                    led_indicator_set_blink(&console_indicator[i], 400, 6);
-                }
-            }
-            delta_link = 0;
-            link_counter = 5;
-        }
-        // Check for incoming new data in the ring buffer
-        if (rx_buffer.new_data) {
-            rx_buffer.new_data = false;
-            for (int j = rx_buffer.num_new_data - 1; j >= 0; j--) {
-                rx_value = 0xFF;
-                ring_buffer_status = ring_buffer_peek(&rx_buffer, j, &rx_value);
-                if (ring_buffer_status == RING_BUFFER_OFFSET_OUT_OF_BOUNDS) {
-                    Error_Handler();
-                }
-                if (rx_value == '\r') {
-                    i = 0;
-                    memset(command_buffer, 0, sizeof(command_buffer));
-                    ring_buffer_pop(&rx_buffer, &rx_value); // Pop the newline character
-                    while (!is_ring_buffer_empty(&rx_buffer)) {
-                        ring_buffer_dequeue(&rx_buffer, &rx_value);
-                        command_buffer[i++] = rx_value;
-                    }
-                    ring_buffer_flush(&rx_buffer);
-                    has_command = true;
-                    break;
-                } else {
-                    echo_terminal(&scoreboard, &rx_value);
-                }
+        // Tokenize received USB packets until the line queue is full. A packet that could
+        // not be consumed completely stays held (and keeps the host paced) until lines are freed.
+        while (CDC_Get_RxPacket_FS(&rx_packet)) {
+            consumed = line_tokenizer_feed(&tokenizer, &rx_packet.data[rx_offset], rx_packet.len - rx_offset);
+            scoreboard_response_lock();  // The mode is only changed by this task
+            echo_terminal(&scoreboard, &rx_packet.data[rx_offset], consumed);
+            scoreboard_response_unlock();
+            rx_offset += consumed;
+            if (rx_offset < rx_packet.len) {
+                break;
             }
-            rx_buffer.num_new_data = 0;
+            rx_offset = 0;
+            CDC_Release_RxPacket_FS();
         }
 
-        if (has_command) {
-            has_command = false;
+        // Execute one queued command per pass, in arrival order, so a batch such as
+        // "@scores\r@stats\r@devices\r" is answered in order. The response is formatted from a
+        // snapshot and written under the response lock, so telemetry output cannot land in the
+        // middle of it and the poller never waits for the host.
+        command_line = line_tokenizer_next(&tokenizer);
+        if (command_line != NULL) {
+            scoreboard_response_lock();
+            view = scoreboard_snapshot();
             memset(output_buffer, 0, sizeof(output_buffer));
-            memset(command, 0, sizeof(command));
-            memset(parameter, 0, sizeof(parameter));
-            cmd_token = parse_command(command_buffer, command, parameter);
-            if (cmd_token == INVALID_COMMAND || cmd_token == INVALID_PARAMETER_COUNT) {
-                if (scoreboard.mode == PC_CONSOLE_MODE) {
-                    if (cmd_token == INVALID_COMMAND)
-                        sprintf((char*) output_buffer, "ERR\tInvalid command: %s\r\n", command);
-                    else if (cmd_token == INVALID_PARAMETER_COUNT)
+            if (view->mode == BINARY_MODE) {
+                binary_status = binary_parse_request(command_line->text, command_line->len, &request_seq, &args);
+                ui_begin_binary_response(request_seq);
+                parse_status = (binary_status == BINARY_STATUS_OK) ? PARSE_OK : PARSE_UNKNOWN_COMMAND;
+            } else {
+                command_text = split_request_id(command_line->text, &request_id);
+                ui_begin_response(request_id);
+                parse_status = parse_command(command_text, command_line->len - (command_text - command_line->text),
+                        &args);
+                binary_status = BINARY_STATUS_OK;
+            }
+            if (parse_status != PARSE_OK) {
+                if (binary_status == BINARY_STATUS_OK) {
+                    binary_status = (parse_status == PARSE_UNKNOWN_COMMAND) ? BINARY_STATUS_INVALID_COMMAND :
+                                    (parse_status == PARSE_PARAMETER_COUNT) ? BINARY_STATUS_INVALID_PARAMETER_COUNT :
+                                                                               BINARY_STATUS_INVALID_PARAMETER_VALUE;
+                }
+                if (view->mode == PC_CONSOLE_MODE) {
+                    if (parse_status == PARSE_UNKNOWN_COMMAND)
+                        sprintf((char*) output_buffer, "ERR\tInvalid command: %.*s\r\n", args.name.len,
+                                args.name.ptr);
+                    else if (parse_status == PARSE_PARAMETER_COUNT)
                         sprintf((char*) output_buffer, "ERR\tInvalid parameter count\r\n");
-                    print_pc_console(&scoreboard, (char*) output_buffer);
-                } else if (scoreboard.mode == TERMINAL_CONSOLE_MODE) {
-                    if (cmd_token == INVALID_COMMAND)
-                        sprintf((char*) output_buffer, "\r\nInvalid command: %s\r\n", command);
-                    else if (cmd_token == INVALID_PARAMETER_COUNT)
+                    else
+                        sprintf((char*) output_buffer, "ERR\tInvalid parameter\r\n");
+                    print_pc_console(view, (char*) output_buffer);
+                } else if (view->mode == TERMINAL_CONSOLE_MODE) {
+                    if (parse_status == PARSE_UNKNOWN_COMMAND)
+                        sprintf((char*) output_buffer, "\r\nInvalid command: %.*s\r\n", args.name.len,
+                                args.name.ptr);
+                    else if (parse_status == PARSE_PARAMETER_COUNT)
                         sprintf((char*) output_buffer, "\r\nInvalid parameter count\r\n");
-                    print_terminal(&scoreboard, (char*) output_buffer);
+                    else
+                        sprintf((char*) output_buffer, "\r\nInvalid parameter\r\n");
+                    print_terminal(view, (char*) output_buffer);
                 } else {
-                    if (cmd_token == INVALID_COMMAND)
-                        sprintf((char*) output_buffer, "{'error': 'Invalid command: %s', 'status': 0}\n",
-                                command);
-                    else if (cmd_token == INVALID_PARAMETER_COUNT)
+                    if (parse_status == PARSE_UNKNOWN_COMMAND)
+                        sprintf((char*) output_buffer, "{'error': 'Invalid command: %.*s', 'status': 0}\n",
+                                args.name.len, args.name.ptr);
+                    else if (parse_status == PARSE_PARAMETER_COUNT)
                         sprintf((char*) output_buffer, "{'error': 'Invalid parameter count', 'status': 0}\n");
-                    print_scoreboard(&scoreboard, (char*) output_buffer);
+                    else
+                        sprintf((char*) output_buffer, "{'error': 'Invalid parameter', 'status': 0}\n");
+                    print_scoreboard(view, (char*) output_buffer);
                 }
 
             } else {
-                switch (cmd_token) {
+                switch (args.command) {
                     case CMD_SET_SPEED:
                     case CMD_SET_LEVEL:
                     case CMD_PREPARE_GAME:
@@ -330,173 +390,39 @@ void scoreboard_start() {
                     case CMD_END_GAME:
                     case CMD_PAUSE_GAME:
                     case CMD_RANDOM_SEED:
-                        i2c_command = parse_i2c_command(cmd_token, parameter);
-                        if (cmd_token == CMD_RANDOM_SEED) {
-                            seed = atoi((char*) parameter);
+                        request.type = CONSOLE_REQUEST_COMMAND;
+                        request.command = parse_i2c_command(&args);
+                        if (args.command == CMD_RANDOM_SEED) {
+                            seed = args.value[0];
                             if (seed == 0) {
                                 seed = TIM2->CNT;
                             }
-                        } else if (cmd_token == CMD_START_GAME) {
-                            scoreboard.is_tournament_mode = 1;
-                            memset(game_ended, 0, sizeof(game_ended));
+                        } else if (args.command == CMD_START_GAME) {
+                            request.type = CONSOLE_REQUEST_START;  // Also starts the tournament
                         } else {
                             seed = 0;
                         }
-                        if (i2c_command != 0)
-                            i2c_send_command(&hi2c1, consoles, i2c_command, seed);
+                        request.seed = seed;
+                        // Sent by the poller task; the response does not wait for the bus
+                        if (!console_poller_request(&request)) {
+                            binary_status = BINARY_STATUS_ERROR;
+                        }
                         break;
                     default:
-                        execute_command(&scoreboard, cmd_token, parameter);
+                        if (execute_command(view, &args) != CMD_OK)
+                            binary_status = BINARY_STATUS_ERROR;
                         break;
                 }
             }
+            ui_end_response(view, args.command, binary_status);
+            commit_settings(view, &args);
+            line_tokenizer_set_framing(&tokenizer, view->mode == BINARY_MODE);
+            scoreboard_response_unlock();
+            line_tokenizer_release(&tokenizer);
+        } else if (!CDC_Get_RxPacket_FS(&rx_packet)) {
+            // Nothing queued: sleep until the next USB packet
+            osThreadFlagsWait(SCOREBOARD_FLAG_RX, osFlagsWaitAny, osWaitForever);
         }
-        osThreadYield();
-        if (time_elapsed(previous_time) >= 10000) {
-            previous_time = TIM5->CNT;
-            link_counter--;
-            if (scoreboard.demo_mode) {
-                if (!scoreboard.is_demo_mode_initialized) {
-                    scoreboard_demo_mode_init();
-                }
-                for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
-                    consoles[j].is_active = 1;
-                    if (scoreboard.scores[j].game_status == 1) {
-                        if (scoreboard.scores[j].score1 > 150 && rng_get(50) >= 35) {
-                            scoreboard.scores[j].game_status = 3;
-                            scoreboard.scores[j].cause_of_death = 1 + rng_get(4);
-                        }
-                        if (rng_get(20) >= 7) {
-                            scoreboard.scores[j].score1 += rng_get(10) + 1;
-                            scoreboard.scores[j].apples1 += rng_get(2) + 1;
-                            if (scoreboard.scores[j].playing_mode) {
-                                scoreboard.scores[j].score2 += rng_get(10) + 1;
-                                scoreboard.scores[j].apples2 += rng_get(2) + 1;
-                            }
-                        }
-                        scoreboard.scores[j].playing_time++;
-                    } else if (scoreboard.scores[j].game_status == 3) {
-                        if (rng_get(100) >= 87) {
-                            scoreboard.scores[j].game_status = 1;
-                            scoreboard.scores[j].playing_mode = rng_get(2) ? 1 : 0;
-                            scoreboard.scores[j].score1 = rng_get(100);
-                            scoreboard.scores[j].apples1 = rng_get(10);
-                            scoreboard.scores[j].score2 = 0;
-                            scoreboard.scores[j].apples2 = 0;
-                            if (scoreboard.scores[j].playing_mode) {
-                                scoreboard.scores[j].grid_size = 1;
-                                scoreboard.scores[j].score2 = rng_get(100);
-                                scoreboard.scores[j].apples2 = rng_get(10);
-                            } else {
-                                scoreboard.scores[j].grid_size = 0;
-                            }
-                            scoreboard.scores[j].playing_time = rng_get(120);
-                            scoreboard.scores[j].game_difficulty = rng_get(3);
-                            scoreboard.scores[j].cause_of_death = 0;
-                            scoreboard.scores[j].level = rng_get(3);
-                            scoreboard.scores[i].game_speed = 50 - scoreboard.scores[i].level * 5;
-                            scoreboard.scores[j].with_poison = rng_get(2) ? 1 : 0;
-                        }
-                    }
-                }
-            } else if (!scoreboard.demo_mode && scoreboard.is_demo_mode_initialized) {
-                scoreboard.is_demo_mode_initialized = 0;
-                memset(scoreboard.scores, 0, sizeof(scoreboard.scores));
-                memset(scoreboard.stats, 0, sizeof(scoreboard.stats));
-            } else {
-                for (int j = 0; j < MAX_NUM_CONSOLES; j++) {
-                    if (link_status[j]) {
-                        led_indicator_set_blink(&console_indicator[j], 400, 6);
-                    }
-                    if (consoles[j].is_active) {
-                        status = fetch_scoreboard_data(&hi2c1, &consoles[j], scoreboard_register);
-                        if (status != HAL_OK) {
-                            consoles[j].is_active = 0;
-                        }
-                        register2struct(scoreboard_register, &i2c_scoreboard[j]);
-                        scoreboard.scores[j].console_id = consoles[j].device_id;
-                        scoreboard.scores[j].grid_size = (i2c_scoreboard[j].current_game_state3
-                                & GAME_GRID_SIZE) >> GAME_GRID_SIZE_SHIFT;
-                        scoreboard.scores[j].game_status = i2c_scoreboard[j].current_game_state & GAME_STATUS;
-                        scoreboard.scores[j].game_difficulty = (i2c_scoreboard[j].console_info
-                                & GAME_LEVEL_MODE) >> GAME_LEVEL_MODE_SHIFT;
-                        scoreboard.scores[j].cause_of_death = (i2c_scoreboard[j].current_game_state3
-                                & GAME_CAUSE_OF_DEATH) >> GAME_CAUSE_OF_DEATH_SHIFT;
-                        scoreboard.scores[j].game_speed = (i2c_scoreboard[j].current_game_state2 & GAME_SPEED)
-                                >> GAME_SPEED_SHIFT;
-                        scoreboard.scores[j].is_connected = 1;
-                        scoreboard.scores[j].score1 = i2c_scoreboard[j].current_score1;
-                        scoreboard.scores[j].score2 = i2c_scoreboard[j].current_score2;
-                        scoreboard.scores[j].apples1 = i2c_scoreboard[j].number_apples1;
-                        scoreboard.scores[j].apples2 = i2c_scoreboard[j].number_apples2;
-                        scoreboard.scores[j].playing_time = i2c_scoreboard[j].playing_time;
-                        scoreboard.scores[j].level = (i2c_scoreboard[j].current_game_state
-                                & GAME_PLAYING_LEVEL) >> GAME_PLAYING_LEVEL_SHIFT;
-                        scoreboard.scores[j].playing_mode = i2c_scoreboard[j].current_game_state2
-                                & GAME_NUM_PLAYERS;
-                        scoreboard.scores[j].with_poison = (i2c_scoreboard[j].current_game_state2
-                                & GAME_POISON_FLAG) >> GAME_POISON_SHIFT;
-                        scoreboard.stats[j].num_apples_easy = i2c_scoreboard[j].num_apples_easy;
-                        scoreboard.stats[j].num_apples_medium = i2c_scoreboard[j].num_apples_medium;
-                        scoreboard.stats[j].num_apples_hard = i2c_scoreboard[j].num_apples_hard;
-                        scoreboard.stats[j].num_apples_insane = i2c_scoreboard[j].num_apples_insane;
-                        scoreboard.stats[j].high_score_easy = i2c_scoreboard[j].high_score_easy;
-                        scoreboard.stats[j].high_score_medium = i2c_scoreboard[j].high_score_medium;
-                        scoreboard.stats[j].high_score_hard = i2c_scoreboard[j].high_score_hard;
-                        scoreboard.stats[j].high_score_insane = i2c_scoreboard[j].high_score_insane;
-                        strncpy(scoreboard.stats[j].initials_easy, i2c_scoreboard[j].initials_easy, 3);
-                        strncpy(scoreboard.stats[j].initials_medium, i2c_scoreboard[j].initials_medium, 3);
-                        strncpy(scoreboard.stats[j].initials_hard, i2c_scoreboard[j].initials_hard, 3);
-                        strncpy(scoreboard.stats[j].initials_insane, i2c_scoreboard[j].initials_insane, 3);
-
-                    } else {
-                        scoreboard.scores[j].console_id = consoles[j].device_id;
-                        scoreboard.scores[j].is_connected = 0;
-                        scoreboard.scores[j].score1 = 0;
-                        scoreboard.scores[j].score2 = 0;
-                        scoreboard.scores[j].apples1 = 0;
-                        scoreboard.scores[j].apples2 = 0;
-                        scoreboard.scores[j].level = 0;
-                        scoreboard.scores[j].with_poison = 0;
-                        scoreboard.scores[j].playing_mode = 0;
-                        scoreboard.scores[j].game_status = 0;
-                    }
-                }
-            }
-
-            // If the tournament mode is enabled, check if the tournament is over
-
-            if (scoreboard.is_tournament_mode) {
-                for (int k = 0; k < MAX_NUM_CONSOLES; k++) {
-                    if (consoles[k].is_active) {
-                        if (scoreboard.scores[k].game_status == 3) { // game ended
-                            game_ended[k] = 1;
-                        }
-                    } else {
-                        game_ended[k] = 1; // If less than MAX_NUM_CONSOLES are connected, inactive slot is considered game ended
-                    }
-                }
-
-                tournament_ended = 1;
-                for (int k = 0; k < MAX_NUM_CONSOLES; k++) {
-                    if (game_ended[k] == 0) { // At least one console is still playing, so tournament is not over
-                        tournament_ended = 0;
-                    }
-                }
-                if (tournament_ended) {
-                    scoreboard.is_tournament_mode = 0;
-                    // Send tournament end command to all consoles
-                    i2c_send_command(&hi2c1, consoles, I2C_CMD_TOURNAMENT_END, 0);
-                }
-            }
-
-            if (scoreboard.polling_mode) {
-                cmd_token = CMD_LIST_SCORES;
-                memset(parameter, 0, sizeof(parameter));
-                execute_command(&scoreboard, cmd_token, parameter);
-            }
-        }
-        osThreadYield();
     }
 
 }
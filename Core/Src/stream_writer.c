@@ -0,0 +1,108 @@
+/*
+ * stream_writer.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include <string.h>
+
+#include "stream_writer.h"
+#include "ui.h"
+
+void sw_begin(stream_writer_t *w, scoreboard_t *scoreboard, mode_t mode) {
+    w->scoreboard = scoreboard;
+    w->mode = mode;
+    w->len = 0;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: sw_flush
+ *
+ * Send whatever is in the chunk. Call once at the end of a response.
+ *
+ * Parameters: stream_writer_t *w - writer
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void sw_flush(stream_writer_t *w) {
+    print_bytes(w->scoreboard, w->mode, w->chunk, w->len);
+    w->len = 0;
+}
+
+void sw_write(stream_writer_t *w, const char *data, uint16_t len) {
+    uint16_t n;
+
+    while (len > 0) {
+        n = STREAM_WRITER_CHUNK - w->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(&w->chunk[w->len], data, n);
+        w->len += n;
+        data += n;
+        len -= n;
+        if (w->len == STREAM_WRITER_CHUNK) {
+            sw_flush(w);
+        }
+    }
+}
+
+void sw_puts(stream_writer_t *w, const char *str) {
+    sw_write(w, str, strlen(str));
+}
+
+void sw_putc(stream_writer_t *w, char c) {
+    w->chunk[w->len++] = c;
+    if (w->len == STREAM_WRITER_CHUNK) {
+        sw_flush(w);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: sw_uint_pad
+ *
+ * Append an unsigned decimal number, zero padded to at least width digits
+ * (width 0 or 1 for no padding). Digits are produced two at a time from a
+ * lookup table, so only one division per pair is needed.
+ *
+ * Parameters: stream_writer_t *w - writer
+ *             uint32_t value - number to format
+ *             uint8_t width - minimum number of digits
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void sw_uint_pad(stream_writer_t *w, uint32_t value, uint8_t width) {
+    static const char digit_pairs[201] = "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+    char digits[10];
+    uint8_t pos = sizeof(digits);
+    uint32_t pair;
+
+    while (value >= 100) {
+        pair = value % 100;
+        value /= 100;
+        digits[--pos] = digit_pairs[pair * 2 + 1];
+        digits[--pos] = digit_pairs[pair * 2];
+    }
+    if (value >= 10) {
+        digits[--pos] = digit_pairs[value * 2 + 1];
+        digits[--pos] = digit_pairs[value * 2];
+    } else {
+        digits[--pos] = '0' + value;
+    }
+    while (sizeof(digits) - pos < width && pos > 0) {
+        digits[--pos] = '0';
+    }
+    sw_write(w, &digits[pos], sizeof(digits) - pos);
+}
+
+void sw_uint(stream_writer_t *w, uint32_t value) {
+    sw_uint_pad(w, value, 0);
+}
@@ -0,0 +1,189 @@
+/*
+ * sysinfo.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "sysinfo.h"
+#include "scoreboard.h"
+#include "console_poller.h"
+#include "i2c_engine.h"
+#include "usb_tx.h"
+#include "usbd_cdc_if.h"
+#include "ram_budget.h"
+
+extern ring_buffer_t rx_buffer;
+
+// Two task snapshots: the newest and the one a window before it
+static TaskStatus_t snapshots[2][SYSINFO_MAX_TASKS];
+static UBaseType_t num_tasks[2] = { 0 };
+static uint32_t total_run_time[2];
+static uint8_t newest = 0;
+
+static sysinfo_task_t results[SYSINFO_MAX_TASKS];
+static uint8_t num_results = 0;
+
+const uint32_t sysinfo_ram_bytes = sizeof(snapshots) + sizeof(results);
+
+/*-----------------------------------------------------------------------------
+ * Function: find_task
+ *
+ * Look up a task in a snapshot.
+ *
+ * Parameters: const TaskStatus_t *snapshot - snapshot to search
+ *             UBaseType_t count - number of tasks in the snapshot
+ *             TaskHandle_t handle - task to find
+ * Return: const TaskStatus_t* - the task's status, NULL if it is not there
+ *---------------------------------------------------------------------------*/
+static const TaskStatus_t* find_task(const TaskStatus_t *snapshot, UBaseType_t count, TaskHandle_t handle) {
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (snapshot[i].xHandle == handle) {
+            return &snapshot[i];
+        }
+    }
+    return NULL;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: sort_by_number
+ *
+ * Order a snapshot by task number, i.e. creation order, so the tasks are
+ * always listed the same way whatever state they were in.
+ *
+ * Parameters: TaskStatus_t *snapshot - snapshot to sort
+ *             UBaseType_t count - number of tasks in the snapshot
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void sort_by_number(TaskStatus_t *snapshot, UBaseType_t count) {
+    TaskStatus_t task;
+    UBaseType_t j;
+
+    for (UBaseType_t i = 1; i < count; i++) {
+        task = snapshot[i];
+        for (j = i; j > 0 && snapshot[j - 1].xTaskNumber > task.xTaskNumber; j--) {
+            snapshot[j] = snapshot[j - 1];
+        }
+        snapshot[j] = task;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: sysinfo_sample
+ *
+ * Take a snapshot of every task and work out its CPU load since the previous
+ * snapshot. Both run time counters wrap at 32 bits, the differences do not
+ * as long as samples are less than a TIM2 period (about 47 s) apart.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void sysinfo_sample(void) {
+    uint8_t previous = newest;
+    uint8_t next = newest ^ 1;
+    TaskStatus_t *now = snapshots[next];
+    const TaskStatus_t *before;
+    sysinfo_task_t tasks[SYSINFO_MAX_TASKS];
+    uint32_t window;
+    uint32_t ran;
+    UBaseType_t count;
+
+    count = uxTaskGetSystemState(now, SYSINFO_MAX_TASKS, &total_run_time[next]);
+    if (count == 0) {
+        return;  // More tasks than SYSINFO_MAX_TASKS
+    }
+    num_tasks[next] = count;
+    newest = next;
+    sort_by_number(now, count);
+
+    window = total_run_time[next] - total_run_time[previous];
+    for (UBaseType_t i = 0; i < count; i++) {
+        before = find_task(snapshots[previous], num_tasks[previous], now[i].xHandle);
+        ran = before != NULL ? now[i].ulRunTimeCounter - before->ulRunTimeCounter : 0;
+        tasks[i].name = now[i].pcTaskName;
+        tasks[i].cpu_percent = window > 0 ? ((uint64_t) ran * 100 + window / 2) / window : 0;
+        tasks[i].stack_free = now[i].usStackHighWaterMark;
+    }
+
+    taskENTER_CRITICAL();
+    for (UBaseType_t i = 0; i < count; i++) {
+        results[i] = tasks[i];
+    }
+    num_results = count;
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: sysinfo_get_tasks
+ *
+ * CPU load and stack high-water mark of every task, as of the last sample.
+ *
+ * Parameters: sysinfo_task_t *tasks - filled in, in creation order
+ *             uint8_t max_tasks - size of tasks
+ * Return: uint8_t - number of tasks filled in, 0 before the first sample
+ *---------------------------------------------------------------------------*/
+uint8_t sysinfo_get_tasks(sysinfo_task_t *tasks, uint8_t max_tasks) {
+    uint8_t count;
+
+    taskENTER_CRITICAL();
+    count = num_results < max_tasks ? num_results : max_tasks;
+    for (uint8_t i = 0; i < count; i++) {
+        tasks[i] = results[i];
+    }
+    taskEXIT_CRITICAL();
+    return count;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: sysinfo_get_heap
+ *
+ * FreeRTOS heap (heap_4) usage. Everything is allocated statically, so the
+ * heap is normally never touched; heap_4 only sets itself up on the first
+ * allocation and reports zero free bytes until then.
+ *
+ * Parameters: sysinfo_heap_t *heap - filled in
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void sysinfo_get_heap(sysinfo_heap_t *heap) {
+    HeapStats_t stats;
+
+    vPortGetHeapStats(&stats);
+    if (stats.xNumberOfSuccessfulAllocations == 0 && stats.xNumberOfFreeBlocks == 0) {
+        heap->free_bytes = configTOTAL_HEAP_SIZE;
+        heap->min_free_bytes = configTOTAL_HEAP_SIZE;
+        heap->largest_block = configTOTAL_HEAP_SIZE;
+    } else {
+        heap->free_bytes = stats.xAvailableHeapSpaceInBytes;
+        heap->min_free_bytes = stats.xMinimumEverFreeBytesRemaining;
+        heap->largest_block = stats.xSizeOfLargestFreeBlockInBytes;
+    }
+    heap->num_allocations = stats.xNumberOfSuccessfulAllocations;
+    heap->fragmentation = heap->free_bytes > 0 ? 100 - heap->largest_block * 100 / heap->free_bytes : 0;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: sysinfo_get_overflows
+ *
+ * Collect the counters of every queue and buffer that drops or holds back
+ * data when it is full.
+ *
+ * Parameters: sysinfo_overflows_t *overflows - filled in
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void sysinfo_get_overflows(sysinfo_overflows_t *overflows) {
+    cdc_rx_stats_t rx;
+    usb_tx_stats_t tx;
+    i2c_engine_stats_t i2c;
+
+    CDC_Get_RxStats_FS(&rx);
+    usb_tx_get_stats(&tx);
+    i2c_engine_get_stats(&i2c);
+    overflows->usb_rx_overflows = rx_buffer.num_overflows;
+    overflows->usb_rx_stalls = rx.num_stalls;
+    overflows->usb_tx_dropped = tx.bytes_dropped;
+    overflows->lines_discarded = scoreboard_lines_discarded();
+    overflows->i2c_dropped = i2c.num_dropped;
+    overflows->requests_dropped = console_poller_num_rejected();
+}
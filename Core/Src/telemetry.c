@@ -0,0 +1,94 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include "telemetry.h"
+#include "memory_config.h"
+#include "commands.h"
+#include "poll_delta.h"
+#include "ram_budget.h"
+
+static osEventFlagsId_t telemetry_events = NULL;
+static osThreadId_t telemetryTaskHandle = NULL;
+
+static StaticEventGroup_t telemetry_events_control_block;
+static StaticTask_t telemetryTask_control_block;
+static uint32_t telemetryTask_stack[TELEMETRY_TASK_STACK_WORDS];
+
+const uint32_t telemetry_ram_bytes = sizeof(telemetry_events_control_block) + sizeof(telemetryTask_control_block)
+        + sizeof(telemetryTask_stack);
+
+static const osEventFlagsAttr_t telemetry_events_attributes = { .name = "telemetryEvents", .cb_mem =
+        &telemetry_events_control_block, .cb_size = sizeof(telemetry_events_control_block) };
+static const osThreadAttr_t telemetryTask_attributes = { .name = "telemetryTask", .cb_mem = &telemetryTask_control_block,
+        .cb_size = sizeof(telemetryTask_control_block), .stack_mem = telemetryTask_stack, .stack_size =
+                sizeof(telemetryTask_stack), .priority = (osPriority_t) osPriorityBelowNormal, };
+
+static void StartTelemetry(void *argument);
+
+void telemetry_init(void) {
+    telemetry_events = osEventFlagsNew(&telemetry_events_attributes);
+    telemetryTaskHandle = osThreadNew(StartTelemetry, NULL, &telemetryTask_attributes);
+
+    if (telemetry_events == NULL || telemetryTaskHandle == NULL) {
+        Error_Handler();
+    }
+}
+
+void telemetry_notify(uint32_t events) {
+    osEventFlagsSet(telemetry_events, events);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: StartTelemetry
+ *
+ * Telemetry task. Delta updates follow the console poll rates, but no more
+ * often than POLL_DELTA_MIN_INTERVAL_MS: a change that arrives sooner is
+ * held until the interval has passed.
+ *
+ * Parameters: void *argument - unused
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void StartTelemetry(void *argument) {
+    command_args_t args;
+    scoreboard_t *view;
+    uint32_t events;
+    uint32_t wait = osWaitForever;
+    uint32_t last_publish = 0;     // HAL_GetTick() of the last delta publish
+    uint8_t results_changed = 0;   // Console data updated since the last delta publish
+
+    UNUSED(argument);
+
+    for (;;) {
+        events = osEventFlagsWait(telemetry_events, TELEMETRY_EVENTS, osFlagsWaitAny, wait);
+        if (events & osFlagsError) {
+            events = 0;  // Timed out: a held delta update is due
+        }
+        if (events & TELEMETRY_EVENT_RESULTS) {
+            results_changed = 1;
+        }
+
+        // Formatted from a snapshot, so the poller is not held up while the host reads slowly
+        scoreboard_response_lock();
+        view = scoreboard_snapshot();
+        if ((events & TELEMETRY_EVENT_TICK) && view->polling_mode == POLL_FULL) {
+            args.command = CMD_LIST_SCORES;
+            args.num_values = 0;
+            execute_command(view, &args);
+        }
+        wait = osWaitForever;
+        if (view->polling_mode == POLL_DELTA && results_changed) {
+            if (HAL_GetTick() - last_publish >= POLL_DELTA_MIN_INTERVAL_MS) {
+                results_changed = 0;
+                last_publish = HAL_GetTick();
+                poll_delta_publish(view);
+            } else {
+                wait = POLL_DELTA_MIN_INTERVAL_MS - (HAL_GetTick() - last_publish);
+            }
+        }
+        scoreboard_response_unlock();
+    }
+}
@@ -6,22 +6,111 @@
  */
 
 #include "ui.h"
-#include "cmsis_os.h"
+#include "usb_tx.h"
+#include "binary_protocol.h"
+
+static const char *response_id = NULL;  // Request id of the command being executed, if any
+static bool response_started = false;   // The id (or, in binary mode, a record) has been sent
+static uint8_t response_seq = 0;        // Binary request sequence number, 0 for unsolicited records
+
+/*-----------------------------------------------------------------------------
+ * Function: ui_write
+ *
+ * Queue a message for the host, preceded by "#<id> " if it is the first
+ * output of a response to a tagged request.
+ *
+ * Parameters: const uint8_t *data - bytes to send
+ *             uint16_t len - number of bytes
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void ui_write(const uint8_t *data, uint16_t len) {
+    if (response_id != NULL && !response_started) {
+        response_started = true;
+        usb_tx_write((uint8_t*) response_id, strlen(response_id));
+        usb_tx_write((uint8_t*) " ", 1);
+    }
+    usb_tx_write(data, len);
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: ui_begin_response
+ *
+ * Mark the start of a command's output. When the request carried an id
+ * (e.g. "#12 @scores"), the first message of the response is prefixed with
+ * it so a host pipelining several commands can match the replies.
+ *
+ * Parameters: const char *request_id - id including the '#', or NULL
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void ui_begin_response(const char *request_id) {
+    response_id = request_id;
+    response_started = false;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: ui_begin_binary_response
+ *
+ * Mark the start of the response to a binary request. Every record sent
+ * until ui_end_response carries the request's sequence number.
+ *
+ * Parameters: uint8_t seq - sequence number of the request
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void ui_begin_binary_response(uint8_t seq) {
+    response_id = NULL;
+    response_started = false;
+    response_seq = seq;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: ui_end_response
+ *
+ * Close a command's output. A tagged request that produced no output still
+ * gets a bare "#<id>" line, so every tagged request is answered exactly once.
+ * In binary mode a status record is sent instead when the command failed or
+ * sent no record of its own.
+ *
+ * Parameters: scoreboard_t *s - pointer to the scoreboard
+ *             command_t command - command that was executed
+ *             uint8_t status - binary_status_t result of the command
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void ui_end_response(scoreboard_t *s, command_t command, uint8_t status) {
+    binary_status_record_t record;
+
+    if (s->mode == BINARY_MODE) {
+        if (!response_started || status != BINARY_STATUS_OK) {
+            record.command = command;
+            record.status = status;
+            print_binary(s, BINARY_RECORD_STATUS, &record, sizeof(record));
+        }
+    } else if (response_id != NULL && !response_started) {
+        usb_tx_write((uint8_t*) response_id, strlen(response_id));
+        if (s->mode == SCOREBOARD_MODE) {
+            usb_tx_write((uint8_t*) "\n", 1);
+        } else {
+            usb_tx_write((uint8_t*) "\r\n", 2);
+        }
+    }
+    response_id = NULL;
+    response_seq = 0;
+}
 
 
 /*-----------------------------------------------------------------------------
  * Function: echo_terminal
  *
- * This function will echo a character to the terminal. Other modes will ignore.
+ * This function will echo received characters to the terminal in one write.
+ * Other modes will ignore.
  *
  * Parameters: scoreboard_t *s - pointer to the scoreboard
- *             uint8_t *rx_value - character to echo
+ *             uint8_t *rx_value - characters to echo
+ *             uint16_t len - number of characters
  * Return: None
  *---------------------------------------------------------------------------*/
-void echo_terminal(scoreboard_t *s, uint8_t *rx_value) {
+void echo_terminal(scoreboard_t *s, uint8_t *rx_value, uint16_t len) {
     if (s->mode == TERMINAL_CONSOLE_MODE) {
-        osDelay(1);
-        CDC_Transmit_FS(rx_value, 1);
+        usb_tx_write(rx_value, len);
     }
 }
 
@@ -36,8 +125,7 @@ void echo_terminal(scoreboard_t *s, uint8_t *rx_value) {
  *---------------------------------------------------------------------------*/
 void print_terminal(scoreboard_t *s, char *message) {
     if (s->mode == TERMINAL_CONSOLE_MODE) {
-        osDelay(1);
-        CDC_Transmit_FS((uint8_t*) message, strlen(message));
+        ui_write((uint8_t*) message, strlen(message));
     }
 }
 
@@ -52,8 +140,7 @@ void print_terminal(scoreboard_t *s, char *message) {
  *---------------------------------------------------------------------------*/
 void print_scoreboard(scoreboard_t *s, char *message) {
     if (s->mode == SCOREBOARD_MODE) {
-        osDelay(1);
-        CDC_Transmit_FS((uint8_t*) message, strlen(message));
+        ui_write((uint8_t*) message, strlen(message));
     }
 }
 
@@ -68,7 +155,45 @@ void print_scoreboard(scoreboard_t *s, char *message) {
  *---------------------------------------------------------------------------*/
 void print_pc_console(scoreboard_t *s, char *message) {
     if (s->mode == PC_CONSOLE_MODE) {
-        osDelay(1);
-        CDC_Transmit_FS((uint8_t*) message, strlen(message));
+        ui_write((uint8_t*) message, strlen(message));
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: print_bytes
+ *
+ * This function will send raw bytes if the scoreboard is in the given mode.
+ * Other modes will ignore. Used by stream_writer to emit whole chunks.
+ *
+ * Parameters: scoreboard_t *s - pointer to the scoreboard
+ *             mode_t mode - mode the output is meant for
+ *             const uint8_t *data - bytes to send
+ *             uint16_t len - number of bytes
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void print_bytes(scoreboard_t *s, mode_t mode, const uint8_t *data, uint16_t len) {
+    if (s->mode == mode && len > 0) {
+        ui_write(data, len);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: print_binary
+ *
+ * This function will send a framed record to a binary mode host. Other modes
+ * will ignore.
+ *
+ * Parameters: scoreboard_t *s - pointer to the scoreboard
+ *             uint8_t type - binary_record_t
+ *             const void *payload - record payload (little-endian fields)
+ *             uint16_t len - payload length
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void print_binary(scoreboard_t *s, uint8_t type, const void *payload, uint16_t len) {
+    uint8_t frame[BINARY_MAX_ENCODED];
+
+    if (s->mode == BINARY_MODE) {
+        response_started = true;
+        usb_tx_write(frame, binary_encode_frame(type, response_seq, payload, len, frame));
     }
 }
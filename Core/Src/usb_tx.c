@@ -0,0 +1,190 @@
+/*
+ * usb_tx.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include <string.h>
+
+#include "main.h"
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "usb_device.h"
+#include "usbd_cdc_if.h"
+#include "usb_tx.h"
+#include "ram_budget.h"
+
+extern USBD_HandleTypeDef hUsbDeviceFS;
+extern uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
+
+static StreamBufferHandle_t tx_stream = NULL;
+static osMutexId_t tx_write_mutex = NULL;
+static osThreadId_t usbTxTaskHandle = NULL;
+static usb_tx_stats_t tx_stats = { 0 };
+
+static uint8_t tx_stream_storage[USB_TX_STREAM_SIZE + 1];  // A stream buffer keeps one byte free
+static StaticStreamBuffer_t tx_stream_control_block;
+static StaticSemaphore_t tx_write_mutex_control_block;
+static StaticTask_t usbTxTask_control_block;
+static uint32_t usbTxTask_stack[USB_TX_TASK_STACK_WORDS];
+
+const uint32_t usb_tx_ram_bytes = sizeof(tx_stream_storage) + sizeof(tx_stream_control_block)
+        + sizeof(tx_write_mutex_control_block) + sizeof(usbTxTask_control_block) + sizeof(usbTxTask_stack);
+
+static const osMutexAttr_t tx_write_mutex_attributes = { .name = "usbTxWrite", .cb_mem = &tx_write_mutex_control_block,
+        .cb_size = sizeof(tx_write_mutex_control_block) };
+static const osThreadAttr_t usbTxTask_attributes = { .name = "usbTxTask", .cb_mem = &usbTxTask_control_block, .cb_size =
+        sizeof(usbTxTask_control_block), .stack_mem = usbTxTask_stack, .stack_size = sizeof(usbTxTask_stack), .priority =
+        (osPriority_t) osPriorityAboveNormal, };
+
+static void StartUsbTx(void *argument);
+
+/*-----------------------------------------------------------------------------
+ * Function: usb_tx_init
+ *
+ * Create the TX stream and the task that drains it into the CDC IN endpoint.
+ * Must be called after osKernelInitialize() and before any print_* call.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void usb_tx_init(void) {
+    tx_stream = xStreamBufferCreateStatic(USB_TX_STREAM_SIZE, 1, tx_stream_storage, &tx_stream_control_block);
+    tx_write_mutex = osMutexNew(&tx_write_mutex_attributes);
+    usbTxTaskHandle = osThreadNew(StartUsbTx, NULL, &usbTxTask_attributes);
+
+    if (tx_stream == NULL || tx_write_mutex == NULL || usbTxTaskHandle == NULL) {
+        Error_Handler();
+    }
+}
+
+// bytes_dropped has two writers: the writing tasks and the TX task
+static void count_dropped(size_t len) {
+    taskENTER_CRITICAL();
+    tx_stats.bytes_dropped += len;
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: usb_tx_write
+ *
+ * Queue bytes for the host and return. Writers are serialised so a message is
+ * never interleaved with another task's output. A message is queued whole or
+ * not at all, so a response line or binary frame is never cut short: if the
+ * host is not draining the port, the writer waits at most
+ * USB_TX_WRITE_TIMEOUT_MS for room and then drops the whole message, counted
+ * in bytes_dropped. Not callable from an interrupt.
+ *
+ * Parameters: const uint8_t *data - bytes to send
+ *             uint16_t len - number of bytes
+ * Return: uint16_t - len if the message was queued, 0 if it was dropped
+ *---------------------------------------------------------------------------*/
+uint16_t usb_tx_write(const uint8_t *data, uint16_t len) {
+    TickType_t start;
+    size_t sent = 0;
+
+    if (len == 0 || tx_stream == NULL) {
+        return 0;
+    }
+
+    osMutexAcquire(tx_write_mutex, osWaitForever);
+    if (len <= USB_TX_STREAM_SIZE) {
+        // Only the TX task takes bytes out while the mutex is held, so the space only grows
+        start = xTaskGetTickCount();
+        while (xStreamBufferSpacesAvailable(tx_stream) < len
+                && xTaskGetTickCount() - start < pdMS_TO_TICKS(USB_TX_WRITE_TIMEOUT_MS)) {
+            vTaskDelay(1);
+        }
+        if (xStreamBufferSpacesAvailable(tx_stream) >= len) {
+            sent = xStreamBufferSend(tx_stream, data, len, 0);
+        }
+    }
+    if (sent < len) {
+        count_dropped(len - sent);
+    }
+    osMutexRelease(tx_write_mutex);
+
+    return (uint16_t) sent;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: usb_tx_complete_isr
+ *
+ * Called from CDC_TransmitCplt_FS once the IN transfer (including its
+ * zero-length packet, if any) has finished. Wakes the TX task so it can chain
+ * the next transfer straight away.
+ *
+ * Parameters: None
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void usb_tx_complete_isr(void) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    if (usbTxTaskHandle != NULL) {
+        vTaskNotifyGiveFromISR((TaskHandle_t) usbTxTaskHandle, &higher_priority_task_woken);
+        portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+}
+
+void usb_tx_get_stats(usb_tx_stats_t *stats) {
+    taskENTER_CRITICAL();
+    *stats = tx_stats;
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: StartUsbTx
+ *
+ * TX task. Everything queued while the previous transfer was in flight is sent
+ * as one transfer, so small writes coalesce into full 64-byte packets and the
+ * response rate is bounded by the bus, not by the number of fragments. The
+ * CDC class splits the transfer into packets and appends the zero-length
+ * packet when the length is a multiple of 64.
+ *
+ * Parameters: void *argument - unused
+ * Return: None
+ *---------------------------------------------------------------------------*/
+static void StartUsbTx(void *argument) {
+    size_t len;
+    uint8_t result;
+
+    UNUSED(argument);
+
+    for (;;) {
+        len = xStreamBufferReceive(tx_stream, UserTxBufferFS, APP_TX_DATA_SIZE, portMAX_DELAY);
+        if (len == 0) {
+            continue;
+        }
+
+        // No host listening; keep draining so writers never stall on a dead port
+        if (hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED) {
+            count_dropped(len);
+            continue;
+        }
+
+        ulTaskNotifyTake(pdTRUE, 0);  // Discard a completion left over from a timed-out transfer
+        while ((result = CDC_Transmit_FS(UserTxBufferFS, (uint16_t) len)) == USBD_BUSY) {
+            if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(USB_TX_CPLT_TIMEOUT_MS)) == 0
+                    && hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED) {
+                break;
+            }
+        }
+        if (result != USBD_OK) {
+            count_dropped(len);
+            continue;
+        }
+        tx_stats.bytes_sent += len;
+        tx_stats.num_transfers++;
+
+        // UserTxBufferFS belongs to the endpoint until the transfer completes. A host that
+        // has stopped reading leaves it pending; the port being closed or unplugged ends it.
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(USB_TX_CPLT_TIMEOUT_MS)) == 0) {
+            if (hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED) {
+                break;
+            }
+        }
+    }
+}
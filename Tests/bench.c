@@ -0,0 +1,41 @@
+/*
+ * bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "bench.h"
+
+volatile uint32_t bench_sink;
+
+// Monotonic time in seconds
+double bench_now(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: bench_report
+ *
+ * Print the time per unit of work, and the speed-up over the baseline.
+ *
+ * Parameters: const char *name - what was timed
+ *             double seconds - time taken
+ *             double count - units of work done in that time
+ *             const char *unit - name of a unit, e.g. "byte"
+ *             double baseline - time the legacy code took, 0 for the legacy code itself
+ * Return: None
+ *---------------------------------------------------------------------------*/
+void bench_report(const char *name, double seconds, double count, const char *unit, double baseline) {
+    printf("%-28s %7.2f ns/%s", name, seconds / count * 1e9, unit);
+    if (baseline > 0) {
+        printf("  %5.1fx", baseline / seconds);
+    }
+    printf("\n");
+}
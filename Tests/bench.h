@@ -0,0 +1,22 @@
+/*
+ * bench.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ *
+ * Timing helpers shared by the host benchmarks (*_bench.c, linked with
+ * bench.c). Each benchmark times its workload against the code it replaced
+ * in legacy/ and reports both with bench_report.
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+
+extern volatile uint32_t bench_sink;  // Add results here to keep the loops from being optimised away
+
+double bench_now(void);
+void bench_report(const char *name, double seconds, double count, const char *unit, double baseline);
+
+#endif /* BENCH_H_ */
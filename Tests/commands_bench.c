@@ -0,0 +1,83 @@
+/*
+ * commands_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ *
+ * Host benchmark of the command parser against the strtok/strcmp parser it
+ * replaced (legacy/commands_legacy.c), on a mix of lines a host sends. Each
+ * line is copied into a buffer first, as the old parser modified it in place.
+ * Both parsers must agree on the command and the console register.
+ */
+
+#include <stdio.h>
+
+#include "bench.h"
+#include "commands.h"
+#include "commands_legacy.h"
+
+#define NUM_LINES  2000000L
+
+static const char *const lines[] = {
+    "@scores", "@stats", "@devices", "@poll on", "@set_speed 40", "@prepare_game 2 1",
+    "@set_date 2024-03-14", "@set_time 12:30:00", "@bogus", "@demo status", "@start_game 50", "@seed 12345",
+};
+#define NUM_SAMPLES  (sizeof(lines) / sizeof(lines[0]))
+
+static uint32_t parse_legacy(const char *line, command_t *command) {
+    uint8_t buffer[128], token[32], parameter[128];
+
+    strcpy((char*) buffer, line);
+    *command = legacy_parse_command(buffer, token, parameter);
+    return *command >= CMD_SET_SPEED ? legacy_parse_i2c_command(*command, parameter) : 0;
+}
+
+static uint32_t parse_new(const char *line, command_t *command) {
+    uint8_t buffer[128];
+    command_args_t args;
+    size_t len = strlen(line);
+
+    memcpy(buffer, line, len);
+    if (parse_command(buffer, len, &args) != PARSE_OK) {
+        *command = args.command;
+        return 0;
+    }
+    *command = args.command;
+    return parse_i2c_command(&args);
+}
+
+int main(void) {
+    command_t legacy_command, command;
+    uint32_t legacy_i2c, i2c;
+    double start, legacy_time, new_time;
+
+    if (!commands_init()) {
+        printf("FAIL: commands_init\n");
+        return 1;
+    }
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        legacy_i2c = parse_legacy(lines[i], &legacy_command);
+        i2c = parse_new(lines[i], &command);
+        if (legacy_command != command || legacy_i2c != i2c) {
+            printf("FAIL: \"%s\" legacy %d/0x%08x, new %d/0x%08x\n", lines[i], legacy_command, legacy_i2c,
+                    command, i2c);
+            return 1;
+        }
+    }
+
+    start = bench_now();
+    for (long n = 0; n < NUM_LINES; n++) {
+        bench_sink += parse_legacy(lines[n % NUM_SAMPLES], &command) + command;
+    }
+    legacy_time = bench_now() - start;
+
+    start = bench_now();
+    for (long n = 0; n < NUM_LINES; n++) {
+        bench_sink += parse_new(lines[n % NUM_SAMPLES], &command) + command;
+    }
+    new_time = bench_now() - start;
+
+    bench_report("legacy strtok/strcmp", legacy_time, NUM_LINES, "line", 0);
+    bench_report("hashed table parser", new_time, NUM_LINES, "line", legacy_time);
+    return 0;
+}
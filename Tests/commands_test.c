@@ -0,0 +1,87 @@
+/*
+ * commands_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ *
+ * Host test of the command parser: every command name must get a hash slot
+ * of its own for the current COMMAND_HASH_SEED (the firmware halts at start-up
+ * otherwise), and a set of lines must parse to the expected command, status,
+ * values and console register.
+ */
+
+#include <stdio.h>
+
+#include "commands.h"
+
+typedef struct {
+    const char *line;
+    parse_status_t status;
+    command_t command;
+    uint8_t num_values;
+    uint32_t value[MAX_COMMAND_VALUES];
+    uint32_t i2c;  // Expected parse_i2c_command result
+} parse_case_t;
+
+static const parse_case_t cases[] = {
+    { "@scores", PARSE_OK, CMD_LIST_SCORES, 0, { 0 }, 0 },
+    { "  @stats  ", PARSE_OK, CMD_STATS, 0, { 0 }, 0 },
+    { "@poll delta", PARSE_OK, CMD_POLLING_MODE, 1, { KEYWORD_DELTA }, 0 },
+    { "@demo keyframe", PARSE_PARAMETER_VALUE, CMD_DEMO_MODE, 0, { 0 }, 0 },
+    { "@set_speed 40", PARSE_OK, CMD_SET_SPEED, 1, { 40 }, 40 | I2C_CMD_SET_SPEED },
+    { "@set_speed 0", PARSE_PARAMETER_VALUE, CMD_SET_SPEED, 0, { 0 }, 0 },
+    { "@set_speed 4294967296", PARSE_PARAMETER_VALUE, CMD_SET_SPEED, 0, { 0 }, 0 },
+    { "@set_speed", PARSE_PARAMETER_COUNT, CMD_SET_SPEED, 0, { 0 }, 0 },
+    { "@prepare_game 2 1", PARSE_OK, CMD_PREPARE_GAME, 2, { 2, 1 },
+            2 | (1 << PARAM2_SHIFT) | I2C_CMD_PREPARE_GAME },
+    { "@prepare_game 2 1 0", PARSE_PARAMETER_COUNT, CMD_PREPARE_GAME, 2, { 2, 1 }, 0 },
+    { "@set_date 2024-03-14", PARSE_OK, CMD_SET_DATE, 3, { 2024, 3, 14 }, 0 },
+    { "@set_date 2024-13-14", PARSE_PARAMETER_VALUE, CMD_SET_DATE, 0, { 0 }, 0 },
+    { "@set_time 12:30:00", PARSE_OK, CMD_SET_TIME, 3, { 12, 30, 0 }, 0 },
+    { "@set_time 12:30", PARSE_PARAMETER_VALUE, CMD_SET_TIME, 0, { 0 }, 0 },
+    { "@seed 12345", PARSE_OK, CMD_RANDOM_SEED, 1, { 12345 }, I2C_CMD_RANDOM_SEED },
+    { "@end_game", PARSE_OK, CMD_END_GAME, 0, { 0 }, I2C_CMD_END_GAME },
+    { "@bogus", PARSE_UNKNOWN_COMMAND, INVALID_COMMAND, 0, { 0 }, 0 },
+    { "@score", PARSE_UNKNOWN_COMMAND, INVALID_COMMAND, 0, { 0 }, 0 },
+    { "@a_very_long_command_word", PARSE_UNKNOWN_COMMAND, INVALID_COMMAND, 0, { 0 }, 0 },
+    { "", PARSE_UNKNOWN_COMMAND, INVALID_COMMAND, 0, { 0 }, 0 },
+};
+
+int main(void) {
+    const parse_case_t *c;
+    command_args_t args;
+    str_view_t name;
+    parse_status_t status;
+    uint32_t failures = 0;
+
+    if (!commands_init()) {
+        printf("FAIL: commands_init, two command names share a hash slot for seed %u\n", COMMAND_HASH_SEED);
+        return 1;
+    }
+    for (command_t i = CMD_TERMINAL_MODE; i < NUM_COMMANDS; i++) {
+        name.ptr = (const uint8_t*) command_table[i].name;
+        name.len = command_table[i].name_len;
+        if (find_command(name) != i) {
+            printf("FAIL: find_command(\"%s\")\n", command_table[i].name);
+            failures++;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        c = &cases[i];
+        status = parse_command((const uint8_t*) c->line, strlen(c->line), &args);
+        if (status != c->status || args.command != c->command || args.num_values != c->num_values
+                || memcmp(args.value, c->value, c->num_values * sizeof(uint32_t)) != 0
+                || (status == PARSE_OK && parse_i2c_command(&args) != c->i2c)) {
+            printf("FAIL: parse_command(\"%s\") status %d command %d values %u\n", c->line, status, args.command,
+                    args.num_values);
+            failures++;
+        }
+    }
+
+    if (failures > 0) {
+        return 1;
+    }
+    printf("PASS: commands, %u names, %zu lines\n", NUM_COMMANDS - CMD_TERMINAL_MODE, sizeof(cases) / sizeof(cases[0]));
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * commands_legacy.c
+ *
+ *  Created on: Mar 14, 2024
+ *      Author: josh
+ */
+
+#include "commands_legacy.h"
+#include <ctype.h>
+
+/*-----------------------------------------------------------------------------
+ * List of valid console/PC commands
+ *---------------------------------------------------------------------------*/
+// Must align with command_t
+static const char *legacy_commands[] = { "", "", "@terminal", "@pc_console", "@scoreboard", "@set_date", "@set_time",
+        "@get_date", "@get_time", "@devices", "@scores", "@poll", "@demo", "@stats", "@set_speed", "@set_level",
+        "@prepare_game", "@start_game", "@end_game", "@pause_game", "@seed", NULL };
+static uint8_t legacy_num_params[] = { 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 1, 1, 2, 1, 0, 0, 1, 0 };
+
+/*-----------------------------------------------------------------------------
+ * Function: trim_whitespace
+ *
+ * This function will trim whitespace from a string
+ *
+ * Parameters: char *dst - destination string
+ *            char *src - source string
+ * Return: None
+ *
+ *--------------------------------------------------------------------------- */
+static void trim_whitespace(char *dst, char *src) {
+    uint8_t i = 0;
+    uint8_t j = strlen(src);
+    while (isspace((unsigned char)src[i])) {
+        i++;
+    }
+    while (isspace((unsigned char)src[j])) {
+        j--;
+    }
+    strncpy(dst, src + i, j - i + 1);
+    dst[j] = '\0';
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: num_parameters
+ *
+ * This function will count the number of parameters in a string
+ *
+ * Parameters: char *parameters - string of parameters
+ * Return: uint8_t - number of parameters
+ *---------------------------------------------------------------------------*/
+static uint8_t num_parameters(char *parameters) {
+    uint8_t count = 1;
+    uint8_t str_len = strlen(parameters);
+    if (str_len == 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < str_len; i++) {
+        if (isspace((unsigned char)parameters[i])) {
+            count++;
+        }
+    }
+    return count;
+}
+
+
+uint32_t legacy_parse_i2c_command(command_t cmd_token, uint8_t *parameter) {
+    uint32_t data = 0;
+    uint32_t param1 = 0;
+    uint32_t param2 = 0;
+    switch (cmd_token) {
+        case CMD_SET_SPEED: // param1 = speed
+            sscanf((char *)parameter, "%ld", &param1);
+            if (param1 > 0 && param1 <= 100) {
+                data = param1 & PARAM1_MASK;
+                data |= I2C_CMD_SET_SPEED;
+            }
+            break;
+        case CMD_SET_LEVEL: // param1 = level
+            sscanf((char *)parameter, "%ld", &param1);
+            if (param1 > 0 && param1 <= 4) {
+                data = param1 & PARAM1_MASK;
+                data |= I2C_CMD_SET_LEVEL;
+            }
+            break;
+        case CMD_PREPARE_GAME: // param1 = level, param2 = with_poison
+            sscanf((char *)parameter, "%ld %ld", &param1, &param2);
+            if (param1 >= 0 && param1 < 4 && param2 >= 0 && param2 <= 1) {
+                data = param1 & PARAM1_MASK;
+                data |= ((param2 << 8) & PARAM2_MASK);
+                data |= I2C_CMD_PREPARE_GAME;
+            }
+            break;
+        case CMD_START_GAME: // param1 = speed
+            sscanf((char *)parameter, "%ld", &param1);
+            if (param1 <= 100) {
+                data = param1 & PARAM1_MASK;
+                data |= I2C_CMD_START_GAME;
+            }
+            break;
+        case CMD_END_GAME: // no parameters
+            data |= I2C_CMD_END_GAME;
+            break;
+        case CMD_PAUSE_GAME: // no parameters
+            data |= I2C_CMD_PAUSE_GAME;
+            break;
+        case CMD_RANDOM_SEED: // no parameters
+            data |= I2C_CMD_RANDOM_SEED;
+            break;
+        default:
+            return 0;
+            break;
+    }
+    return data;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: legacy_parse_command
+ *
+ * This function will parse a command string and return the command token
+ *
+ * Parameters: uint8_t *command - command string
+ *             uint8_t *token - token to return
+ *             uint8_t *parameter - parameter to return
+ * Return: command_t - command token
+ *---------------------------------------------------------------------------*/
+command_t legacy_parse_command(uint8_t *command, uint8_t *token, uint8_t *parameter) {
+
+    char tmp_parameter[256];
+
+    memset(tmp_parameter, 0, sizeof(tmp_parameter));
+
+    char *next_token = strtok((char *)command, " ");
+
+    if (next_token == NULL) {
+        return INVALID_COMMAND;
+    }
+    strcpy((char *)token, next_token);
+    next_token = strtok(NULL, "");  // NULL for a command without parameters, which crashed the original
+    strcpy((char *)parameter, next_token != NULL ? next_token : "");
+//    sscanf((char*) command, "%s %s", token, (char*) parameter);
+    uint8_t i = 0;
+
+    trim_whitespace(tmp_parameter, (char*) parameter);
+    strcpy((char*) parameter, tmp_parameter);
+
+    uint8_t num_params = num_parameters((char*) parameter);
+
+    while (legacy_commands[i] != NULL) {
+        if (strcmp((char*) token, legacy_commands[i]) == 0) {
+            if (legacy_num_params[i] != num_params) {
+                return INVALID_PARAMETER_COUNT;
+            }
+            return i;
+        }
+        i++;
+    }
+    return INVALID_COMMAND;
+}
+
+/*-----------------------------------------------------------------------------
+ * Function: parse_date
+ *
+ * This function will parse a date string and return the year, month, and day
+ *
+ * Parameters: uint8_t *date - date string
+ *             uint16_t *year - year to return
+ *             uint16_t *month - month to return
+ *             uint16_t *day - day to return
+ * Return: uint8_t - 1 if successful, 0 if failed
+ *---------------------------------------------------------------------------*/
@@ -0,0 +1,23 @@
+/*
+ * commands_legacy.h
+ *
+ *  Created on: Mar 14, 2024
+ *      Author: josh
+ */
+
+#ifndef LEGACY_COMMANDS_H_
+#define LEGACY_COMMANDS_H_
+
+#include "commands.h"
+
+/*
+ * The strtok/strcmp command parser as it was before the table driven
+ * parser, with its symbols renamed. The first command_t values have not
+ * changed, so it returns the same tokens. Only built into the host
+ * benchmark (commands_bench.c).
+ */
+
+command_t legacy_parse_command(uint8_t *command, uint8_t *token, uint8_t *parameter);
+uint32_t legacy_parse_i2c_command(command_t cmd_token, uint8_t *parameter);
+
+#endif /* LEGACY_COMMANDS_H_ */
@@ -0,0 +1,130 @@
+/*
+ * register_map_legacy.c
+ *
+ *  Created on: Mar 14, 2024
+ *      Author: josh
+ */
+
+#include <string.h>
+
+#include "register_map_legacy.h"
+
+void legacy_struct2register(const i2c_scoreboard_t *data, uint8_t reg[]) {
+    uint8_t i = 0;
+    reg[i++] = data->hot_seq_begin;
+    reg[i++] = data->console_info;
+    reg[i++] = data->current_game_state;
+    reg[i++] = data->current_game_state2;
+    reg[i++] = data->current_game_state3;
+    reg[i++] = (uint8_t) (data->current_score1 >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->current_score1 & 0xFF;
+    reg[i++] = (uint8_t) (data->current_score2 >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->current_score2 & 0xFF;
+    reg[i++] = (uint8_t) (data->number_apples1 >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->number_apples1 & 0xFF;
+    reg[i++] = (uint8_t) (data->number_apples2 >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->number_apples2 & 0xFF;
+    reg[i++] = (uint8_t) (data->high_score >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->high_score & 0xFF;
+    reg[i++] = (uint8_t) (data->playing_time >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->playing_time & 0xFF;
+    reg[i++] = (uint8_t) (data->stats_generation >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->stats_generation & 0xFF;
+    reg[i++] = data->hot_seq_end;
+    reg[i++] = data->cold_seq_begin;
+    reg[i++] = (uint8_t) (data->num_apples_easy >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->num_apples_easy & 0xFF;
+    reg[i++] = (uint8_t) (data->num_apples_medium >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->num_apples_medium & 0xFF;
+    reg[i++] = (uint8_t) (data->num_apples_hard >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->num_apples_hard & 0xFF;
+    reg[i++] = (uint8_t) (data->num_apples_insane >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->num_apples_insane & 0xFF;
+    reg[i++] = (uint8_t) (data->high_score_easy >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->high_score_easy & 0xFF;
+    reg[i++] = (uint8_t) (data->high_score_medium >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->high_score_medium & 0xFF;
+    reg[i++] = (uint8_t) (data->high_score_hard >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->high_score_hard & 0xFF;
+    reg[i++] = (uint8_t) (data->high_score_insane >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->high_score_insane & 0xFF;
+    reg[i++] = (uint8_t) data->initials_easy[0];
+    reg[i++] = (uint8_t) data->initials_easy[1];
+    reg[i++] = (uint8_t) data->initials_easy[2];
+    reg[i++] = (uint8_t) data->initials_medium[0];
+    reg[i++] = (uint8_t) data->initials_medium[1];
+    reg[i++] = (uint8_t) data->initials_medium[2];
+    reg[i++] = (uint8_t) data->initials_hard[0];
+    reg[i++] = (uint8_t) data->initials_hard[1];
+    reg[i++] = (uint8_t) data->initials_hard[2];
+    reg[i++] = (uint8_t) data->initials_insane[0];
+    reg[i++] = (uint8_t) data->initials_insane[1];
+    reg[i++] = (uint8_t) data->initials_insane[2];
+    reg[i++] = data->cold_seq_end;
+    reg[i++] = (uint8_t) (data->date_time >> 24) & 0xFF;
+    reg[i++] = (uint8_t) (data->date_time >> 16) & 0xFF;
+    reg[i++] = (uint8_t) (data->date_time >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->date_time & 0xFF;
+    reg[i++] = (uint8_t) (data->command >> 24) & 0xFF;
+    reg[i++] = (uint8_t) (data->command >> 16) & 0xFF;
+    reg[i++] = (uint8_t) (data->command >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->command & 0xFF;
+    reg[i++] = (uint8_t) (data->random_seed >> 24) & 0xFF;
+    reg[i++] = (uint8_t) (data->random_seed >> 16) & 0xFF;
+    reg[i++] = (uint8_t) (data->random_seed >> 8) & 0xFF;
+    reg[i++] = (uint8_t) data->random_seed & 0xFF;
+}
+
+void legacy_register2struct(const uint8_t reg[], i2c_scoreboard_t *data) {
+    uint8_t i = 0;
+    data->hot_seq_begin = reg[i++];
+    data->console_info = reg[i++];
+    data->current_game_state = reg[i++];
+    data->current_game_state2 = reg[i++];
+    data->current_game_state3 = reg[i++];
+    data->current_score1 = (reg[i++] << 8);
+    data->current_score1 |= reg[i++];
+    data->current_score2 = (reg[i++] << 8);
+    data->current_score2 |= reg[i++];
+    data->number_apples1 = (reg[i++] << 8);
+    data->number_apples1 |= reg[i++];
+    data->number_apples2 = (reg[i++] << 8);
+    data->number_apples2 |= reg[i++];
+    data->high_score = (reg[i++] << 8);
+    data->high_score |= reg[i++];
+    data->playing_time = (reg[i++] << 8);
+    data->playing_time |= reg[i++];
+    data->stats_generation = (reg[i++] << 8);
+    data->stats_generation |= reg[i++];
+    data->hot_seq_end = reg[i++];
+    data->cold_seq_begin = reg[i++];
+    data->num_apples_easy = (reg[i++] << 8);
+    data->num_apples_easy |= reg[i++];
+    data->num_apples_medium = (reg[i++] << 8);
+    data->num_apples_medium |= reg[i++];
+    data->num_apples_hard = (reg[i++] << 8);
+    data->num_apples_hard |= reg[i++];
+    data->num_apples_insane = (reg[i++] << 8);
+    data->num_apples_insane |= reg[i++];
+    data->high_score_easy = (reg[i++] << 8);
+    data->high_score_easy |= reg[i++];
+    data->high_score_medium = (reg[i++] << 8);
+    data->high_score_medium |= reg[i++];
+    data->high_score_hard = (reg[i++] << 8);
+    data->high_score_hard |= reg[i++];
+    data->high_score_insane = (reg[i++] << 8);
+    data->high_score_insane |= reg[i++];
+    memcpy(data->initials_easy, (char*) &reg[i], 3);
+    i += 3;
+    memcpy(data->initials_medium, (char*) &reg[i], 3);
+    i += 3;
+    memcpy(data->initials_hard, (char*) &reg[i], 3);
+    i += 3;
+    memcpy(data->initials_insane, (char*) &reg[i], 3);
+    i += 3;
+    data->cold_seq_end = reg[i++];
+    data->date_time = (reg[i++] << 24);
+    data->date_time |= (reg[i++] << 16);
+    data->date_time |= (reg[i++] << 8);
+    data->date_time |= reg[i++];
+}
@@ -0,0 +1,23 @@
+/*
+ * register_map_legacy.h
+ *
+ *  Created on: Mar 14, 2024
+ *      Author: josh
+ */
+
+#ifndef LEGACY_REGISTER_MAP_H_
+#define LEGACY_REGISTER_MAP_H_
+
+#include "scoreboard.h"
+
+/*
+ * struct2register and register2struct as they were before the register map
+ * codec, one byte at a time, with the sequence registers added since and the
+ * register image passed in. The reference for the codec in the host tests
+ * (register_map_test.c, register_map_bench.c); update it with REGISTER_MAP.
+ */
+
+void legacy_struct2register(const i2c_scoreboard_t *data, uint8_t reg[]);
+void legacy_register2struct(const uint8_t reg[], i2c_scoreboard_t *data);
+
+#endif /* LEGACY_REGISTER_MAP_H_ */
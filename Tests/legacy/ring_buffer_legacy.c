@@ -0,0 +1,154 @@
+/*
+ * ring_buffer_legacy.c
+ *
+ *  Created on: Mar 3, 2024
+ *      Author: Joshua Butler, MD, MHI
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ring_buffer_legacy.h"
+
+uint8_t legacy_ring_buffer_init(legacy_ring_buffer_t *buffer, uint16_t buffer_size, size_t data_size) {
+    buffer->data = malloc((size_t) buffer_size * data_size);
+    if (buffer->data == NULL) {
+        return LEGACY_RING_BUFFER_MALLOC_FAILED;
+    }
+    memset(buffer->data, 0, buffer_size * data_size);
+    buffer->size = data_size;
+    buffer->buffer_size = buffer_size;
+    buffer->count = 0;
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->isFull = false;
+    buffer->new_data = false;
+
+    return LEGACY_RING_BUFFER_OK;
+}
+
+uint8_t legacy_ring_buffer_destroy(legacy_ring_buffer_t *buffer) {
+    free(buffer->data);
+    if (buffer->data != NULL) {
+        return LEGACY_RING_BUFFER_ERROR;
+    }
+    buffer->data = NULL;
+    buffer->buffer_size = 0;
+    buffer->count = 0;
+    buffer->size = 0;
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->isFull = false;
+
+    return LEGACY_RING_BUFFER_OK;
+}
+
+bool is_legacy_ring_buffer_empty(const legacy_ring_buffer_t *buffer) {
+    return (!buffer->isFull && buffer->head == buffer->tail);
+}
+
+bool is_legacy_ring_buffer_full(const legacy_ring_buffer_t *buffer) {
+    return buffer->isFull;
+}
+
+bool legacy_ring_buffer_enqueue(legacy_ring_buffer_t *buffer, const void *value) {
+    if (buffer->isFull) {
+        return false;  // Buffer is full, cannot enqueue
+    }
+
+    uint8_t *buffer_data = (uint8_t*) buffer->data;
+    const uint8_t *value_data = (const uint8_t*) value;
+
+    for (int i = 0; i < buffer->size; i++) {
+        buffer_data[(buffer->head * buffer->size + i) % (buffer->size * buffer->buffer_size)] = value_data[i];
+    }
+    buffer->peek = buffer->head;
+    buffer->head = (buffer->head + 1) % buffer->buffer_size;
+    buffer->count++;
+
+    if (buffer->count == buffer->buffer_size) {
+        buffer->isFull = true;  // Buffer is full after enqueueing
+    }
+
+    buffer->new_data = true;
+    buffer->num_new_data++;
+    return true;
+}
+
+bool legacy_ring_buffer_dequeue(legacy_ring_buffer_t *buffer, void *value) {
+    if (is_legacy_ring_buffer_empty(buffer)) {
+        return false;  // Buffer is empty, cannot dequeue
+    }
+
+    uint8_t *buffer_data = (uint8_t*) buffer->data;
+    uint8_t *value_data = (uint8_t*) value;
+
+    for (size_t i = 0; i < buffer->size; i++) {
+        value_data[i] = buffer_data[(buffer->tail * buffer->size + i) % (buffer->size * buffer->buffer_size)];
+    }
+    memset(&buffer_data[(buffer->tail * buffer->size) % (buffer->size * buffer->buffer_size)], 0,
+            buffer->size);
+    buffer->tail = (buffer->tail + 1) % buffer->buffer_size;
+    buffer->count--;
+    buffer->isFull = false;  // Buffer is no longer full
+
+    return true;
+}
+
+bool legacy_ring_buffer_pop(legacy_ring_buffer_t *buffer, void *value) {
+    if (is_legacy_ring_buffer_empty(buffer) || buffer->tail == buffer->head) {
+        return false;  // Buffer is empty, cannot dequeue
+    }
+
+    uint8_t *buffer_data = (uint8_t*) buffer->data;
+    uint8_t *value_data = (uint8_t*) value;
+
+    for (size_t i = 0; i < buffer->size; i++) {
+        value_data[i] = buffer_data[(buffer->head * buffer->size + i) % (buffer->size * buffer->buffer_size)];
+    }
+    memset(&buffer_data[(buffer->head * buffer->size) % (buffer->size * buffer->buffer_size)], 0,
+            buffer->size);
+    if (buffer->head == 0) {
+        buffer->head = buffer->buffer_size - 1;
+    } else {
+        buffer->head = (buffer->head - 1) % buffer->buffer_size;
+    }
+    buffer->count--;
+    buffer->isFull = false;  // Buffer is no longer full
+
+    return true;
+}
+
+uint8_t legacy_ring_buffer_peek(const legacy_ring_buffer_t *buffer, uint16_t offset, void *value) {
+    if (is_legacy_ring_buffer_empty(buffer)) {
+        return LEGACY_RING_BUFFER_EMPTY;
+    }
+
+    uint8_t *buffer_data = (uint8_t*) buffer->data;
+    uint8_t *value_data = (uint8_t*) value;
+    uint16_t peek = 0;
+    uint16_t idx = 0;
+
+    if (offset * buffer->size > buffer->head) {
+        return LEGACY_RING_BUFFER_OFFSET_OUT_OF_BOUNDS;
+    } else {
+        peek = buffer->peek - (offset * buffer->size);
+    }
+    for (size_t i = 0; i < buffer->size; i++) {
+        idx = (peek * buffer->size + i) % (buffer->size * buffer->buffer_size);
+        value_data[i] = buffer_data[idx];
+    }
+
+    return LEGACY_RING_BUFFER_OK;
+}
+
+void legacy_ring_buffer_flush(legacy_ring_buffer_t *buffer) {
+    memset(buffer->data, 0, buffer->size * buffer->buffer_size);
+    buffer->count = 0;
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->peek = 0;
+    buffer->isFull = false;
+}
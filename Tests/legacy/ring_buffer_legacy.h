@@ -0,0 +1,51 @@
+/*
+ * ring_buffer_legacy.h
+ *
+ *  Created on: Mar 3, 2024
+ *      Author: Joshua Butler, MD, MHI
+ *
+ */
+
+#ifndef LEGACY_RING_BUFFER_H_
+#define LEGACY_RING_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * The ring buffer as it was before the SPSC rewrite, with its symbols
+ * renamed. Only built into the host benchmark (ring_buffer_bench.c).
+ */
+
+#define MAX_LEGACY_RING_BUFFER_SIZE 32
+
+typedef struct {
+    void *data;  // Pointer to the buffer data
+    size_t size;  // Size of each element in the buffer
+    uint16_t buffer_size; // Maximum number of elements in the buffer
+    uint16_t count; // Number of elements in the buffer
+    uint16_t head;  // Index of the head (write position)
+    uint16_t tail;  // Index of the tail (read position)
+    uint16_t peek;  // Index of the peek (read position)
+    bool isFull;    // Flag indicating if the buffer is full
+    bool new_data;  // Flag indicating if new data has been added to the buffer
+    uint16_t num_overflows; // Number of times the buffer has overflowed
+    uint16_t num_new_data;  // Number of new data added to the buffer
+} legacy_ring_buffer_t;
+
+enum {
+    LEGACY_RING_BUFFER_OK, LEGACY_RING_BUFFER_ERROR, LEGACY_RING_BUFFER_MALLOC_FAILED, LEGACY_RING_BUFFER_EMPTY, LEGACY_RING_BUFFER_OFFSET_OUT_OF_BOUNDS
+};
+
+uint8_t legacy_ring_buffer_init(legacy_ring_buffer_t *buffer, uint16_t buffer_size, size_t data_size);
+uint8_t legacy_ring_buffer_destroy(legacy_ring_buffer_t *buffer);
+bool is_legacy_ring_buffer_empty(const legacy_ring_buffer_t *buffer);
+bool is_legacy_ring_buffer_full(const legacy_ring_buffer_t *buffer);
+bool legacy_ring_buffer_enqueue(legacy_ring_buffer_t *buffer, const void *value);
+bool legacy_ring_buffer_dequeue(legacy_ring_buffer_t *buffer, void *value);
+bool legacy_ring_buffer_pop(legacy_ring_buffer_t *buffer, void *value);
+uint8_t legacy_ring_buffer_peek(const legacy_ring_buffer_t *buffer, uint16_t offset, void *value);
+void legacy_ring_buffer_flush(legacy_ring_buffer_t *buffer);
+
+#endif /* LEGACY_RING_BUFFER_H_ */
@@ -0,0 +1,68 @@
+/*
+ * register_map_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ *
+ * Host benchmark of the register map codec against the byte-at-a-time codec
+ * it replaced (legacy/register_map_legacy.c): a full encode, a full decode,
+ * and the hot block decode the poller does most often.
+ */
+
+#include <string.h>
+
+#include "bench.h"
+#include "i2c_master.h"
+#include "register_map.h"
+#include "register_map_legacy.h"
+
+#define NUM_CALLS  20000000L
+
+int main(void) {
+    uint8_t reg[REGISTERS_SIZE];
+    i2c_scoreboard_t data;
+    double start, legacy_time;
+
+    memset(&data, 0x5A, sizeof(data));
+    register_encode(&data, reg);
+
+    start = bench_now();
+    for (long n = 0; n < NUM_CALLS; n++) {
+        data.current_score1 = n;
+        legacy_struct2register(&data, reg);
+        bench_sink += reg[REG_ADDR_current_score1 + 1];
+    }
+    legacy_time = bench_now() - start;
+    bench_report("legacy encode", legacy_time, NUM_CALLS, "call", 0);
+    start = bench_now();
+    for (long n = 0; n < NUM_CALLS; n++) {
+        data.current_score1 = n;
+        register_encode(&data, reg);
+        bench_sink += reg[REG_ADDR_current_score1 + 1];
+    }
+    bench_report("register_encode", bench_now() - start, NUM_CALLS, "call", legacy_time);
+
+    start = bench_now();
+    for (long n = 0; n < NUM_CALLS; n++) {
+        reg[REG_ADDR_current_score1 + 1] = n;
+        legacy_register2struct(reg, &data);
+        bench_sink += data.current_score1;
+    }
+    legacy_time = bench_now() - start;
+    bench_report("legacy decode", legacy_time, NUM_CALLS, "call", 0);
+    start = bench_now();
+    for (long n = 0; n < NUM_CALLS; n++) {
+        reg[REG_ADDR_current_score1 + 1] = n;
+        register_decode(reg, &data);
+        bench_sink += data.current_score1;
+    }
+    bench_report("register_decode", bench_now() - start, NUM_CALLS, "call", legacy_time);
+    start = bench_now();
+    for (long n = 0; n < NUM_CALLS; n++) {
+        reg[REG_ADDR_current_score1 + 1] = n;
+        register_decode_range(reg, &data, REG_HOT_START, REG_HOT_START + REG_HOT_SIZE);
+        bench_sink += data.current_score1;
+    }
+    bench_report("register_decode_range, hot", bench_now() - start, NUM_CALLS, "call", legacy_time);
+    return 0;
+}
@@ -0,0 +1,24 @@
+/*
+ * register_map_rev.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ *
+ * register_map.c built with its Cortex-M4 path (unaligned word load or store
+ * plus __REV/__REV16) on the host. CMSIS implements __REV16 with the rev16
+ * instruction, so it is replaced by the same byte swap in C; __REV is already
+ * a compiler builtin. x86 is little-endian and allows unaligned access, like
+ * the Cortex-M4, so the rest of the path runs unchanged.
+ */
+
+#define __ARM_ARCH_7EM__ 1
+
+#include "main.h"
+
+static inline uint32_t host_rev16(uint32_t value) {
+    return ((value & 0x00FF00FFu) << 8) | ((value >> 8) & 0x00FF00FFu);
+}
+
+#define __REV16(value) host_rev16(value)
+
+#include "register_map.c"
@@ -0,0 +1,74 @@
+/*
+ * ring_buffer_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ *
+ * Host throughput benchmark of the SPSC ring buffer against the ring buffer
+ * it replaced (legacy/ring_buffer_legacy.c), on the old USB RX pattern:
+ * 64-byte packets pushed into a 256-byte queue and drained again.
+ */
+
+#include <string.h>
+
+#include "bench.h"
+#include "ring_buffer.h"
+#include "ring_buffer_legacy.h"
+
+#define QUEUE_SIZE   256
+#define PACKET_SIZE  64
+#define NUM_PACKETS  2000000L
+#define NUM_BYTES    ((double) NUM_PACKETS * PACKET_SIZE)
+
+int main(void) {
+    static uint8_t storage[QUEUE_SIZE];
+    uint8_t packet[PACKET_SIZE];
+    uint8_t out[PACKET_SIZE];
+    legacy_ring_buffer_t legacy;
+    ring_buffer_t queue;
+    double start, legacy_time, single_time, bulk_time;
+
+    for (int i = 0; i < PACKET_SIZE; i++) {
+        packet[i] = i;
+    }
+
+    legacy_ring_buffer_init(&legacy, QUEUE_SIZE, sizeof(uint8_t));
+    start = bench_now();
+    for (long p = 0; p < NUM_PACKETS; p++) {
+        for (int i = 0; i < PACKET_SIZE; i++) {
+            legacy_ring_buffer_enqueue(&legacy, &packet[i]);
+        }
+        for (int i = 0; i < PACKET_SIZE; i++) {
+            legacy_ring_buffer_dequeue(&legacy, &out[i]);
+        }
+        bench_sink += out[p % PACKET_SIZE];
+    }
+    legacy_time = bench_now() - start;
+    legacy_ring_buffer_destroy(&legacy);
+
+    ring_buffer_init(&queue, storage, QUEUE_SIZE, sizeof(uint8_t));
+    start = bench_now();
+    for (long p = 0; p < NUM_PACKETS; p++) {
+        for (int i = 0; i < PACKET_SIZE; i++) {
+            ring_buffer_enqueue(&queue, &packet[i]);
+        }
+        for (int i = 0; i < PACKET_SIZE; i++) {
+            ring_buffer_dequeue(&queue, &out[i]);
+        }
+        bench_sink += out[p % PACKET_SIZE];
+    }
+    single_time = bench_now() - start;
+
+    start = bench_now();
+    for (long p = 0; p < NUM_PACKETS; p++) {
+        ring_buffer_enqueue_bulk(&queue, packet, PACKET_SIZE);
+        ring_buffer_dequeue_bulk(&queue, out, PACKET_SIZE);
+        bench_sink += out[p % PACKET_SIZE];
+    }
+    bulk_time = bench_now() - start;
+
+    bench_report("legacy, per byte", legacy_time, NUM_BYTES, "byte", 0);
+    bench_report("spsc, per byte", single_time, NUM_BYTES, "byte", legacy_time);
+    bench_report("spsc, bulk", bulk_time, NUM_BYTES, "byte", legacy_time);
+    return 0;
+}
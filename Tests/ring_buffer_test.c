@@ -0,0 +1,150 @@
+/*
+ * ring_buffer_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ *
+ * Host stress test of the SPSC ring buffer: one producer thread and one
+ * consumer thread push a numbered sequence through a small queue, mixing
+ * the single, bulk and in-place (slot/span) calls on both sides. The
+ * consumer checks that every element arrives exactly once and in order.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ring_buffer.h"
+
+#define QUEUE_SIZE    64
+#define NUM_ELEMENTS  10000000u
+#define MAX_BURST     40  // Larger than half the queue, so bulk calls wrap and fill it
+
+static ring_buffer_t queue;
+static uint32_t storage[QUEUE_SIZE];
+static uint32_t num_full = 0;  // Times the producer found no room
+static volatile int stop = 0;  // Set by the consumer on the first error
+
+static uint32_t next_random(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void* producer(void *argument) {
+    uint32_t burst[MAX_BURST];
+    uint32_t random = 0x12345678;
+    uint32_t next = 0;
+    uint32_t *slot;
+    uint16_t n;
+
+    (void) argument;
+    while (next < NUM_ELEMENTS && !stop) {
+        if (is_ring_buffer_full(&queue)) {
+            num_full++;
+            sched_yield();  // Let the consumer run when there is only one CPU
+        }
+        switch (next_random(&random) % 3) {
+            case 0:
+                if (ring_buffer_enqueue(&queue, &next)) {
+                    next++;
+                } else {
+                    num_full++;
+                }
+                break;
+            case 1:
+                n = 1 + next_random(&random) % MAX_BURST;
+                if (n > NUM_ELEMENTS - next) {
+                    n = NUM_ELEMENTS - next;
+                }
+                for (uint16_t i = 0; i < n; i++) {
+                    burst[i] = next + i;
+                }
+                n = ring_buffer_enqueue_bulk(&queue, burst, n);
+                if (n == 0) {
+                    num_full++;
+                }
+                next += n;
+                break;
+            default:
+                slot = ring_buffer_write_slot(&queue);
+                if (slot != NULL) {
+                    *slot = next++;
+                    ring_buffer_commit(&queue, 1);
+                } else {
+                    num_full++;
+                }
+                break;
+        }
+    }
+    return NULL;
+}
+
+static void* consumer(void *argument) {
+    uint32_t burst[MAX_BURST];
+    uint32_t random = 0x9E3779B9;
+    uint32_t expected = 0;
+    uint32_t value;
+    void *span;
+    uint16_t n;
+    uint32_t *errors = argument;
+
+    while (expected < NUM_ELEMENTS) {
+        if (is_ring_buffer_empty(&queue)) {
+            sched_yield();
+        }
+        switch (next_random(&random) % 3) {
+            case 0:
+                if (ring_buffer_dequeue(&queue, &value)) {
+                    *errors += value != expected++;
+                }
+                break;
+            case 1:
+                n = ring_buffer_dequeue_bulk(&queue, burst, 1 + next_random(&random) % MAX_BURST);
+                for (uint16_t i = 0; i < n; i++) {
+                    *errors += burst[i] != expected++;
+                }
+                break;
+            default:
+                n = ring_buffer_read_span(&queue, &span);
+                for (uint16_t i = 0; i < n; i++) {
+                    *errors += ((uint32_t*) span)[i] != expected++;
+                }
+                ring_buffer_consume(&queue, n);
+                break;
+        }
+        if (*errors > 0) {
+            stop = 1;
+            break;
+        }
+    }
+    return NULL;
+}
+
+int main(void) {
+    pthread_t producer_thread, consumer_thread;
+    uint32_t errors = 0;
+
+    if (ring_buffer_init(&queue, storage, QUEUE_SIZE, sizeof(uint32_t)) != RING_BUFFER_OK) {
+        printf("FAIL: ring_buffer_init\n");
+        return 1;
+    }
+    pthread_create(&consumer_thread, NULL, consumer, &errors);
+    pthread_create(&producer_thread, NULL, producer, NULL);
+    pthread_join(producer_thread, NULL);
+    pthread_join(consumer_thread, NULL);
+
+    if (errors > 0 || !is_ring_buffer_empty(&queue)) {
+        printf("FAIL: ring_buffer two-thread stress, %u out of order, %u left over\n", errors,
+                ring_buffer_count(&queue));
+        return 1;
+    }
+    if (num_full == 0) {
+        printf("FAIL: ring_buffer two-thread stress never filled the queue\n");
+        return 1;
+    }
+    printf("PASS: ring_buffer two-thread stress, %u elements, queue full %u times\n", NUM_ELEMENTS, num_full);
+    return 0;
+}
@@ -0,0 +1,19 @@
+/*
+ * reent.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: josh
+ *
+ * FreeRTOSConfig.h enables newlib reentrancy, so FreeRTOS.h includes the
+ * newlib <reent.h>, which glibc does not have. The host tests never create
+ * a task; the type only has to exist.
+ */
+
+#ifndef STUB_REENT_H_
+#define STUB_REENT_H_
+
+struct _reent {
+    int unused;
+};
+
+#endif /* STUB_REENT_H_ */
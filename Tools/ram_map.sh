@@ -0,0 +1,62 @@
+#!/bin/sh
+#
+# ram_map.sh
+#
+#  Created on: Oct 17, 2026
+#      Author: josh
+#
+# Post-build step: sum the .data and .bss input sections of the linker map
+# per object file and print them largest first, with the total against the
+# RAM region. The firmware reports its own split at run time in @sysinfo
+# (ram_budget.h); this one also covers HAL, the USB stack and newlib.
+#
+# Usage: ram_map.sh <project>.map
+
+if [ ! -r "$1" ]; then
+    echo "ram_map.sh: cannot read the linker map '$1'" >&2
+    exit 1
+fi
+
+awk '
+function hex(s,    i, n) {
+    n = 0
+    s = tolower(substr(s, 3))
+    for (i = 1; i <= length(s); i++) {
+        n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+    }
+    return n
+}
+function add(size, file) {
+    if (size == 0) {
+        return
+    }
+    sub(/.*\//, "", file)
+    bytes[file] += size
+    total += size
+}
+/^Memory Configuration/ { memory = 1 }
+memory && $1 == "RAM" { ram_size = hex($3) }
+/^Linker script and memory map/ { memory = 0 }
+# Output sections start in column 0; only the ones placed in RAM are summed
+/^\.[A-Za-z_]/ { in_ram = ($1 == ".data" || $1 == ".bss" || $1 == "._user_heap_stack"); pending = 0; next }
+!in_ram { next }
+# A long input section name puts its address, size and file on the next line
+pending && $1 ~ /^0x/ { add(hex($2), $3); pending = 0; next }
+/^ [.A-Z]/ && $1 != "*fill*" {
+    if (NF == 1) {
+        pending = 1
+    } else if ($2 ~ /^0x/ && $3 ~ /^0x/ && NF >= 4) {
+        add(hex($3), $4)
+    }
+}
+END {
+    for (file in bytes) {
+        printf "%8d  %s\n", bytes[file], file | "sort -nr"
+    }
+    close("sort -nr")
+    if (ram_size > 0) {
+        printf "%8d  total of %d bytes RAM (%d%%)\n", total, ram_size, total * 100 / ram_size
+    } else {
+        printf "%8d  total\n", total
+    }
+}' "$1"
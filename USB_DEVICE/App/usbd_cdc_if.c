@@ -26,6 +26,9 @@
 #include "ring_buffer.h"
 #include "cmsis_os.h"
 #include "led_indicator.h"
+#include "usb_tx.h"
+#include "scoreboard.h"
+#include "ram_budget.h"
 /* USER CODE END INCLUDE */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -67,6 +70,10 @@ extern led_indicator_t serial_indicator;
   */
 
 /* USER CODE BEGIN PRIVATE_DEFINES */
+#define CDC_RX_BANK(n) (&UserRxBufferFS[(n) * CDC_DATA_FS_OUT_PACKET_SIZE])
+/* Once stalled, only re-arm after the consumer has freed this many banks so a
+ * flooding host is paced in bursts instead of one packet per release */
+#define CDC_RX_RESUME_BANKS (CDC_RX_NUM_BANKS / 4)
 /* USER CODE END PRIVATE_DEFINES */
 
 /**
@@ -99,6 +106,12 @@ uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
 uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
 
 /* USER CODE BEGIN PRIVATE_VARIABLES */
+static volatile uint8_t rx_bank_armed = 0; // Bank the OUT endpoint is armed with (or will be, once released)
+static volatile bool rx_stalled = false;   // Every bank is held by the consumer, OUT endpoint is not armed
+static volatile bool rx_resumed = false;   // Re-armed after a stall, set until the backlog has drained
+static uint32_t rx_stall_start = 0;
+static cdc_rx_stats_t rx_stats = { 0 };
+const uint32_t usb_cdc_ram_bytes = sizeof(UserRxBufferFS) + sizeof(UserTxBufferFS);
 
 /* USER CODE END PRIVATE_VARIABLES */
 
@@ -159,7 +172,7 @@ static int8_t CDC_Init_FS(void)
   /* USER CODE BEGIN 3 */
     /* Set Application Buffers */
     USBD_CDC_SetTxBuffer(&hUsbDeviceFS, UserTxBufferFS, 0);
-    USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+    USBD_CDC_SetRxBuffer(&hUsbDeviceFS, CDC_RX_BANK(rx_bank_armed));
     return (USBD_OK);
   /* USER CODE END 3 */
 }
@@ -271,32 +284,35 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
 static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 {
   /* USER CODE BEGIN 6 */
-    uint16_t len = *Len;
-    uint16_t counter = 0;
-    uint8_t rx_value;
-    bool ring_buffer_status = false;
-
-    USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
-    USBD_CDC_ReceivePacket(&hUsbDeviceFS);
-
-    for (uint16_t i = 0; i < len; i++) {
-        while (!ring_buffer_status) {
-            rx_value = Buf[i];
-            ring_buffer_status = ring_buffer_enqueue(&rx_buffer,(void *) &rx_value);
-            if (!ring_buffer_status) {
-                osDelay(50);
-                counter++;
-            }
-            if (counter == 10) {
-                break;
-            }
-        }
-        counter = 0;
-        ring_buffer_status = false;
+    cdc_rx_packet_t packet = { .data = Buf, .len = (uint16_t) *Len };
+
+    // Until the backlog has drained, everything the host sends is data it had to hold back
+    if (rx_resumed) {
+        rx_stats.bytes_deferred += packet.len;
+    }
+
+    // Hand the filled bank to the command task by reference, nothing is copied.
+    // A zero length packet carries no data, so the same bank is simply re-armed.
+    if (packet.len > 0) {
+        ring_buffer_enqueue(&rx_buffer, &packet);
+        rx_bank_armed = (rx_bank_armed + 1) & (CDC_RX_NUM_BANKS - 1);
+        scoreboard_rx_isr();
     }
-    led_indicator_set_blink(&serial_indicator, 300, len >> 1);
 
-//    CDC_Transmit_FS(Buf, len);
+    // Banks are released in order, so the next one is free unless all of them are queued.
+    // Otherwise leave the endpoint un-armed; the host is NAKed (no data is lost and this
+    // interrupt never waits) until the consumer has drained CDC_RX_RESUME_BANKS banks.
+    if (ring_buffer_count(&rx_buffer) < CDC_RX_NUM_BANKS) {
+        USBD_CDC_SetRxBuffer(&hUsbDeviceFS, CDC_RX_BANK(rx_bank_armed));
+        USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+    } else {
+        rx_stalled = true;
+        rx_stall_start = HAL_GetTick();
+        rx_stats.num_stalls++;
+    }
+    led_indicator_set_blink(&serial_indicator, 300, packet.len >> 1);
+
+//    CDC_Transmit_FS(Buf, packet.len);
     return (USBD_OK);
   /* USER CODE END 6 */
 }
@@ -346,11 +362,79 @@ static int8_t CDC_TransmitCplt_FS(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
     UNUSED(Buf);
     UNUSED(Len);
     UNUSED(epnum);
+    usb_tx_complete_isr();
   /* USER CODE END 13 */
   return result;
 }
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
+/**
+  * @brief  CDC_Get_RxPacket_FS
+  *         Peek at the oldest received OUT packet without copying it.
+  *
+  *         @note
+  *         The bank stays owned by the caller, who may modify it in place
+  *         (e.g. to terminate a command line), until CDC_Release_RxPacket_FS.
+  *
+  * @param  packet: Filled with the bank address and number of bytes received
+  * @retval true if a packet was available
+  */
+bool CDC_Get_RxPacket_FS(cdc_rx_packet_t *packet)
+{
+    void *span;
+
+    if (ring_buffer_read_span(&rx_buffer, &span) == 0) {
+        return false;
+    }
+    *packet = *(cdc_rx_packet_t*) span;
+    return true;
+}
+
+/**
+  * @brief  CDC_Release_RxPacket_FS
+  *         Return the oldest OUT packet bank to the USB stack. If reception was
+  *         stalled because every bank was in use, the endpoint is re-armed once
+  *         enough banks are free again.
+  * @retval None
+  */
+void CDC_Release_RxPacket_FS(void)
+{
+    uint32_t stall_ms;
+
+    ring_buffer_consume(&rx_buffer, 1);
+
+    HAL_NVIC_DisableIRQ(OTG_FS_IRQn);
+    if (rx_stalled && ring_buffer_space(&rx_buffer) >= CDC_RX_RESUME_BANKS) {
+        rx_stalled = false;
+        rx_resumed = true;
+        stall_ms = HAL_GetTick() - rx_stall_start;
+        rx_stats.stalled_ms += stall_ms;
+        if (stall_ms > rx_stats.max_stall_ms) {
+            rx_stats.max_stall_ms = stall_ms;
+        }
+        USBD_CDC_SetRxBuffer(&hUsbDeviceFS, CDC_RX_BANK(rx_bank_armed));
+        USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+    } else if (rx_resumed && ring_buffer_count(&rx_buffer) == 0) {
+        rx_resumed = false;  // Caught up with the host
+    }
+    HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+}
+
+/**
+  * @brief  CDC_Get_RxStats_FS
+  *         Snapshot of the OUT endpoint backpressure counters.
+  * @param  stats: Filled with the current counters
+  * @retval None
+  */
+void CDC_Get_RxStats_FS(cdc_rx_stats_t *stats)
+{
+    HAL_NVIC_DisableIRQ(OTG_FS_IRQn);
+    *stats = rx_stats;
+    if (rx_stalled) {
+        stats->stalled_ms += HAL_GetTick() - rx_stall_start;
+    }
+    HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+}
 
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
@@ -30,6 +30,7 @@
 #include "usbd_cdc.h"
 
 /* USER CODE BEGIN INCLUDE */
+#include <stdbool.h>
 
 /* USER CODE END INCLUDE */
 
@@ -48,9 +49,12 @@
   * @{
   */
 /* Define size for the receive and transmit buffer over CDC */
-#define APP_RX_DATA_SIZE  2048
+#define APP_RX_DATA_SIZE  4096
 #define APP_TX_DATA_SIZE  2048
 /* USER CODE BEGIN EXPORTED_DEFINES */
+/* UserRxBufferFS is carved into packet sized banks that are handed to the
+ * command task by reference. Must be a power of two. */
+#define CDC_RX_NUM_BANKS  (APP_RX_DATA_SIZE / CDC_DATA_FS_OUT_PACKET_SIZE)
 
 /* USER CODE END EXPORTED_DEFINES */
 
@@ -64,6 +68,17 @@
   */
 
 /* USER CODE BEGIN EXPORTED_TYPES */
+typedef struct {
+    uint8_t *data;  // Start of the filled bank inside UserRxBufferFS
+    uint16_t len;   // Number of bytes received into the bank
+} cdc_rx_packet_t;
+
+typedef struct {
+    uint32_t num_stalls;      // Times every bank was held and the OUT endpoint was left un-armed
+    uint32_t stalled_ms;      // Total time the host was NAKed because of backpressure
+    uint32_t max_stall_ms;    // Longest single stall
+    uint32_t bytes_deferred;  // Bytes received from a re-arm until the backlog drained: what the host held back
+} cdc_rx_stats_t;
 
 /* USER CODE END EXPORTED_TYPES */
 
@@ -108,6 +123,9 @@ extern USBD_CDC_ItfTypeDef USBD_Interface_fops_FS;
 uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len);
 
 /* USER CODE BEGIN EXPORTED_FUNCTIONS */
+bool CDC_Get_RxPacket_FS(cdc_rx_packet_t *packet);
+void CDC_Release_RxPacket_FS(void);
+void CDC_Get_RxStats_FS(cdc_rx_stats_t *stats);
 
 /* USER CODE END EXPORTED_FUNCTIONS */
 